@@ -0,0 +1,111 @@
+#include "allocationcounter.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+namespace
+{
+    std::atomic<uint64_t> g_AllocationCount{0};
+
+    [[nodiscard]] void* Allocate(const std::size_t size)
+    {
+        g_AllocationCount.fetch_add(1, std::memory_order_relaxed);
+
+        if(void* const memory{std::malloc(size == 0 ? 1 : size)})
+            return memory;
+
+        throw std::bad_alloc{};
+    }
+
+    [[nodiscard]] void* AllocateAligned(const std::size_t size, const std::align_val_t alignment)
+    {
+        g_AllocationCount.fetch_add(1, std::memory_order_relaxed);
+
+#ifdef _MSC_VER
+        if(void* const memory{_aligned_malloc(size == 0 ? 1 : size, static_cast<std::size_t>(alignment))})
+            return memory;
+#else
+        const std::size_t alignmentSize{static_cast<std::size_t>(alignment)};
+        const std::size_t alignedSize{(size + alignmentSize - 1) / alignmentSize * alignmentSize};
+        if(void* const memory{std::aligned_alloc(alignmentSize, alignedSize == 0 ? alignmentSize : alignedSize)})
+            return memory;
+#endif
+
+        throw std::bad_alloc{};
+    }
+
+    void DeallocateAligned(void* const memory)
+    {
+#ifdef _MSC_VER
+        _aligned_free(memory);
+#else
+        std::free(memory);
+#endif
+    }
+}
+
+uint64_t AllocationCounter::GetTotalAllocationCount()
+{
+    return g_AllocationCount.load(std::memory_order_relaxed);
+}
+
+void* operator new(const std::size_t size)
+{
+    return Allocate(size);
+}
+
+void* operator new[](const std::size_t size)
+{
+    return Allocate(size);
+}
+
+void* operator new(const std::size_t size, const std::align_val_t alignment)
+{
+    return AllocateAligned(size, alignment);
+}
+
+void* operator new[](const std::size_t size, const std::align_val_t alignment)
+{
+    return AllocateAligned(size, alignment);
+}
+
+void operator delete(void* const memory) noexcept
+{
+    std::free(memory);
+}
+
+void operator delete[](void* const memory) noexcept
+{
+    std::free(memory);
+}
+
+void operator delete(void* const memory, std::size_t) noexcept
+{
+    std::free(memory);
+}
+
+void operator delete[](void* const memory, std::size_t) noexcept
+{
+    std::free(memory);
+}
+
+void operator delete(void* const memory, const std::align_val_t) noexcept
+{
+    DeallocateAligned(memory);
+}
+
+void operator delete[](void* const memory, const std::align_val_t) noexcept
+{
+    DeallocateAligned(memory);
+}
+
+void operator delete(void* const memory, std::size_t, const std::align_val_t) noexcept
+{
+    DeallocateAligned(memory);
+}
+
+void operator delete[](void* const memory, std::size_t, const std::align_val_t) noexcept
+{
+    DeallocateAligned(memory);
+}
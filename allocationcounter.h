@@ -0,0 +1,23 @@
+#pragma once
+
+#include <cstdint>
+
+/// Counts global operator new calls made while the counter is alive.
+/// Used by the examples to verify how many heap allocations a command queue performs.
+class AllocationCounter
+{
+public:
+    AllocationCounter()
+        : m_StartCount{GetTotalAllocationCount()}
+    {
+    }
+
+    [[nodiscard]] uint64_t GetAllocationCount() const
+    {
+        return GetTotalAllocationCount() - m_StartCount;
+    }
+
+    [[nodiscard]] static uint64_t GetTotalAllocationCount();
+private:
+    uint64_t m_StartCount{0};
+};
@@ -0,0 +1,203 @@
+#include "benchmarks/benchmarkrunner.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iterator>
+#include <ostream>
+#include <unordered_map>
+#include <utility>
+
+namespace
+{
+    constexpr std::size_t EvictionBufferSize{64 * 1024 * 1024};
+    constexpr std::size_t CacheLineSize{64};
+    /// Evicting the caches costs milliseconds, so cold samples of small queues run fewer iterations.
+    constexpr uint32_t MaximumColdIterationCount{16};
+
+    /// Finds the value of the next "key": field at or after position, leaving position just past it.
+    [[nodiscard]] bool FindField(const std::string& json, const std::string& key, std::size_t& position, std::string& value)
+    {
+        const std::string quotedKey{'"' + key + '"'};
+        position = json.find(quotedKey, position);
+        if(position == std::string::npos)
+            return false;
+
+        position = json.find(':', position + quotedKey.size());
+        if(position == std::string::npos)
+            return false;
+
+        position = json.find_first_not_of(" \t\r\n", position + 1);
+        if(position == std::string::npos)
+            return false;
+
+        if(json[position] == '"')
+        {
+            const std::size_t end{json.find('"', position + 1)};
+            if(end == std::string::npos)
+                return false;
+
+            value = json.substr(position + 1, end - position - 1);
+            position = end + 1;
+            return true;
+        }
+
+        const std::size_t end{json.find_first_of(",}\r\n", position)};
+        value = json.substr(position, end == std::string::npos ? std::string::npos : end - position);
+        position = end;
+        return true;
+    }
+}
+
+void BenchmarkState::EvictCaches()
+{
+    static std::vector<std::byte> buffer(EvictionBufferSize);
+    for(std::size_t index{0}; index < buffer.size(); index += CacheLineSize)
+    {
+        buffer[index] = static_cast<std::byte>(static_cast<uint8_t>(buffer[index]) + 1);
+    }
+}
+
+BenchmarkRunner::BenchmarkRunner(const uint32_t sampleCount, const uint32_t minimumSampleCommands)
+    : m_SampleCount{std::max(sampleCount, 1u)}
+    , m_MinimumSampleCommands{std::max(minimumSampleCommands, 1u)}
+{
+}
+
+void BenchmarkRunner::Add(BenchmarkCase&& benchmarkCase)
+{
+    m_Cases.push_back(std::move(benchmarkCase));
+}
+
+std::vector<BenchmarkResult> BenchmarkRunner::Run(
+    const std::string& filter, const uint32_t minimumSize, const uint32_t maximumSize, std::ostream& output) const
+{
+    std::vector<BenchmarkResult> results{};
+    for(const BenchmarkCase& benchmarkCase : m_Cases)
+    {
+        if(benchmarkCase.m_CommandCount < minimumSize || benchmarkCase.m_CommandCount > maximumSize)
+            continue;
+
+        if(GetName(benchmarkCase).find(filter) == std::string::npos)
+            continue;
+
+        const BenchmarkResult& result{results.emplace_back(RunCase(benchmarkCase))};
+        output << std::left << std::setw(64) << result.m_Name << std::right << std::fixed << std::setprecision(2)
+            << std::setw(10) << result.m_MedianNanoseconds << " ns/command"
+            << std::setw(10) << result.m_AllocationsPerCommand << " allocations/command" << std::endl;
+    }
+    return results;
+}
+
+std::string BenchmarkRunner::GetName(const BenchmarkCase& benchmarkCase)
+{
+    return benchmarkCase.m_Implementation + '/' + benchmarkCase.m_Operation + '/' + benchmarkCase.m_CommandMix
+        + '/' + std::to_string(benchmarkCase.m_CaptureSize) + '/' + (benchmarkCase.m_ColdCache ? "Cold" : "Warm")
+        + '/' + std::to_string(benchmarkCase.m_CommandCount);
+}
+
+void BenchmarkRunner::WriteJson(const std::vector<BenchmarkResult>& results, std::ostream& output)
+{
+    output << "{\n  \"results\": [\n";
+    for(std::size_t index{0}; index != results.size(); ++index)
+    {
+        const BenchmarkResult& result{results[index]};
+        output << "    {\"name\": \"" << result.m_Name << '"'
+            << ", \"implementation\": \"" << result.m_Case.m_Implementation << '"'
+            << ", \"operation\": \"" << result.m_Case.m_Operation << '"'
+            << ", \"command_mix\": \"" << result.m_Case.m_CommandMix << '"'
+            << ", \"capture_size\": " << result.m_Case.m_CaptureSize
+            << ", \"cache\": \"" << (result.m_Case.m_ColdCache ? "cold" : "warm") << '"'
+            << ", \"command_count\": " << result.m_Case.m_CommandCount
+            << ", \"samples\": " << result.m_SampleCount
+            << ", \"iterations\": " << result.m_IterationCount
+            << std::setprecision(4) << std::fixed
+            << ", \"median_ns_per_command\": " << result.m_MedianNanoseconds
+            << ", \"min_ns_per_command\": " << result.m_MinNanoseconds
+            << ", \"mean_ns_per_command\": " << result.m_MeanNanoseconds
+            << ", \"stddev_ns_per_command\": " << result.m_StandardDeviation
+            << ", \"allocations_per_command\": " << result.m_AllocationsPerCommand
+            << '}' << (index + 1 != results.size() ? "," : "") << '\n';
+    }
+    output << "  ]\n}\n";
+}
+
+bool BenchmarkRunner::Compare(const std::vector<BenchmarkResult>& results, const std::filesystem::path& baselinePath,
+    const double threshold, std::vector<BenchmarkComparison>& comparisons)
+{
+    std::ifstream file{baselinePath};
+    if(!file)
+        return false;
+
+    const std::string json{std::istreambuf_iterator<char>{file}, std::istreambuf_iterator<char>{}};
+    std::unordered_map<std::string, double> baseline{};
+    std::size_t position{0};
+    std::string name{};
+    std::string median{};
+    while(FindField(json, "name", position, name) && FindField(json, "median_ns_per_command", position, median))
+    {
+        baseline[name] = std::strtod(median.c_str(), nullptr);
+    }
+
+    comparisons.clear();
+    for(const BenchmarkResult& result : results)
+    {
+        const auto found{baseline.find(result.m_Name)};
+        if(found == baseline.end())
+            continue;
+
+        const double limit{found->second * (1.0 + threshold)};
+        comparisons.push_back(BenchmarkComparison{
+            result.m_Name, found->second, result.m_MedianNanoseconds, result.m_MedianNanoseconds > limit});
+    }
+    return true;
+}
+
+BenchmarkResult BenchmarkRunner::RunCase(const BenchmarkCase& benchmarkCase) const
+{
+    const uint32_t commandCount{std::max(benchmarkCase.m_CommandCount, 1u)};
+    uint32_t iterationCount{(m_MinimumSampleCommands + commandCount - 1) / commandCount};
+    if(benchmarkCase.m_ColdCache)
+        iterationCount = std::min(iterationCount, MaximumColdIterationCount);
+
+    const double commandsPerSample{static_cast<double>(commandCount) * iterationCount};
+
+    std::vector<double> samples{};
+    uint64_t allocationCount{0};
+    for(uint32_t sample{0}; sample != m_SampleCount; ++sample)
+    {
+        BenchmarkState state{benchmarkCase.m_ColdCache};
+        for(uint32_t iteration{0}; iteration != iterationCount; ++iteration)
+        {
+            benchmarkCase.m_Run(state);
+        }
+        samples.push_back(static_cast<double>(state.GetElapsed().count()) / commandsPerSample);
+        allocationCount += state.GetAllocationCount();
+    }
+
+    BenchmarkResult result{GetName(benchmarkCase), benchmarkCase, m_SampleCount, iterationCount};
+    result.m_Case.m_Run = nullptr;
+
+    std::sort(samples.begin(), samples.end());
+    const std::size_t middle{samples.size() / 2};
+    result.m_MedianNanoseconds = samples.size() % 2 == 0 ? (samples[middle - 1] + samples[middle]) / 2 : samples[middle];
+    result.m_MinNanoseconds = samples.front();
+
+    double sum{0};
+    for(const double value : samples)
+    {
+        sum += value;
+    }
+    result.m_MeanNanoseconds = sum / static_cast<double>(samples.size());
+
+    double squaredDeviationSum{0};
+    for(const double value : samples)
+    {
+        squaredDeviationSum += (value - result.m_MeanNanoseconds) * (value - result.m_MeanNanoseconds);
+    }
+    result.m_StandardDeviation = std::sqrt(squaredDeviationSum / static_cast<double>(samples.size()));
+    result.m_AllocationsPerCommand = static_cast<double>(allocationCount) / (commandsPerSample * m_SampleCount);
+    return result;
+}
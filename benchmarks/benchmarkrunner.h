@@ -0,0 +1,121 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+#include "allocationcounter.h"
+
+/// Times one benchmark case. Setup runs outside Measure() so only the measured work is timed,
+/// with the caches evicted right before it when the case runs cold.
+class BenchmarkState
+{
+public:
+    explicit BenchmarkState(const bool coldCache)
+        : m_ColdCache{coldCache}
+    {
+    }
+
+    template<class TFunction>
+    void Measure(TFunction&& function)
+    {
+        if(m_ColdCache)
+            EvictCaches();
+
+        const AllocationCounter counter{};
+        const auto start{std::chrono::steady_clock::now()};
+        function();
+        m_Elapsed += std::chrono::steady_clock::now() - start;
+        m_AllocationCount += counter.GetAllocationCount();
+    }
+
+    [[nodiscard]] std::chrono::nanoseconds GetElapsed() const
+    {
+        return m_Elapsed;
+    }
+
+    /// Heap allocations made while measuring.
+    [[nodiscard]] uint64_t GetAllocationCount() const
+    {
+        return m_AllocationCount;
+    }
+
+private:
+    /// Writes to a buffer larger than the last level cache, pushing the data of the case out of every cache.
+    static void EvictCaches();
+
+    std::chrono::nanoseconds m_Elapsed{0};
+    uint64_t m_AllocationCount{0};
+    bool m_ColdCache{false};
+};
+
+struct BenchmarkCase
+{
+    std::string m_Implementation{};
+    std::string m_Operation{};
+    std::string m_CommandMix{};
+    uint32_t m_CaptureSize{0};
+    bool m_ColdCache{false};
+    uint32_t m_CommandCount{0};
+    /// Runs the operation once over m_CommandCount commands.
+    std::function<void(BenchmarkState&)> m_Run{};
+};
+
+struct BenchmarkResult
+{
+    std::string m_Name{};
+    BenchmarkCase m_Case{};
+    uint32_t m_SampleCount{0};
+    uint32_t m_IterationCount{0};
+    double m_MedianNanoseconds{0};
+    double m_MinNanoseconds{0};
+    double m_MeanNanoseconds{0};
+    double m_StandardDeviation{0};
+    double m_AllocationsPerCommand{0};
+};
+
+/// Result of comparing a run against a baseline, times are per command.
+struct BenchmarkComparison
+{
+    std::string m_Name{};
+    double m_BaselineNanoseconds{0};
+    double m_CurrentNanoseconds{0};
+    bool m_IsRegression{false};
+};
+
+/// Runs the registered cases, taking sampleCount samples of each. A sample runs the case as many times
+/// as it takes to process at least minimumSampleCommands commands so small queue sizes are still measurable.
+class BenchmarkRunner
+{
+public:
+    BenchmarkRunner(uint32_t sampleCount, uint32_t minimumSampleCommands);
+
+    void Add(BenchmarkCase&& benchmarkCase);
+
+    /// Runs every case whose name contains filter and whose command count is in [minimumSize, maximumSize],
+    /// printing each result to output as it completes.
+    [[nodiscard]] std::vector<BenchmarkResult> Run(
+        const std::string& filter, uint32_t minimumSize, uint32_t maximumSize, std::ostream& output) const;
+
+    /// Unique name of a case, "Implementation/Operation/Mix/CaptureSize/Cache/CommandCount".
+    [[nodiscard]] static std::string GetName(const BenchmarkCase& benchmarkCase);
+
+    static void WriteJson(const std::vector<BenchmarkResult>& results, std::ostream& output);
+
+    /// Compares the median time per command of every result also found in the baseline file, written by WriteJson().
+    /// A result is a regression when it is more than threshold, as a fraction, slower than the baseline.
+    /// Returns false when the baseline can't be read.
+    [[nodiscard]] static bool Compare(const std::vector<BenchmarkResult>& results, const std::filesystem::path& baselinePath,
+        double threshold, std::vector<BenchmarkComparison>& comparisons);
+
+private:
+    [[nodiscard]] BenchmarkResult RunCase(const BenchmarkCase& benchmarkCase) const;
+
+    std::vector<BenchmarkCase> m_Cases{};
+    uint32_t m_SampleCount{1};
+    uint32_t m_MinimumSampleCommands{1};
+};
@@ -0,0 +1,288 @@
+#include "benchmarks/commandqueuebenchmarks.h"
+
+#include <array>
+#include <cstddef>
+#include <memory>
+#include <optional>
+#include <span>
+#include <utility>
+
+#include "referencesemantics/commandqueue.h"
+#include "referencesemantics/commands.h"
+#include "referencesemantics/storedvaluecommands.h"
+#include "valuesemantics/commandinstrumentation.h"
+#include "valuesemantics/commandqueue.h"
+#include "valuesemantics/commands.h"
+#include "valuesemantics/deltacommandqueue.h"
+#include "workingvalue.h"
+#include "workingvaluestore.h"
+
+namespace ReferenceSemantics
+{
+    namespace
+    {
+        class ModifyValueCommand final : public Command
+        {
+        public:
+            ModifyValueCommand(std::shared_ptr<WorkingValue> value, const int32_t valueModification)
+                : m_Value{std::move(value)}
+                , m_Modification{valueModification}
+            {
+            }
+
+            void Execute() override
+            {
+                m_Value->ModifyValue(m_Modification);
+            }
+
+            void Rollback() override
+            {
+                m_Value->ModifyValue(-m_Modification);
+            }
+        private:
+            std::shared_ptr<WorkingValue> m_Value{};
+            WorkingValue::ValueType m_Modification{};
+        };
+    }
+}
+
+namespace
+{
+    constexpr std::array<uint32_t, 5> CommandCounts{1'000, 10'000, 100'000, 1'000'000, 10'000'000};
+
+    enum class CommandMix
+    {
+        ModifyValue,
+        /// ModifyValue through a WorkingValueStore handle rather than a shared pointer.
+        ModifyStoredValue,
+        Lambda
+    };
+
+    /// The value every command modifies, by shared pointer or by handle.
+    struct BenchmarkTarget
+    {
+        std::shared_ptr<WorkingValue> m_Value{};
+        /// Destroyed in WorkingValueStore::GetShared() along with the last case holding the target.
+        std::shared_ptr<const WorkingValueHandle> m_StoredValue{};
+    };
+
+    /// State captured by the lambda commands, CaptureSize bytes on top of the value and modification.
+    template<uint32_t CaptureSize>
+    struct LambdaCapture
+    {
+        std::shared_ptr<WorkingValue> m_Value{};
+        WorkingValue::ValueType m_Modification{};
+        std::array<std::byte, CaptureSize> m_Padding{};
+    };
+
+    struct ReferenceSemanticsQueue
+    {
+        using Queue = ReferenceSemantics::CommandQueue;
+        static constexpr const char* Name{"ReferenceSemantics"};
+
+        static void QueueModifyValue(Queue& queue, const std::shared_ptr<WorkingValue>& value, const int32_t valueModification)
+        {
+            queue.QueueCommand(std::make_unique<ReferenceSemantics::ModifyValueCommand>(value, valueModification));
+        }
+
+        static void QueueModifyStoredValue(Queue& queue, const WorkingValueHandle value, const int32_t valueModification)
+        {
+            queue.QueueCommand(std::make_unique<ReferenceSemantics::ModifyStoredValueCommand>(value, valueModification));
+        }
+
+        template<uint32_t CaptureSize>
+        static void QueueLambda(Queue& queue, const LambdaCapture<CaptureSize>& capture)
+        {
+            queue.QueueCommand(std::make_unique<ReferenceSemantics::LambdaCommand>(
+                [capture]
+                {
+                    capture.m_Value->ModifyValue(capture.m_Modification);
+                },
+                [capture]
+                {
+                    capture.m_Value->ModifyValue(-capture.m_Modification);
+                }));
+        }
+    };
+
+    struct ValueSemanticsQueue
+    {
+        using Queue = ValueSemantics::CommandQueue;
+        static constexpr const char* Name{"ValueSemantics"};
+
+        template<class TCommandQueue>
+        static void QueueModifyValue(TCommandQueue& queue, const std::shared_ptr<WorkingValue>& value, const int32_t valueModification)
+        {
+            queue.QueueCommand(ValueSemantics::ModifyValueCommand{value, valueModification});
+        }
+
+        template<class TCommandQueue>
+        static void QueueModifyStoredValue(TCommandQueue& queue, const WorkingValueHandle value, const int32_t valueModification)
+        {
+            queue.QueueCommand(ValueSemantics::ModifyStoredValueCommand{value, valueModification});
+        }
+
+        template<uint32_t CaptureSize, class TCommandQueue>
+        static void QueueLambda(TCommandQueue& queue, const LambdaCapture<CaptureSize>& capture)
+        {
+            queue.QueueCommand(ValueSemantics::LambdaCommand{
+                [capture]
+                {
+                    capture.m_Value->ModifyValue(capture.m_Modification);
+                },
+                [capture]
+                {
+                    capture.m_Value->ModifyValue(-capture.m_Modification);
+                }});
+        }
+    };
+
+    /// Measures the overhead of StatisticsInstrumentation against ValueSemanticsQueue.
+    /// Commands are queued through the base's functions, which take any value semantics queue.
+    struct InstrumentedValueSemanticsQueue : ValueSemanticsQueue
+    {
+        using Queue = ValueSemantics::BasicCommandQueue<ValueSemantics::StatisticsInstrumentation>;
+        static constexpr const char* Name{"ValueSemanticsInstrumented"};
+    };
+
+    /// Queues commandCount commands of Mix, lambda commands capture CaptureSize extra bytes.
+    template<class TQueue, CommandMix Mix, uint32_t CaptureSize>
+    void PopulateQueue(typename TQueue::Queue& queue, const BenchmarkTarget& target, const uint32_t commandCount)
+    {
+        for(uint32_t i{0}; i != commandCount; ++i)
+        {
+            if constexpr(Mix == CommandMix::Lambda)
+                TQueue::template QueueLambda<CaptureSize>(queue, LambdaCapture<CaptureSize>{target.m_Value, 1});
+            else if constexpr(Mix == CommandMix::ModifyStoredValue)
+                TQueue::QueueModifyStoredValue(queue, *target.m_StoredValue, 1);
+            else
+                TQueue::QueueModifyValue(queue, target.m_Value, 1);
+        }
+    }
+
+    template<class TQueue, CommandMix Mix, uint32_t CaptureSize = 0>
+    void AddCases(BenchmarkRunner& runner, const BenchmarkTarget& target)
+    {
+        using Queue = typename TQueue::Queue;
+        const char* const commandMix{Mix == CommandMix::Lambda ? "Lambda"
+            : Mix == CommandMix::ModifyStoredValue ? "ModifyStoredValue" : "ModifyValue"};
+
+        for(const uint32_t commandCount : CommandCounts)
+        {
+            runner.Add(BenchmarkCase{TQueue::Name, "Create", commandMix, CaptureSize, false, commandCount,
+                [target, commandCount](BenchmarkState& state)
+                {
+                    std::optional<Queue> queue{};
+                    state.Measure([&]
+                        {
+                            queue.emplace();
+                            PopulateQueue<TQueue, Mix, CaptureSize>(*queue, target, commandCount);
+                        });
+                }});
+
+            runner.Add(BenchmarkCase{TQueue::Name, "Destroy", commandMix, CaptureSize, false, commandCount,
+                [target, commandCount](BenchmarkState& state)
+                {
+                    std::optional<Queue> queue{std::in_place};
+                    PopulateQueue<TQueue, Mix, CaptureSize>(*queue, target, commandCount);
+                    state.Measure([&]
+                        {
+                            queue.reset();
+                        });
+                }});
+
+            for(const bool coldCache : {false, true})
+            {
+                runner.Add(BenchmarkCase{TQueue::Name, "ExecuteRollback", commandMix, CaptureSize, coldCache, commandCount,
+                    [target, commandCount](BenchmarkState& state)
+                    {
+                        Queue queue{};
+                        PopulateQueue<TQueue, Mix, CaptureSize>(queue, target, commandCount);
+                        state.Measure([&]
+                            {
+                                queue.ExecuteAll();
+                                queue.RollbackTo(0);
+                            });
+                    }});
+            }
+        }
+    }
+
+    /// DeltaCommandQueue only models ModifyValue, its commands target the same value as the other queues' by index.
+    void AddDeltaQueueCases(BenchmarkRunner& runner, const BenchmarkTarget& target)
+    {
+        using Queue = ValueSemantics::DeltaCommandQueue;
+        const auto populateQueue{[](Queue& queue, const uint32_t commandCount)
+            {
+                for(uint32_t i{0}; i != commandCount; ++i)
+                {
+                    queue.QueueCommand(0, 1);
+                }
+            }};
+
+        for(const uint32_t commandCount : CommandCounts)
+        {
+            runner.Add(BenchmarkCase{"ValueSemanticsDelta", "Create", "ModifyValue", 0, false, commandCount,
+                [target, commandCount, populateQueue](BenchmarkState& state)
+                {
+                    std::optional<Queue> queue{};
+                    state.Measure([&]
+                        {
+                            queue.emplace(std::span{target.m_Value.get(), 1});
+                            populateQueue(*queue, commandCount);
+                        });
+                }});
+
+            runner.Add(BenchmarkCase{"ValueSemanticsDelta", "Destroy", "ModifyValue", 0, false, commandCount,
+                [target, commandCount, populateQueue](BenchmarkState& state)
+                {
+                    std::optional<Queue> queue{std::in_place, std::span{target.m_Value.get(), 1}};
+                    populateQueue(*queue, commandCount);
+                    state.Measure([&]
+                        {
+                            queue.reset();
+                        });
+                }});
+
+            for(const bool coldCache : {false, true})
+            {
+                runner.Add(BenchmarkCase{"ValueSemanticsDelta", "ExecuteRollback", "ModifyValue", 0, coldCache, commandCount,
+                    [target, commandCount, populateQueue](BenchmarkState& state)
+                    {
+                        Queue queue{std::span{target.m_Value.get(), 1}};
+                        populateQueue(queue, commandCount);
+                        state.Measure([&]
+                            {
+                                queue.ExecuteAll();
+                                queue.RollbackTo(0);
+                            });
+                    }});
+            }
+        }
+    }
+
+    template<class TQueue>
+    void AddQueueCases(BenchmarkRunner& runner, const BenchmarkTarget& target)
+    {
+        AddCases<TQueue, CommandMix::ModifyValue>(runner, target);
+        AddCases<TQueue, CommandMix::ModifyStoredValue>(runner, target);
+        AddCases<TQueue, CommandMix::Lambda, 0>(runner, target);
+        AddCases<TQueue, CommandMix::Lambda, 32>(runner, target);
+        AddCases<TQueue, CommandMix::Lambda, 128>(runner, target);
+    }
+}
+
+void AddCommandQueueBenchmarks(BenchmarkRunner& runner)
+{
+    const std::shared_ptr<const WorkingValueHandle> storedValue{new WorkingValueHandle{WorkingValueStore::GetShared().Create()},
+        [](const WorkingValueHandle* const handle)
+        {
+            WorkingValueStore::GetShared().Destroy(*handle);
+            delete handle;
+        }};
+    const BenchmarkTarget target{std::make_shared<WorkingValue>(), storedValue};
+    AddQueueCases<ReferenceSemanticsQueue>(runner, target);
+    AddQueueCases<ValueSemanticsQueue>(runner, target);
+    AddQueueCases<InstrumentedValueSemanticsQueue>(runner, target);
+    AddDeltaQueueCases(runner, target);
+}
@@ -0,0 +1,7 @@
+#pragma once
+
+#include "benchmarks/benchmarkrunner.h"
+
+/// Adds the creation and execute/rollback cases of the reference and value semantics command queues
+/// for every combination of queue size, command mix, capture size and cache state.
+void AddCommandQueueBenchmarks(BenchmarkRunner& runner);
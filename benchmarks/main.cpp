@@ -0,0 +1,128 @@
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "benchmarks/benchmarkrunner.h"
+#include "benchmarks/commandqueuebenchmarks.h"
+
+namespace
+{
+    constexpr int RegressionExitCode{1};
+    constexpr int UsageExitCode{2};
+
+    struct Options
+    {
+        std::string m_Filter{};
+        std::string m_OutputPath{};
+        std::string m_BaselinePath{};
+        double m_Threshold{0.1};
+        uint32_t m_SampleCount{5};
+        uint32_t m_MinimumSampleCommands{1'000'000};
+        uint32_t m_MinimumSize{0};
+        uint32_t m_MaximumSize{1'000'000};
+    };
+
+    void PrintUsage()
+    {
+        std::cout << "Usage: command-pattern-benchmarks [options]\n"
+            "  --filter <text>          Only run cases whose name contains text\n"
+            "  --min-size <count>       Skip queues smaller than count commands (default 0)\n"
+            "  --max-size <count>       Skip queues larger than count commands (default 1000000, up to 10000000)\n"
+            "  --samples <count>        Samples taken of each case (default 5)\n"
+            "  --sample-commands <count> Commands processed by each sample at least (default 1000000)\n"
+            "  --output <file>          Write the results as JSON to file\n"
+            "  --baseline <file>        Compare against the JSON results in file, exits with 1 on a regression\n"
+            "  --threshold <fraction>   Slowdown flagged as a regression (default 0.1)\n";
+    }
+
+    [[nodiscard]] bool ParseOptions(const int argc, const char* const argv[], Options& options)
+    {
+        for(int index{1}; index < argc; ++index)
+        {
+            const std::string_view argument{argv[index]};
+            if(argument == "--help")
+                return false;
+
+            if(index + 1 == argc)
+                return false;
+
+            const char* const value{argv[++index]};
+            if(argument == "--filter")
+                options.m_Filter = value;
+            else if(argument == "--min-size")
+                options.m_MinimumSize = static_cast<uint32_t>(std::strtoul(value, nullptr, 10));
+            else if(argument == "--max-size")
+                options.m_MaximumSize = static_cast<uint32_t>(std::strtoul(value, nullptr, 10));
+            else if(argument == "--samples")
+                options.m_SampleCount = static_cast<uint32_t>(std::strtoul(value, nullptr, 10));
+            else if(argument == "--sample-commands")
+                options.m_MinimumSampleCommands = static_cast<uint32_t>(std::strtoul(value, nullptr, 10));
+            else if(argument == "--output")
+                options.m_OutputPath = value;
+            else if(argument == "--baseline")
+                options.m_BaselinePath = value;
+            else if(argument == "--threshold")
+                options.m_Threshold = std::strtod(value, nullptr);
+            else
+                return false;
+        }
+        return true;
+    }
+}
+
+int main(const int argc, const char* const argv[])
+{
+    Options options{};
+    if(!ParseOptions(argc, argv, options))
+    {
+        PrintUsage();
+        return UsageExitCode;
+    }
+
+    BenchmarkRunner runner{options.m_SampleCount, options.m_MinimumSampleCommands};
+    AddCommandQueueBenchmarks(runner);
+    const std::vector<BenchmarkResult> results{
+        runner.Run(options.m_Filter, options.m_MinimumSize, options.m_MaximumSize, std::cout)};
+
+    if(!options.m_OutputPath.empty())
+    {
+        std::ofstream output{options.m_OutputPath};
+        BenchmarkRunner::WriteJson(results, output);
+        if(!output)
+        {
+            std::cerr << "Failed to write " << options.m_OutputPath << '\n';
+            return UsageExitCode;
+        }
+    }
+
+    if(options.m_BaselinePath.empty())
+        return EXIT_SUCCESS;
+
+    std::vector<BenchmarkComparison> comparisons{};
+    if(!BenchmarkRunner::Compare(results, options.m_BaselinePath, options.m_Threshold, comparisons))
+    {
+        std::cerr << "Failed to read " << options.m_BaselinePath << '\n';
+        return UsageExitCode;
+    }
+
+    uint32_t regressionCount{0};
+    for(const BenchmarkComparison& comparison : comparisons)
+    {
+        if(!comparison.m_IsRegression)
+            continue;
+
+        ++regressionCount;
+        std::cout << "REGRESSION " << comparison.m_Name << std::fixed << std::setprecision(2)
+            << ": " << comparison.m_BaselineNanoseconds << " -> " << comparison.m_CurrentNanoseconds << " ns/command ("
+            << std::showpos << (comparison.m_CurrentNanoseconds / comparison.m_BaselineNanoseconds - 1.0) * 100.0
+            << std::noshowpos << "%)\n";
+    }
+    std::cout << comparisons.size() << " cases compared against " << options.m_BaselinePath << ", "
+        << regressionCount << " regressed by more than " << options.m_Threshold * 100.0 << "%\n";
+
+    return regressionCount == 0 ? EXIT_SUCCESS : RegressionExitCode;
+}
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <vector>
+
+/// Collects the resources a command reads and writes, identified by address, so commands touching
+/// disjoint resources can be executed in parallel.
+class CommandAccess
+{
+public:
+    void Read(const void* const resource)
+    {
+        m_Reads.push_back(resource);
+    }
+
+    void Write(const void* const resource)
+    {
+        m_Writes.push_back(resource);
+    }
+
+    void Clear()
+    {
+        m_Reads.clear();
+        m_Writes.clear();
+    }
+
+    [[nodiscard]] const std::vector<const void*>& GetReads() const
+    {
+        return m_Reads;
+    }
+
+    [[nodiscard]] const std::vector<const void*>& GetWrites() const
+    {
+        return m_Writes;
+    }
+private:
+    std::vector<const void*> m_Reads{};
+    std::vector<const void*> m_Writes{};
+};
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+
+/// Forwards to an upstream memory resource while counting the requests made to it.
+class CountingMemoryResource final : public std::pmr::memory_resource
+{
+public:
+    explicit CountingMemoryResource(std::pmr::memory_resource* upstream = std::pmr::get_default_resource())
+        : m_Upstream{upstream}
+    {
+    }
+
+    [[nodiscard]] uint64_t GetAllocationCount() const
+    {
+        return m_AllocationCount;
+    }
+
+    [[nodiscard]] uint64_t GetDeallocationCount() const
+    {
+        return m_DeallocationCount;
+    }
+
+    /// Bytes currently allocated and not yet returned.
+    [[nodiscard]] std::size_t GetAllocatedBytes() const
+    {
+        return m_AllocatedBytes;
+    }
+private:
+    void* do_allocate(const std::size_t bytes, const std::size_t alignment) override
+    {
+        void* const memory{m_Upstream->allocate(bytes, alignment)};
+        ++m_AllocationCount;
+        m_AllocatedBytes += bytes;
+        return memory;
+    }
+
+    void do_deallocate(void* const memory, const std::size_t bytes, const std::size_t alignment) override
+    {
+        m_Upstream->deallocate(memory, bytes, alignment);
+        ++m_DeallocationCount;
+        m_AllocatedBytes -= bytes;
+    }
+
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override
+    {
+        return this == &other;
+    }
+
+    std::pmr::memory_resource* m_Upstream{nullptr};
+    uint64_t m_AllocationCount{0};
+    uint64_t m_DeallocationCount{0};
+    std::size_t m_AllocatedBytes{0};
+};
@@ -1,7 +1,25 @@
 #include <catch2/catch_session.hpp>
 
 #include "referencesemantics/commandqueueexamples.h"
+#include "staticdispatch/commandqueueexamples.h"
+#include "valuesemantics/boundedcommandqueueexamples.h"
+#include "valuesemantics/checkpointcommandqueueexamples.h"
+#include "valuesemantics/commandgroupexamples.h"
+#include "valuesemantics/commandinstrumentationexamples.h"
 #include "valuesemantics/commandqueueexamples.h"
+#include "valuesemantics/deltacommandqueueexamples.h"
+#include "valuesemantics/journaledcommandqueueexamples.h"
+#include "valuesemantics/journalreplayerexamples.h"
+#include "valuesemantics/lazycommandqueueexamples.h"
+#include "valuesemantics/multiproducercommandbufferexamples.h"
+#include "valuesemantics/packedcommandqueueexamples.h"
+#include "valuesemantics/parallelcommandexecutorexamples.h"
+#include "valuesemantics/peepholeoptimizationexamples.h"
+#include "valuesemantics/persistentcommandqueueexamples.h"
+#include "valuesemantics/scheduledcommandqueueexamples.h"
+#include "valuesemantics/tieredcommandqueueexamples.h"
+#include "valuesemantics/undotreecommandqueueexamples.h"
+#include "valuesemantics/workingvaluestoreexamples.h"
 
 int main(const int argc, const char* const argv[])
 {
@@ -0,0 +1,159 @@
+#include "mappedfile.h"
+
+#include <cstdint>
+
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+MappedFile::~MappedFile()
+{
+    Close();
+}
+
+bool MappedFile::Open(const std::filesystem::path& path, const std::size_t minimumSize)
+{
+    Close();
+
+#ifdef _WIN32
+    const HANDLE file{CreateFileW(path.c_str(), GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ, nullptr,
+        OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr)};
+    if(file == INVALID_HANDLE_VALUE)
+        return false;
+
+    m_File = file;
+
+    LARGE_INTEGER fileSize{};
+    if(!GetFileSizeEx(file, &fileSize))
+    {
+        Close();
+        return false;
+    }
+    const std::size_t size{static_cast<std::size_t>(fileSize.QuadPart)};
+#else
+    m_File = open(path.c_str(), O_RDWR | O_CREAT, 0644);
+    if(m_File == -1)
+        return false;
+
+    struct stat status{};
+    if(fstat(m_File, &status) != 0)
+    {
+        Close();
+        return false;
+    }
+    const std::size_t size{static_cast<std::size_t>(status.st_size)};
+#endif
+
+    if(!Map(size < minimumSize ? minimumSize : size))
+    {
+        Close();
+        return false;
+    }
+    return true;
+}
+
+void MappedFile::Close()
+{
+    Unmap();
+
+#ifdef _WIN32
+    if(m_File)
+    {
+        CloseHandle(m_File);
+        m_File = nullptr;
+    }
+#else
+    if(m_File != -1)
+    {
+        close(m_File);
+        m_File = -1;
+    }
+#endif
+}
+
+bool MappedFile::Resize(const std::size_t size)
+{
+    Unmap();
+    if(!Map(size))
+    {
+        Close();
+        return false;
+    }
+    return true;
+}
+
+void MappedFile::Flush(const std::size_t offset, const std::size_t size, const bool wait)
+{
+    if(!m_Data || size == 0)
+        return;
+
+#ifdef _WIN32
+    FlushViewOfFile(m_Data + offset, size);
+    if(wait)
+        FlushFileBuffers(m_File);
+#else
+    // msync requires a page aligned address
+    const std::size_t pageSize{static_cast<std::size_t>(sysconf(_SC_PAGESIZE))};
+    const std::size_t alignedOffset{offset / pageSize * pageSize};
+    msync(m_Data + alignedOffset, offset + size - alignedOffset, wait ? MS_SYNC : MS_ASYNC);
+#endif
+}
+
+bool MappedFile::Map(const std::size_t size)
+{
+    if(size == 0)
+        return false;
+
+#ifdef _WIN32
+    // Creating a mapping larger than the file extends the file
+    const HANDLE mapping{CreateFileMappingW(m_File, nullptr, PAGE_READWRITE,
+        static_cast<DWORD>(static_cast<uint64_t>(size) >> 32), static_cast<DWORD>(size), nullptr)};
+    if(!mapping)
+        return false;
+
+    void* const data{MapViewOfFile(mapping, FILE_MAP_ALL_ACCESS, 0, 0, size)};
+    if(!data)
+    {
+        CloseHandle(mapping);
+        return false;
+    }
+    m_Mapping = mapping;
+#else
+    struct stat status{};
+    if(fstat(m_File, &status) != 0)
+        return false;
+
+    if(static_cast<std::size_t>(status.st_size) < size && ftruncate(m_File, static_cast<off_t>(size)) != 0)
+        return false;
+
+    void* const data{mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, m_File, 0)};
+    if(data == MAP_FAILED)
+        return false;
+#endif
+
+    m_Data = static_cast<std::byte*>(data);
+    m_Size = size;
+    return true;
+}
+
+void MappedFile::Unmap()
+{
+    if(!m_Data)
+        return;
+
+#ifdef _WIN32
+    UnmapViewOfFile(m_Data);
+    CloseHandle(m_Mapping);
+    m_Mapping = nullptr;
+#else
+    munmap(m_Data, m_Size);
+#endif
+    m_Data = nullptr;
+    m_Size = 0;
+}
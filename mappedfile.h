@@ -0,0 +1,56 @@
+#pragma once
+
+#include <cstddef>
+#include <filesystem>
+
+/// Read/write memory mapping of a whole file. Bytes added by growing the file read as zero.
+class MappedFile
+{
+public:
+    MappedFile() = default;
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    /// Opens path, creating it when missing, and maps at least minimumSize bytes of it.
+    /// Returns false when the file can't be opened or mapped.
+    [[nodiscard]] bool Open(const std::filesystem::path& path, std::size_t minimumSize);
+    void Close();
+
+    /// Grows the file and its mapping to size bytes, which moves the mapping.
+    /// Returns false, leaving the file closed, when it can't be remapped.
+    [[nodiscard]] bool Resize(std::size_t size);
+
+    /// Writes the mapped bytes in [offset, offset + size) back to the file.
+    /// Only waits for them to reach the disk when wait is true.
+    void Flush(std::size_t offset, std::size_t size, bool wait);
+
+    [[nodiscard]] bool IsOpen() const
+    {
+        return m_Data != nullptr;
+    }
+
+    [[nodiscard]] std::byte* GetData() const
+    {
+        return m_Data;
+    }
+
+    [[nodiscard]] std::size_t GetSize() const
+    {
+        return m_Size;
+    }
+
+private:
+    [[nodiscard]] bool Map(std::size_t size);
+    void Unmap();
+
+#ifdef _WIN32
+    void* m_File{nullptr};
+    void* m_Mapping{nullptr};
+#else
+    int m_File{-1};
+#endif
+    std::byte* m_Data{nullptr};
+    std::size_t m_Size{0};
+};
@@ -0,0 +1,173 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <numeric>
+#include <span>
+#include <unordered_map>
+#include <vector>
+
+#include "commandaccess.h"
+#include "threadpool.h"
+
+/// Runs a range of commands, or of pointers to commands, on a ThreadPool in conflict free waves.
+/// Each wave is split into ranges of grainSize commands which the pool's threads steal from each other,
+/// and the next wave only starts once every range of the current one has run.
+/// Commands declare what they read and write through bool DeclareAccess(CommandAccess&) const, returning false
+/// when they can't, and are placed in the wave after the last earlier command they conflict with.
+/// Commands which don't declare their accesses conflict with every other command and run in a wave of their own.
+/// Executing the waves in order gives the same result as executing the commands in order,
+/// and rolling back the waves in reverse order is its exact reverse.
+class ParallelCommandExecutor
+{
+public:
+    /// Waves of up to grainSize commands run on the calling thread, larger waves are split into
+    /// ranges of grainSize commands.
+    explicit ParallelCommandExecutor(ThreadPool& pool, const uint32_t grainSize = 1'024)
+        : m_Pool{pool}
+        , m_GrainSize{grainSize == 0 ? 1 : grainSize}
+    {
+    }
+
+    template<class TCommand>
+    void Execute(const std::span<TCommand> commands)
+    {
+        BuildWaves(commands);
+        for(uint32_t wave{0}; wave != GetWaveCount(); ++wave)
+        {
+            RunWave(commands, wave, [](TCommand& command) { GetCommand(command).Execute(); });
+        }
+    }
+
+    /// Rolls back commands which have been executed, in reverse wave order.
+    template<class TCommand>
+    void Rollback(const std::span<TCommand> commands)
+    {
+        BuildWaves(commands);
+        for(uint32_t wave{GetWaveCount()}; wave != 0;)
+        {
+            --wave;
+            RunWave(commands, wave, [](TCommand& command) { GetCommand(command).Rollback(); });
+        }
+    }
+
+    /// Number of waves the last executed or rolled back range was split into.
+    [[nodiscard]] uint32_t GetWaveCount() const
+    {
+        return static_cast<uint32_t>(m_WaveOffsets.size()) - 1;
+    }
+
+private:
+    struct ResourceState
+    {
+        uint32_t m_LastWriteWave{0};
+        uint32_t m_LastReadWave{0};
+    };
+
+    template<class TCommand>
+    [[nodiscard]] static auto& GetCommand(TCommand& command)
+    {
+        if constexpr(requires { *command; })
+            return *command;
+        else
+            return command;
+    }
+
+    /// Assigns each command the first wave after every earlier command it conflicts with.
+    template<class TCommand>
+    void BuildWaves(const std::span<TCommand> commands)
+    {
+        m_Resources.clear();
+        m_CommandWaves.resize(commands.size());
+
+        uint32_t waveCount{0};
+        uint32_t barrierWave{0};
+        for(std::size_t index{0}; index != commands.size(); ++index)
+        {
+            m_Access.Clear();
+            uint32_t wave{barrierWave + 1};
+
+            if(!GetCommand(commands[index]).DeclareAccess(m_Access))
+            {
+                wave = waveCount + 1;
+                barrierWave = wave;
+            }
+            else
+            {
+                for(const void* const resource : m_Access.GetWrites())
+                {
+                    const ResourceState& state{m_Resources[resource]};
+                    wave = std::max({wave, state.m_LastWriteWave + 1, state.m_LastReadWave + 1});
+                }
+
+                for(const void* const resource : m_Access.GetReads())
+                {
+                    wave = std::max(wave, m_Resources[resource].m_LastWriteWave + 1);
+                }
+
+                for(const void* const resource : m_Access.GetWrites())
+                {
+                    m_Resources[resource].m_LastWriteWave = wave;
+                }
+
+                for(const void* const resource : m_Access.GetReads())
+                {
+                    ResourceState& state{m_Resources[resource]};
+                    state.m_LastReadWave = std::max(state.m_LastReadWave, wave);
+                }
+            }
+
+            m_CommandWaves[index] = wave - 1;
+            waveCount = std::max(waveCount, wave);
+        }
+
+        // Counting sort of the command indices by wave
+        m_WaveOffsets.assign(waveCount + 1, 0);
+        for(const uint32_t wave : m_CommandWaves)
+        {
+            ++m_WaveOffsets[wave + 1];
+        }
+        std::partial_sum(std::begin(m_WaveOffsets), std::end(m_WaveOffsets), std::begin(m_WaveOffsets));
+
+        m_WaveCursors.assign(std::begin(m_WaveOffsets), std::end(m_WaveOffsets) - 1);
+        m_WaveCommands.resize(commands.size());
+        for(uint32_t index{0}; index != m_CommandWaves.size(); ++index)
+        {
+            m_WaveCommands[m_WaveCursors[m_CommandWaves[index]]++] = index;
+        }
+    }
+
+    template<class TCommand, class TFunction>
+    void RunWave(const std::span<TCommand> commands, const uint32_t wave, const TFunction& function)
+    {
+        const uint32_t begin{m_WaveOffsets[wave]};
+        const uint32_t end{m_WaveOffsets[wave + 1]};
+
+        if(end - begin <= m_GrainSize)
+        {
+            for(uint32_t index{begin}; index != end; ++index)
+            {
+                function(commands[m_WaveCommands[index]]);
+            }
+            return;
+        }
+
+        m_Pool.ParallelFor(end - begin, m_GrainSize,
+            [this, commands, begin, &function](const uint32_t rangeBegin, const uint32_t rangeEnd)
+            {
+                for(uint32_t index{begin + rangeBegin}; index != begin + rangeEnd; ++index)
+                {
+                    function(commands[m_WaveCommands[index]]);
+                }
+            });
+    }
+
+    ThreadPool& m_Pool;
+    CommandAccess m_Access{};
+    std::unordered_map<const void*, ResourceState> m_Resources{};
+    std::vector<uint32_t> m_CommandWaves{};
+    std::vector<uint32_t> m_WaveOffsets{0};
+    std::vector<uint32_t> m_WaveCommands{};
+    std::vector<uint32_t> m_WaveCursors{};
+    uint32_t m_GrainSize{1'024};
+};
@@ -0,0 +1,8 @@
+#pragma once
+
+#include <cstddef>
+
+/// Resident memory of the current process in bytes, used by the examples to report memory usage.
+/// Returns 0 on platforms where it is unavailable.
+[[nodiscard]] std::size_t GetCurrentResidentSetSize();
+[[nodiscard]] std::size_t GetPeakResidentSetSize();
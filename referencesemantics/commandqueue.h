@@ -1,15 +1,125 @@
 #pragma once
 
+#include <cstdint>
 #include <memory>
+#include <memory_resource>
+#include <new>
+#include <span>
 #include <utility>
+#include <vector>
 
 #include "referencesemantics/commands.h"
+#include "parallelcommandexecutor.h"
 
 namespace ReferenceSemantics
 {
+    /// Returns a command to the memory resource it was allocated from, or deletes it when it has none.
+    /// A deleter with a size of 0 only destroys the command, its memory is released in bulk with its resource.
+    class CommandDeleter
+    {
+    public:
+        CommandDeleter() = default;
+
+        CommandDeleter(std::default_delete<Command>)
+        {
+        }
+
+        CommandDeleter(std::pmr::memory_resource* resource, const uint32_t size, const uint32_t alignment)
+            : m_Resource{resource}
+            , m_Size{size}
+            , m_Alignment{alignment}
+        {
+        }
+
+        void operator()(Command* command) const
+        {
+            if(!m_Resource)
+            {
+                delete command;
+                return;
+            }
+
+            void* const memory{dynamic_cast<void*>(command)};
+            command->~Command();
+            if(m_Size != 0)
+                m_Resource->deallocate(memory, m_Size, m_Alignment);
+        }
+    private:
+        std::pmr::memory_resource* m_Resource{nullptr};
+        uint32_t m_Size{0};
+        uint32_t m_Alignment{0};
+    };
+
+    using CommandPointer = std::unique_ptr<Command, CommandDeleter>;
+
+    /// Rules for folding a queued command into the last command in the queue through Command::TryMerge().
+    enum class CoalescePolicy
+    {
+        /// Every queued command is kept as its own entry.
+        Disabled,
+        /// Commands are only merged into the last command while it is still pending.
+        PendingOnly,
+        /// As PendingOnly, and with no pending commands a command may also be merged into the last executed one.
+        /// The merged command is executed immediately so the queue's state stays consistent with its history.
+        AcrossCursor
+    };
+
     class CommandQueue
     {
     public:
+        CommandQueue() = default;
+
+        /// Commands created through Emplace() are allocated from resource, which has to outlive the queue.
+        /// Commands allocated from a std::pmr::monotonic_buffer_resource are only destroyed when removed,
+        /// their memory is reclaimed when the caller releases the resource.
+        explicit CommandQueue(std::pmr::memory_resource* resource)
+            : m_Resource{resource}
+            , m_IsMonotonic{dynamic_cast<std::pmr::monotonic_buffer_resource*>(resource) != nullptr}
+        {
+        }
+
+        /// Commands created through Emplace() are allocated from a monotonic arena owned by the queue, which starts
+        /// in arenaBuffer and grows from upstream once it's full. ClearQueue() releases the whole arena at once,
+        /// so a frame of commands which fits within arenaBuffer never allocates. arenaBuffer has to outlive the queue.
+        CommandQueue(const std::span<std::byte> arenaBuffer, std::pmr::memory_resource* const upstream = std::pmr::get_default_resource())
+            : m_Arena{std::make_unique<std::pmr::monotonic_buffer_resource>(arenaBuffer.data(), arenaBuffer.size(), upstream)}
+            , m_Resource{m_Arena.get()}
+            , m_IsMonotonic{true}
+        {
+        }
+
+        /// The moved-from queue is left empty, allocating from std::pmr::get_default_resource().
+        CommandQueue(CommandQueue&& other) noexcept
+            : m_Arena{std::move(other.m_Arena)}
+            , m_CommandQueue{std::move(other.m_CommandQueue)}
+            , m_Resource{std::exchange(other.m_Resource, std::pmr::get_default_resource())}
+            , m_AllocationCount{other.m_AllocationCount}
+            , m_CommandIndex{std::exchange(other.m_CommandIndex, 0)}
+            , m_CoalescePolicy{other.m_CoalescePolicy}
+            , m_IsMonotonic{std::exchange(other.m_IsMonotonic, false)}
+        {
+            other.m_CommandQueue.clear();
+        }
+
+        /// The moved-from queue is left empty, allocating from std::pmr::get_default_resource().
+        CommandQueue& operator=(CommandQueue&& other) noexcept
+        {
+            if(this == &other)
+                return *this;
+
+            // The commands have to be destroyed before the arena they were allocated from
+            m_CommandQueue.clear();
+            m_Arena = std::move(other.m_Arena);
+            m_CommandQueue = std::move(other.m_CommandQueue);
+            other.m_CommandQueue.clear();
+            m_Resource = std::exchange(other.m_Resource, std::pmr::get_default_resource());
+            m_AllocationCount = other.m_AllocationCount;
+            m_CommandIndex = std::exchange(other.m_CommandIndex, 0);
+            m_CoalescePolicy = other.m_CoalescePolicy;
+            m_IsMonotonic = std::exchange(other.m_IsMonotonic, false);
+            return *this;
+        }
+
         /// HasPendingCommand() has to be true before calling
         void ExecuteCommand()
         {
@@ -24,18 +134,78 @@ namespace ReferenceSemantics
             m_CommandQueue[m_CommandIndex]->Rollback();
         }
 
+        /// Executes every pending command.
+        void ExecuteAll()
+        {
+            ExecuteN(GetCommandQueueSize() - m_CommandIndex);
+        }
+
+        /// count has to be no greater than the number of pending commands
+        void ExecuteN(const uint32_t count)
+        {
+            const uint32_t end{m_CommandIndex + count};
+            for(uint32_t index{m_CommandIndex}; index != end; ++index)
+            {
+                m_CommandQueue[index]->Execute();
+            }
+            m_CommandIndex = end;
+        }
+
+        /// Rolls back commands until GetCommandIndex() == index.
+        /// index has to be no greater than GetCommandIndex()
+        void RollbackTo(const uint32_t index)
+        {
+            for(uint32_t current{m_CommandIndex}; current != index;)
+            {
+                --current;
+                m_CommandQueue[current]->Rollback();
+            }
+            m_CommandIndex = index;
+        }
+
+        /// Executes every pending command through executor, running commands with disjoint accesses in parallel.
+        /// The result is the same as ExecuteAll().
+        void ExecuteAll(ParallelCommandExecutor& executor)
+        {
+            executor.Execute(std::span{m_CommandQueue}.subspan(m_CommandIndex));
+            m_CommandIndex = GetCommandQueueSize();
+        }
+
+        /// Rolls back commands until GetCommandIndex() == index through executor, the exact reverse of executing them.
+        /// index has to be no greater than GetCommandIndex()
+        void RollbackTo(const uint32_t index, ParallelCommandExecutor& executor)
+        {
+            executor.Rollback(std::span{m_CommandQueue}.subspan(index, m_CommandIndex - index));
+            m_CommandIndex = index;
+        }
+
+        /// Executes or rolls back commands until GetCommandIndex() == index.
+        /// index has to be no greater than GetCommandQueueSize()
+        void SeekTo(const uint32_t index)
+        {
+            if(index > m_CommandIndex)
+                ExecuteN(index - m_CommandIndex);
+            else
+                RollbackTo(index);
+        }
+
+        /// Also releases the queue's own arena, all at once.
         void ClearQueue()
         {
             m_CommandQueue.clear();
             m_CommandIndex = 0;
+            ReleaseArena();
         }
 
         /// Removes any commands ahead of and including the current pending command.
+        /// The queue's own arena can only be released as a whole, so it is released once no commands are left.
         /// HasPendingCommand() has to be true before calling
         void ClearPendingCommands()
         {
             const auto itr{std::begin(m_CommandQueue) + m_CommandIndex};
             m_CommandQueue.erase(itr, std::end(m_CommandQueue));
+            if(m_CommandQueue.empty())
+                ReleaseArena();
         }
 
         [[nodiscard]] bool HasPendingCommand() const
@@ -50,7 +220,59 @@ namespace ReferenceSemantics
 
         void QueueCommand(std::unique_ptr<Command>&& command)
         {
-            m_CommandQueue.push_back(std::move(command));
+            if(TryCoalesce(*command))
+                return;
+
+            m_CommandQueue.push_back(CommandPointer{std::move(command)});
+        }
+
+        /// Constructs TCommand in memory allocated from the queue's memory resource.
+        template<class TCommand, class... TArgs>
+        void Emplace(TArgs&&... args)
+        {
+            void* const memory{m_Resource->allocate(sizeof(TCommand), alignof(TCommand))};
+            ++m_AllocationCount;
+
+            TCommand* command{nullptr};
+            try
+            {
+                command = ::new(memory) TCommand(std::forward<TArgs>(args)...);
+            }
+            catch(...)
+            {
+                m_Resource->deallocate(memory, sizeof(TCommand), alignof(TCommand));
+                throw;
+            }
+
+            CommandPointer pointer{
+                command,
+                CommandDeleter{m_Resource, m_IsMonotonic ? 0 : static_cast<uint32_t>(sizeof(TCommand)), static_cast<uint32_t>(alignof(TCommand))}};
+
+            if(TryCoalesce(*pointer))
+                return;
+
+            m_CommandQueue.push_back(std::move(pointer));
+        }
+
+        void SetCoalescePolicy(const CoalescePolicy policy)
+        {
+            m_CoalescePolicy = policy;
+        }
+
+        [[nodiscard]] CoalescePolicy GetCoalescePolicy() const
+        {
+            return m_CoalescePolicy;
+        }
+
+        /// Number of commands allocated from the queue's memory resource.
+        [[nodiscard]] uint64_t GetAllocationCount() const
+        {
+            return m_AllocationCount;
+        }
+
+        [[nodiscard]] std::pmr::memory_resource* GetMemoryResource() const
+        {
+            return m_Resource;
         }
 
         [[nodiscard]] uint32_t GetCommandIndex() const
@@ -63,7 +285,36 @@ namespace ReferenceSemantics
             return static_cast<uint32_t>(m_CommandQueue.size());
         }
     private:
-        std::vector<std::unique_ptr<Command>> m_CommandQueue{};
+        void ReleaseArena()
+        {
+            if(m_Arena)
+                m_Arena->release();
+        }
+
+        /// Merges command into the last queued command when the coalesce policy allows it.
+        [[nodiscard]] bool TryCoalesce(Command& command)
+        {
+            if(m_CoalescePolicy == CoalescePolicy::Disabled || m_CommandQueue.empty())
+                return false;
+
+            if(HasPendingCommand())
+                return m_CommandQueue.back()->TryMerge(command);
+
+            if(m_CoalescePolicy != CoalescePolicy::AcrossCursor || !m_CommandQueue.back()->TryMerge(command))
+                return false;
+
+            command.Execute();
+            return true;
+        }
+
+        /// Declared before the commands, which are destroyed first.
+        std::unique_ptr<std::pmr::monotonic_buffer_resource> m_Arena{};
+        std::vector<CommandPointer> m_CommandQueue{};
+        std::pmr::memory_resource* m_Resource{std::pmr::get_default_resource()};
+        uint64_t m_AllocationCount{0};
         uint32_t m_CommandIndex{0};
+        CoalescePolicy m_CoalescePolicy{CoalescePolicy::Disabled};
+        /// Monotonic resources don't reclaim deallocated memory, commands allocated from them are only destroyed.
+        bool m_IsMonotonic{false};
     };
 }
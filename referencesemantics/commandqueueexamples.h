@@ -1,11 +1,20 @@
 #pragma once
 
+#include <array>
+#include <memory_resource>
+
 #include <catch2/catch_test_macros.hpp>
 #include <catch2/benchmark/catch_benchmark.hpp>
 
 #include "referencesemantics/commands.h"
 #include "referencesemantics/commandqueue.h"
+#include "referencesemantics/storedvaluecommands.h"
+#include "allocationcounter.h"
+#include "countingmemoryresource.h"
+#include "parallelcommandexecutor.h"
+#include "threadpool.h"
 #include "workingvalue.h"
+#include "workingvaluestore.h"
 
 namespace ReferenceSemantics
 {
@@ -29,6 +38,22 @@ namespace ReferenceSemantics
             {
                 m_Value->ModifyValue(-m_Modification);
             }
+
+            bool TryMerge(const Command& next) override
+            {
+                const ModifyValueCommand* const command{dynamic_cast<const ModifyValueCommand*>(&next)};
+                if(!command || command->m_Value != m_Value || !WorkingValue::CanMerge(m_Modification, command->m_Modification))
+                    return false;
+
+                m_Modification += command->m_Modification;
+                return true;
+            }
+
+            bool DeclareAccess(CommandAccess& access) const override
+            {
+                access.Write(m_Value.get());
+                return true;
+            }
         private:
             std::shared_ptr<WorkingValue> m_Value{};
             WorkingValue::ValueType m_Modification{};
@@ -48,6 +73,18 @@ namespace ReferenceSemantics
                 });
         }
 
+        [[nodiscard]] static std::unique_ptr<Command> CreateDirectionalLambdaCommand(
+            std::shared_ptr<WorkingValue> value, const int32_t valueModification)
+        {
+            auto function{
+                [value = std::move(value), valueModification](const Direction direction)
+                {
+                    value->ModifyValue(direction == Direction::Execute ? valueModification : -valueModification);
+                }};
+
+            return std::make_unique<DirectionalLambdaCommand<decltype(function)>>(std::move(function));
+        }
+
         [[nodiscard]] static std::unique_ptr<ModifyValueCommand> CreateCommand(
             std::shared_ptr<WorkingValue> value, const int32_t valueModification)
         {
@@ -272,10 +309,340 @@ namespace ReferenceSemantics
             REQUIRE(queue.GetCommandIndex() == 0);
             REQUIRE(queue.GetCommandQueueSize() == 3);
         }
+
+        SECTION("Directional Lambda Commands")
+        {
+            queue.QueueCommand(CreateDirectionalLambdaCommand(value, 1));
+            queue.QueueCommand(CreateCommand(value, 2));
+            queue.QueueCommand(CreateDirectionalLambdaCommand(value, 3));
+            REQUIRE(value.use_count() == 4);
+
+            queue.ExecuteCommand(); // +1
+            queue.ExecuteCommand(); // +2
+            queue.ExecuteCommand(); // +3
+            REQUIRE(value->GetValue() == 6);
+
+            queue.RollbackCommand(); // -3
+            REQUIRE(value->GetValue() == 3);
+
+            queue.RollbackCommand(); // -2
+            queue.RollbackCommand(); // -1
+            REQUIRE(value->GetValue() == 0);
+        }
+
+        SECTION("Bulk Cursor Commands")
+        {
+            queue.QueueCommand(CreateCommand(value, 1));
+            queue.QueueCommand(CreateCommand(value, 2));
+            queue.QueueCommand(CreateLambdaCommand(value, 3));
+            queue.QueueCommand(CreateLambdaCommand(value, 4));
+            queue.QueueCommand(CreateCommand(value, 5));
+
+            queue.ExecuteN(2); // +1, +2
+            REQUIRE(value->GetValue() == 3);
+            REQUIRE(queue.GetCommandIndex() == 2);
+
+            queue.ExecuteAll(); // +3, +4, +5
+            REQUIRE(value->GetValue() == 15);
+            REQUIRE_FALSE(queue.HasPendingCommand());
+            REQUIRE(queue.GetCommandIndex() == 5);
+
+            queue.RollbackTo(1); // -5, -4, -3, -2
+            REQUIRE(value->GetValue() == 1);
+            REQUIRE(queue.GetCommandIndex() == 1);
+
+            queue.SeekTo(4); // +2, +3, +4
+            REQUIRE(value->GetValue() == 10);
+            REQUIRE(queue.GetCommandIndex() == 4);
+
+            queue.SeekTo(3); // -4
+            REQUIRE(value->GetValue() == 6);
+            REQUIRE(queue.GetCommandIndex() == 3);
+
+            queue.SeekTo(3);
+            REQUIRE(value->GetValue() == 6);
+
+            queue.RollbackTo(0); // -3, -2, -1
+            REQUIRE(value->GetValue() == 0);
+            REQUIRE(queue.GetCommandIndex() == 0);
+            REQUIRE_FALSE(queue.HasPendingRollbackCommand());
+            REQUIRE(queue.GetCommandQueueSize() == 5);
+        }
+
+        SECTION("Coalesce Commands")
+        {
+            std::shared_ptr<WorkingValue> otherValue{std::make_shared<WorkingValue>()};
+            REQUIRE(queue.GetCoalescePolicy() == CoalescePolicy::Disabled);
+
+            queue.SetCoalescePolicy(CoalescePolicy::PendingOnly);
+            queue.QueueCommand(CreateCommand(value, 1));
+            queue.Emplace<ModifyValueCommand>(value, 2); // Merged into +1
+            queue.QueueCommand(CreateCommand(otherValue, 4));
+            queue.QueueCommand(CreateLambdaCommand(value, 8));
+            queue.QueueCommand(CreateCommand(value, 16));
+            REQUIRE(queue.GetCommandQueueSize() == 4);
+            REQUIRE(value.use_count() == 5);
+
+            queue.ExecuteAll(); // +3, +4, +8, +16
+            REQUIRE(value->GetValue() == 27);
+            REQUIRE(otherValue->GetValue() == 4);
+
+            queue.QueueCommand(CreateCommand(value, 32)); // Not merged into the executed +16
+            REQUIRE(queue.GetCommandQueueSize() == 5);
+
+            queue.ExecuteCommand(); // +32
+            queue.SetCoalescePolicy(CoalescePolicy::AcrossCursor);
+            queue.QueueCommand(CreateCommand(value, 64)); // Merged into the executed +32 and executed
+            REQUIRE(value->GetValue() == 123);
+            REQUIRE_FALSE(queue.HasPendingCommand());
+            REQUIRE(queue.GetCommandQueueSize() == 5);
+
+            queue.RollbackCommand(); // -96
+            REQUIRE(value->GetValue() == 27);
+
+            queue.RollbackTo(0); // -16, -8, -4, -3
+            REQUIRE(value->GetValue() == 0);
+            REQUIRE(otherValue->GetValue() == 0);
+        }
+
+        SECTION("Stored Value Commands")
+        {
+            WorkingValueStore& store{WorkingValueStore::GetShared()};
+            const WorkingValueHandle storedValue{store.Create()};
+            const WorkingValueHandle otherStoredValue{store.Create()};
+
+            queue.SetCoalescePolicy(CoalescePolicy::PendingOnly);
+            queue.Emplace<ModifyStoredValueCommand>(storedValue, 1);
+            queue.Emplace<ModifyStoredValueCommand>(storedValue, 2); // Merged into +1
+            queue.Emplace<ModifyStoredValueCommand>(otherStoredValue, 4);
+            REQUIRE(queue.GetCommandQueueSize() == 2);
+
+            queue.ExecuteAll();
+            REQUIRE(store.Find(storedValue)->GetValue() == 3);
+            REQUIRE(store.Find(otherStoredValue)->GetValue() == 4);
+
+            // The destroyed value is skipped and reported to the handler rather than asserting
+            const WorkingValueStore::StaleHandleHandler previousHandler{store.SetStaleHandleHandler([](WorkingValueHandle) {})};
+            const uint32_t staleHandleCount{store.GetStaleHandleCount()};
+            const ModifyStoredValueCommand staleCommand{otherStoredValue, 1};
+            REQUIRE(staleCommand.IsValid());
+            REQUIRE(store.Destroy(otherStoredValue));
+            REQUIRE_FALSE(staleCommand.IsValid());
+
+            queue.RollbackTo(0);
+            REQUIRE(store.Find(storedValue)->GetValue() == 0);
+            REQUIRE(store.GetStaleHandleCount() == staleHandleCount + 1);
+
+            store.SetStaleHandleHandler(previousHandler);
+            REQUIRE(store.Destroy(storedValue));
+        }
+
+        SECTION("Parallel Execute Commands")
+        {
+            ThreadPool pool{4};
+            ParallelCommandExecutor executor{pool, 2};
+            std::shared_ptr<WorkingValue> otherValue{std::make_shared<WorkingValue>()};
+
+            for(int32_t i{1}; i != 9; ++i)
+            {
+                queue.QueueCommand(CreateCommand(i % 2 == 0 ? value : otherValue, i));
+            }
+            queue.QueueCommand(CreateLambdaCommand(value, 100)); // Undeclared, runs alone
+            queue.QueueCommand(CreateCommand(otherValue, 1000));
+
+            queue.ExecuteAll(executor);
+            REQUIRE(executor.GetWaveCount() == 6);
+            REQUIRE(value->GetValue() == 120);
+            REQUIRE(otherValue->GetValue() == 1016);
+            REQUIRE(queue.GetCommandIndex() == 10);
+
+            queue.RollbackTo(4, executor);
+            REQUIRE(value->GetValue() == 6);
+            REQUIRE(otherValue->GetValue() == 4);
+            REQUIRE(queue.GetCommandIndex() == 4);
+
+            queue.RollbackTo(0);
+            REQUIRE(value->GetValue() == 0);
+            REQUIRE(otherValue->GetValue() == 0);
+        }
+    }
+
+    TEST_CASE("Command Queue - Reference Semantics - Memory Resource Unit Tests")
+    {
+        std::shared_ptr<WorkingValue> value{std::make_shared<WorkingValue>()};
+        CountingMemoryResource upstream{std::pmr::new_delete_resource()};
+
+        SECTION("Emplace Commands")
+        {
+            CommandQueue queue{&upstream};
+            queue.Emplace<ModifyValueCommand>(value, 1);
+            queue.QueueCommand(CreateLambdaCommand(value, 2));
+            queue.Emplace<ModifyValueCommand>(value, 3);
+            REQUIRE(queue.GetCommandQueueSize() == 3);
+            REQUIRE(queue.GetAllocationCount() == 2);
+            REQUIRE(upstream.GetAllocationCount() == 2);
+
+            queue.ExecuteCommand(); // +1
+            queue.ExecuteCommand(); // +2
+            queue.ExecuteCommand(); // +3
+            REQUIRE(value->GetValue() == 6);
+
+            queue.RollbackCommand(); // -3
+            queue.ClearPendingCommands(); // Remove +3
+            REQUIRE(value->GetValue() == 3);
+            REQUIRE(upstream.GetDeallocationCount() == 1);
+
+            queue.ClearQueue(); // Remove +1, +2
+            REQUIRE(upstream.GetDeallocationCount() == 2);
+            REQUIRE(upstream.GetAllocatedBytes() == 0);
+            REQUIRE(value.use_count() == 1);
+        }
+
+        SECTION("Monotonic Frames")
+        {
+            constexpr uint32_t frameCount{10};
+            constexpr uint32_t commandsPerFrame{100};
+            std::array<std::byte, 16 * 1024> frameBuffer{};
+            std::pmr::monotonic_buffer_resource arena{frameBuffer.data(), frameBuffer.size(), &upstream};
+            CommandQueue queue{&arena};
+
+            for(uint32_t frame{0}; frame != frameCount; ++frame)
+            {
+                // The first frame grows the queue's own storage, every frame after it should not allocate.
+                const AllocationCounter counter{};
+
+                for(uint32_t i{0}; i != commandsPerFrame; ++i)
+                {
+                    queue.Emplace<ModifyValueCommand>(value, 1);
+                }
+
+                while(queue.HasPendingCommand())
+                {
+                    queue.ExecuteCommand();
+                }
+
+                queue.ClearQueue();
+                arena.release();
+
+                if(frame != 0)
+                {
+                    REQUIRE(counter.GetAllocationCount() == 0);
+                }
+            }
+
+            REQUIRE(value->GetValue() == frameCount * commandsPerFrame);
+            REQUIRE(queue.GetAllocationCount() == frameCount * commandsPerFrame);
+            REQUIRE(upstream.GetAllocationCount() == 0);
+            REQUIRE(value.use_count() == 1);
+        }
+
+        SECTION("Owned Arena")
+        {
+            constexpr uint32_t frameCount{10};
+            constexpr uint32_t commandsPerFrame{100};
+            std::array<std::byte, 16 * 1024> frameBuffer{};
+            CommandQueue queue{std::span{frameBuffer}, &upstream};
+
+            for(uint32_t frame{0}; frame != frameCount; ++frame)
+            {
+                for(uint32_t i{0}; i != commandsPerFrame; ++i)
+                {
+                    queue.Emplace<ModifyValueCommand>(value, 1);
+                }
+
+                while(queue.HasPendingCommand())
+                {
+                    queue.ExecuteCommand();
+                }
+
+                // Releases the arena, so every frame reuses frameBuffer from its start
+                queue.ClearQueue();
+            }
+
+            REQUIRE(value->GetValue() == frameCount * commandsPerFrame);
+            REQUIRE(queue.GetAllocationCount() == frameCount * commandsPerFrame);
+            REQUIRE(upstream.GetAllocationCount() == 0);
+            REQUIRE(value.use_count() == 1);
+        }
+
+        SECTION("Move Owned Arena")
+        {
+            std::array<std::byte, 16 * 1024> frameBuffer{};
+            CommandQueue queue{std::span{frameBuffer}, &upstream};
+            queue.Emplace<ModifyValueCommand>(value, 1);
+
+            CommandQueue movedQueue{std::move(queue)};
+            REQUIRE(queue.GetMemoryResource() == std::pmr::get_default_resource());
+            REQUIRE(queue.GetCommandQueueSize() == 0);
+            REQUIRE(movedQueue.GetCommandQueueSize() == 1);
+
+            CommandQueue assignedQueue{&upstream};
+            assignedQueue = std::move(movedQueue);
+            REQUIRE(movedQueue.GetMemoryResource() == std::pmr::get_default_resource());
+            REQUIRE(movedQueue.GetCommandQueueSize() == 0);
+
+            // The moved-from queues allocate on their own, never from the arena the assigned queue owns
+            queue.Emplace<ModifyValueCommand>(value, 2);
+            movedQueue.Emplace<ModifyValueCommand>(value, 4);
+            assignedQueue.ExecuteCommand();
+            queue.ExecuteCommand();
+            movedQueue.ExecuteCommand();
+            REQUIRE(value->GetValue() == 7);
+
+            assignedQueue.ClearQueue();
+            REQUIRE(upstream.GetAllocationCount() == 0);
+        }
     }
 
     TEST_CASE("Command Queue - Reference Semantics - Creation Benchmark")
     {
+        {
+            std::shared_ptr<WorkingValue> value{std::make_shared<WorkingValue>()};
+
+            const AllocationCounter lambdaCounter{};
+            const std::unique_ptr<Command> lambdaCommand{CreateLambdaCommand(value, 0)};
+            REQUIRE(lambdaCounter.GetAllocationCount() >= 1);
+
+            // Only the command itself is allocated, the lambda's capture is stored inline.
+            const AllocationCounter directionalCounter{};
+            const std::unique_ptr<Command> directionalCommand{CreateDirectionalLambdaCommand(value, 0)};
+            REQUIRE(directionalCounter.GetAllocationCount() == 1);
+        }
+
+        BENCHMARK("Lambda Commands")
+        {
+            constexpr uint32_t creationCount{50'000};
+            std::shared_ptr<WorkingValue> value{std::make_shared<WorkingValue>()};
+            CommandQueue queue{};
+
+            for(uint32_t i{0}; i != creationCount; ++i)
+            {
+                queue.QueueCommand(CreateLambdaCommand(value, 0));
+            }
+
+            while(queue.HasPendingCommand())
+            {
+                queue.ExecuteCommand();
+            }
+        };
+
+        BENCHMARK("Directional Lambda Commands")
+        {
+            constexpr uint32_t creationCount{50'000};
+            std::shared_ptr<WorkingValue> value{std::make_shared<WorkingValue>()};
+            CommandQueue queue{};
+
+            for(uint32_t i{0}; i != creationCount; ++i)
+            {
+                queue.QueueCommand(CreateDirectionalLambdaCommand(value, 0));
+            }
+
+            while(queue.HasPendingCommand())
+            {
+                queue.ExecuteCommand();
+            }
+        };
+
         BENCHMARK("Benchmark")
         {
             constexpr uint32_t creationCount{50'000};
@@ -324,5 +691,53 @@ namespace ReferenceSemantics
                 queue.RollbackCommand();
             }
         };
+
+        BENCHMARK("Bulk")
+        {
+            queue.ExecuteAll();
+            queue.RollbackTo(0);
+        };
+    }
+
+    TEST_CASE("Command Queue - Reference Semantics - Memory Resource Benchmark")
+    {
+        constexpr uint32_t creationCount{50'000};
+        std::shared_ptr<WorkingValue> value{std::make_shared<WorkingValue>()};
+
+        CommandQueue heapQueue{};
+
+        BENCHMARK("Global Heap")
+        {
+            for(uint32_t i{0}; i != creationCount; ++i)
+            {
+                heapQueue.QueueCommand(CreateCommand(value, 0));
+            }
+
+            while(heapQueue.HasPendingCommand())
+            {
+                heapQueue.ExecuteCommand();
+            }
+
+            heapQueue.ClearQueue();
+        };
+
+        std::pmr::monotonic_buffer_resource arena{};
+        CommandQueue arenaQueue{&arena};
+
+        BENCHMARK("Monotonic Arena")
+        {
+            for(uint32_t i{0}; i != creationCount; ++i)
+            {
+                arenaQueue.Emplace<ModifyValueCommand>(value, 0);
+            }
+
+            while(arenaQueue.HasPendingCommand())
+            {
+                arenaQueue.ExecuteCommand();
+            }
+
+            arenaQueue.ClearQueue();
+            arena.release();
+        };
     }
 }
@@ -1,6 +1,9 @@
 #pragma once
 
 #include <functional>
+#include <utility>
+
+#include "commandaccess.h"
 
 namespace ReferenceSemantics
 {
@@ -10,6 +13,20 @@ namespace ReferenceSemantics
         virtual ~Command() = default;
         virtual void Execute() = 0;
         virtual void Rollback() = 0;
+
+        /// Absorbs next into this command so executing it once has the effect of executing both.
+        /// Returns false, leaving both commands untouched, when next cannot be merged.
+        virtual bool TryMerge(const Command&)
+        {
+            return false;
+        }
+
+        /// Adds the resources the command reads and writes to access. Returns false when the command
+        /// can't declare them, it then conflicts with every other command.
+        virtual bool DeclareAccess(CommandAccess&) const
+        {
+            return false;
+        }
     };
 
     class LambdaCommand final : public Command
@@ -36,4 +53,34 @@ namespace ReferenceSemantics
         FunctionSignature m_Execute{};
         FunctionSignature m_Rollback{};
     };
+
+    enum class Direction
+    {
+        Execute,
+        Rollback
+    };
+
+    /// Runs execute and rollback through a single callable taking the Direction to run,
+    /// so any state it captures is shared by both. TFunction is stored inline and only needs to be movable.
+    template<class TFunction>
+    class DirectionalLambdaCommand final : public Command
+    {
+    public:
+        explicit DirectionalLambdaCommand(TFunction&& function)
+            : m_Function{std::move(function)}
+        {
+        }
+
+        void Execute() override
+        {
+            m_Function(Direction::Execute);
+        }
+
+        void Rollback() override
+        {
+            m_Function(Direction::Rollback);
+        }
+    private:
+        TFunction m_Function;
+    };
 }
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <cstdint>
+
+#include "referencesemantics/commands.h"
+#include "commandaccess.h"
+#include "workingvalue.h"
+#include "workingvaluestore.h"
+
+namespace ReferenceSemantics
+{
+    /// Modifies a value of WorkingValueStore::GetShared() by handle, so the command holds no reference count.
+    /// Like ValueSemantics::ModifyStoredValueCommand it holds no store pointer and always resolves through the shared
+    /// store, values of any other WorkingValueStore can't be targeted.
+    /// Executing or rolling back once the value has been destroyed does nothing but report the stale handle
+    /// through WorkingValueStore::Resolve(), check IsValid() first to avoid that.
+    class ModifyStoredValueCommand final : public Command
+    {
+    public:
+        ModifyStoredValueCommand(const WorkingValueHandle value, const int32_t valueModification)
+            : m_Value{value}
+            , m_Modification{valueModification}
+        {
+        }
+
+        void Execute() override
+        {
+            if(WorkingValue* const value{WorkingValueStore::GetShared().Resolve(m_Value)})
+                value->ModifyValue(m_Modification);
+        }
+
+        void Rollback() override
+        {
+            if(WorkingValue* const value{WorkingValueStore::GetShared().Resolve(m_Value)})
+                value->ModifyValue(-m_Modification);
+        }
+
+        /// Sums next's modification into this command when both modify the same value
+        /// and WorkingValue::CanMerge() allows it.
+        bool TryMerge(const Command& next) override
+        {
+            const ModifyStoredValueCommand* const command{dynamic_cast<const ModifyStoredValueCommand*>(&next)};
+            if(!command || command->m_Value != m_Value || !WorkingValue::CanMerge(m_Modification, command->m_Modification))
+                return false;
+
+            m_Modification += command->m_Modification;
+            return true;
+        }
+
+        bool DeclareAccess(CommandAccess& access) const override
+        {
+            access.Write(WorkingValueStore::GetShared().Find(m_Value));
+            return true;
+        }
+
+        /// False once the value has been destroyed.
+        [[nodiscard]] bool IsValid() const
+        {
+            return WorkingValueStore::GetShared().Contains(m_Value);
+        }
+    private:
+        WorkingValueHandle m_Value{};
+        WorkingValue::ValueType m_Modification{};
+    };
+}
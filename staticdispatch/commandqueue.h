@@ -0,0 +1,154 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <variant>
+#include <vector>
+
+namespace StaticDispatch
+{
+    /// Stores a closed set of command types as a variant.
+    /// Execute/Rollback are dispatched on the variant's index rather than through a virtual call,
+    /// allowing the compiler to inline each command's Execute/Rollback.
+    template<class... TCommands>
+    class CommandQueue
+    {
+    public:
+        using Command = std::variant<TCommands...>;
+
+        /// HasPendingCommand() has to be true before calling
+        void ExecuteCommand()
+        {
+            std::visit(
+                [](auto& command)
+                {
+                    command.Execute();
+                },
+                m_CommandQueue[m_CommandIndex]);
+            ++m_CommandIndex;
+        }
+
+        /// HasPendingRollbackCommand() has to be true before calling
+        void RollbackCommand()
+        {
+            --m_CommandIndex;
+            std::visit(
+                [](auto& command)
+                {
+                    command.Rollback();
+                },
+                m_CommandQueue[m_CommandIndex]);
+        }
+
+        /// Executes every pending command.
+        void ExecuteAll()
+        {
+            ExecuteN(GetCommandQueueSize() - m_CommandIndex);
+        }
+
+        /// Consecutive commands of the same type are dispatched once per run rather than once per command.
+        /// count has to be no greater than the number of pending commands
+        void ExecuteN(const uint32_t count)
+        {
+            const uint32_t end{m_CommandIndex + count};
+            uint32_t index{m_CommandIndex};
+            while(index != end)
+            {
+                index = std::visit(
+                    [this, index, end]<class TCommand>(TCommand&)
+                    {
+                        const std::size_t type{m_CommandQueue[index].index()};
+                        uint32_t current{index};
+                        do
+                        {
+                            std::get_if<TCommand>(&m_CommandQueue[current])->Execute();
+                            ++current;
+                        }
+                        while(current != end && m_CommandQueue[current].index() == type);
+                        return current;
+                    },
+                    m_CommandQueue[index]);
+            }
+            m_CommandIndex = end;
+        }
+
+        /// Rolls back commands until GetCommandIndex() == index.
+        /// Consecutive commands of the same type are dispatched once per run rather than once per command.
+        /// index has to be no greater than GetCommandIndex()
+        void RollbackTo(const uint32_t index)
+        {
+            uint32_t end{m_CommandIndex};
+            while(end != index)
+            {
+                end = std::visit(
+                    [this, index, end]<class TCommand>(TCommand&)
+                    {
+                        const std::size_t type{m_CommandQueue[end - 1].index()};
+                        uint32_t current{end};
+                        do
+                        {
+                            --current;
+                            std::get_if<TCommand>(&m_CommandQueue[current])->Rollback();
+                        }
+                        while(current != index && m_CommandQueue[current - 1].index() == type);
+                        return current;
+                    },
+                    m_CommandQueue[end - 1]);
+            }
+            m_CommandIndex = index;
+        }
+
+        /// Executes or rolls back commands until GetCommandIndex() == index.
+        /// index has to be no greater than GetCommandQueueSize()
+        void SeekTo(const uint32_t index)
+        {
+            if(index > m_CommandIndex)
+                ExecuteN(index - m_CommandIndex);
+            else
+                RollbackTo(index);
+        }
+
+        void ClearQueue()
+        {
+            m_CommandQueue.clear();
+            m_CommandIndex = 0;
+        }
+
+        /// Removes any commands ahead of and including the current pending command.
+        /// HasPendingCommand() has to be true before calling
+        void ClearPendingCommands()
+        {
+            const auto itr{std::begin(m_CommandQueue) + m_CommandIndex};
+            m_CommandQueue.erase(itr, std::end(m_CommandQueue));
+        }
+
+        [[nodiscard]] bool HasPendingCommand() const
+        {
+            return GetCommandQueueSize() > m_CommandIndex;
+        }
+
+        [[nodiscard]] bool HasPendingRollbackCommand() const
+        {
+            return m_CommandIndex != 0 && GetCommandQueueSize() >= m_CommandIndex;
+        }
+
+        void QueueCommand(Command&& command)
+        {
+            m_CommandQueue.push_back(std::move(command));
+        }
+
+        [[nodiscard]] uint32_t GetCommandIndex() const
+        {
+            return m_CommandIndex;
+        }
+
+        [[nodiscard]] uint32_t GetCommandQueueSize() const
+        {
+            return static_cast<uint32_t>(m_CommandQueue.size());
+        }
+    private:
+        std::vector<Command> m_CommandQueue{};
+        uint32_t m_CommandIndex{0};
+    };
+}
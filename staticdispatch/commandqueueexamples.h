@@ -0,0 +1,425 @@
+#pragma once
+
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/benchmark/catch_benchmark.hpp>
+
+#include "referencesemantics/commandqueue.h"
+#include "referencesemantics/commands.h"
+#include "staticdispatch/commandqueue.h"
+#include "valuesemantics/commandqueue.h"
+#include "valuesemantics/commands.h"
+#include "workingvalue.h"
+
+namespace StaticDispatch
+{
+    namespace
+    {
+        using TestCommandQueue = CommandQueue<ValueSemantics::ModifyValueCommand, ValueSemantics::LambdaCommand>;
+
+        [[nodiscard]] static ValueSemantics::LambdaCommand CreateLambdaCommand(
+            std::shared_ptr<WorkingValue> value, const int32_t valueModification)
+        {
+            return ValueSemantics::LambdaCommand{
+                [value, valueModification]
+                {
+                    value->ModifyValue(valueModification);
+                },
+                [value, valueModification]
+                {
+                    value->ModifyValue(-valueModification);
+                }};
+        }
+
+        [[nodiscard]] static ValueSemantics::ModifyValueCommand CreateCommand(
+            std::shared_ptr<WorkingValue> value, const int32_t valueModification)
+        {
+            return ValueSemantics::ModifyValueCommand{value, valueModification};
+        }
+
+        /// ModifyValueCommand dispatched through ReferenceSemantics::Command's virtual functions.
+        class VirtualModifyValueCommand final : public ReferenceSemantics::Command
+        {
+        public:
+            VirtualModifyValueCommand(std::shared_ptr<WorkingValue> value, const int32_t valueModification)
+                : m_Value{std::move(value)}
+                , m_Modification{valueModification}
+            {
+            }
+
+            void Execute() override
+            {
+                m_Value->ModifyValue(m_Modification);
+            }
+
+            void Rollback() override
+            {
+                m_Value->ModifyValue(-m_Modification);
+            }
+        private:
+            std::shared_ptr<WorkingValue> m_Value{};
+            WorkingValue::ValueType m_Modification{};
+        };
+
+        [[nodiscard]] static std::unique_ptr<ReferenceSemantics::LambdaCommand> CreateVirtualLambdaCommand(
+            std::shared_ptr<WorkingValue> value, const int32_t valueModification)
+        {
+            return std::make_unique<ReferenceSemantics::LambdaCommand>(
+                [value, valueModification]
+                {
+                    value->ModifyValue(valueModification);
+                },
+                [value, valueModification]
+                {
+                    value->ModifyValue(-valueModification);
+                });
+        }
+    }
+
+    TEST_CASE("Command Queue - Static Dispatch - Unit Tests")
+    {
+        std::shared_ptr<WorkingValue> value{std::make_shared<WorkingValue>()};
+        TestCommandQueue queue{};
+        REQUIRE(value->GetValue() == 0);
+        REQUIRE_FALSE(queue.HasPendingCommand());
+        REQUIRE_FALSE(queue.HasPendingRollbackCommand());
+        REQUIRE(queue.GetCommandIndex() == 0);
+        REQUIRE(queue.GetCommandQueueSize() == 0);
+
+        SECTION("Add Commands")
+        {
+            queue.QueueCommand(CreateCommand(value, 1));
+            REQUIRE(value->GetValue() == 0);
+            REQUIRE(queue.HasPendingCommand());
+            REQUIRE_FALSE(queue.HasPendingRollbackCommand());
+            REQUIRE(queue.GetCommandIndex() == 0);
+            REQUIRE(queue.GetCommandQueueSize() == 1);
+
+            queue.QueueCommand(CreateLambdaCommand(value, 2));
+            queue.QueueCommand(CreateCommand(value, 3));
+            REQUIRE(value->GetValue() == 0);
+            REQUIRE(queue.HasPendingCommand());
+            REQUIRE_FALSE(queue.HasPendingRollbackCommand());
+            REQUIRE(queue.GetCommandIndex() == 0);
+            REQUIRE(queue.GetCommandQueueSize() == 3);
+        }
+
+        SECTION("Execute Commands")
+        {
+            queue.QueueCommand(CreateLambdaCommand(value, 1));
+            REQUIRE(value->GetValue() == 0);
+            REQUIRE(queue.HasPendingCommand());
+            REQUIRE_FALSE(queue.HasPendingRollbackCommand());
+            REQUIRE(queue.GetCommandIndex() == 0);
+            REQUIRE(queue.GetCommandQueueSize() == 1);
+
+            queue.ExecuteCommand(); // +1
+            REQUIRE(value->GetValue() == 1);
+            REQUIRE_FALSE(queue.HasPendingCommand());
+            REQUIRE(queue.HasPendingRollbackCommand());
+            REQUIRE(queue.GetCommandIndex() == 1);
+            REQUIRE(queue.GetCommandQueueSize() == 1);
+
+            queue.QueueCommand(CreateLambdaCommand(value, 2));
+            queue.QueueCommand(CreateCommand(value, 3));
+            queue.QueueCommand(CreateLambdaCommand(value, 4));
+            REQUIRE(value->GetValue() == 1);
+            REQUIRE(queue.HasPendingCommand());
+            REQUIRE(queue.HasPendingRollbackCommand());
+            REQUIRE(queue.GetCommandIndex() == 1);
+            REQUIRE(queue.GetCommandQueueSize() == 4);
+
+            queue.ExecuteCommand(); // +2
+            queue.ExecuteCommand(); // +3
+            queue.ExecuteCommand(); // +4
+            REQUIRE(value->GetValue() == 10);
+            REQUIRE_FALSE(queue.HasPendingCommand());
+            REQUIRE(queue.HasPendingRollbackCommand());
+            REQUIRE(queue.GetCommandIndex() == 4);
+            REQUIRE(queue.GetCommandQueueSize() == 4);
+        }
+
+        SECTION("Clear Command Queue")
+        {
+            queue.QueueCommand(CreateCommand(value, 1));
+            queue.QueueCommand(CreateLambdaCommand(value, 2));
+            queue.QueueCommand(CreateLambdaCommand(value, 3));
+            REQUIRE(value->GetValue() == 0);
+            REQUIRE(queue.HasPendingCommand());
+            REQUIRE_FALSE(queue.HasPendingRollbackCommand());
+            REQUIRE(queue.GetCommandIndex() == 0);
+            REQUIRE(queue.GetCommandQueueSize() == 3);
+
+            queue.ExecuteCommand(); // +1
+            queue.ExecuteCommand(); // +2
+            queue.ExecuteCommand(); // +3
+            REQUIRE(value->GetValue() == 6);
+            REQUIRE_FALSE(queue.HasPendingCommand());
+            REQUIRE(queue.HasPendingRollbackCommand());
+            REQUIRE(queue.GetCommandIndex() == 3);
+            REQUIRE(queue.GetCommandQueueSize() == 3);
+
+            queue.ClearQueue(); // Remove +1, +2, +3
+            REQUIRE(value->GetValue() == 6);
+            REQUIRE_FALSE(queue.HasPendingCommand());
+            REQUIRE_FALSE(queue.HasPendingRollbackCommand());
+            REQUIRE(queue.GetCommandIndex() == 0);
+            REQUIRE(queue.GetCommandQueueSize() == 0);
+        }
+
+        SECTION("Clear Commands")
+        {
+            queue.QueueCommand(CreateLambdaCommand(value, 1));
+            queue.QueueCommand(CreateCommand(value, 2));
+            queue.QueueCommand(CreateLambdaCommand(value, 3));
+            REQUIRE(value->GetValue() == 0);
+            REQUIRE(queue.HasPendingCommand());
+            REQUIRE_FALSE(queue.HasPendingRollbackCommand());
+            REQUIRE(queue.GetCommandIndex() == 0);
+            REQUIRE(queue.GetCommandQueueSize() == 3);
+
+            queue.ExecuteCommand(); // +1
+            REQUIRE(value->GetValue() == 1);
+            REQUIRE(queue.HasPendingCommand());
+            REQUIRE(queue.HasPendingRollbackCommand());
+            REQUIRE(queue.GetCommandIndex() == 1);
+            REQUIRE(queue.GetCommandQueueSize() == 3);
+
+            queue.ClearPendingCommands(); // Remove +2, +3
+            REQUIRE(value->GetValue() == 1);
+            REQUIRE_FALSE(queue.HasPendingCommand());
+            REQUIRE(queue.HasPendingRollbackCommand());
+            REQUIRE(queue.GetCommandIndex() == 1);
+            REQUIRE(queue.GetCommandQueueSize() == 1);
+
+            queue.QueueCommand(CreateCommand(value, 4));
+            REQUIRE(value->GetValue() == 1);
+            REQUIRE(queue.HasPendingCommand());
+            REQUIRE(queue.HasPendingRollbackCommand());
+            REQUIRE(queue.GetCommandIndex() == 1);
+            REQUIRE(queue.GetCommandQueueSize() == 2);
+
+            queue.ClearPendingCommands(); // Remove +4
+            REQUIRE(value->GetValue() == 1);
+            REQUIRE_FALSE(queue.HasPendingCommand());
+            REQUIRE(queue.HasPendingRollbackCommand());
+            REQUIRE(queue.GetCommandIndex() == 1);
+            REQUIRE(queue.GetCommandQueueSize() == 1);
+
+            queue.QueueCommand(CreateLambdaCommand(value, 5));
+            queue.QueueCommand(CreateLambdaCommand(value, 6));
+            queue.ExecuteCommand(); // +5
+            REQUIRE(value->GetValue() == 6);
+            REQUIRE(queue.HasPendingCommand());
+            REQUIRE(queue.HasPendingRollbackCommand());
+            REQUIRE(queue.GetCommandIndex() == 2);
+            REQUIRE(queue.GetCommandQueueSize() == 3);
+
+            queue.ClearPendingCommands(); // Remove +6
+            REQUIRE(value->GetValue() == 6);
+            REQUIRE_FALSE(queue.HasPendingCommand());
+            REQUIRE(queue.HasPendingRollbackCommand());
+            REQUIRE(queue.GetCommandIndex() == 2);
+            REQUIRE(queue.GetCommandQueueSize() == 2);
+
+            queue.RollbackCommand(); // -5
+            queue.RollbackCommand(); // -1
+            REQUIRE(value->GetValue() == 0);
+            REQUIRE(queue.HasPendingCommand());
+            REQUIRE_FALSE(queue.HasPendingRollbackCommand());
+            REQUIRE(queue.GetCommandIndex() == 0);
+            REQUIRE(queue.GetCommandQueueSize() == 2);
+
+            queue.ClearPendingCommands(); // Remove +1, +5
+            REQUIRE(value->GetValue() == 0);
+            REQUIRE_FALSE(queue.HasPendingCommand());
+            REQUIRE_FALSE(queue.HasPendingRollbackCommand());
+            REQUIRE(queue.GetCommandIndex() == 0);
+            REQUIRE(queue.GetCommandQueueSize() == 0);
+        }
+
+        SECTION("Execute Rollback Commands")
+        {
+            queue.QueueCommand(CreateLambdaCommand(value, 1));
+            REQUIRE(value->GetValue() == 0);
+            REQUIRE(queue.HasPendingCommand());
+            REQUIRE_FALSE(queue.HasPendingRollbackCommand());
+            REQUIRE(queue.GetCommandIndex() == 0);
+            REQUIRE(queue.GetCommandQueueSize() == 1);
+
+            queue.ExecuteCommand(); // +1
+            REQUIRE(value->GetValue() == 1);
+            REQUIRE_FALSE(queue.HasPendingCommand());
+            REQUIRE(queue.HasPendingRollbackCommand());
+            REQUIRE(queue.GetCommandIndex() == 1);
+            REQUIRE(queue.GetCommandQueueSize() == 1);
+
+            queue.RollbackCommand(); // -1
+            REQUIRE(value->GetValue() == 0);
+            REQUIRE(queue.HasPendingCommand());
+            REQUIRE_FALSE(queue.HasPendingRollbackCommand());
+            REQUIRE(queue.GetCommandIndex() == 0);
+            REQUIRE(queue.GetCommandQueueSize() == 1);
+
+            queue.QueueCommand(CreateCommand(value, 2));
+            queue.QueueCommand(CreateLambdaCommand(value, 3));
+            REQUIRE(value->GetValue() == 0);
+            REQUIRE(queue.HasPendingCommand());
+            REQUIRE_FALSE(queue.HasPendingRollbackCommand());
+            REQUIRE(queue.GetCommandIndex() == 0);
+            REQUIRE(queue.GetCommandQueueSize() == 3);
+
+            queue.ExecuteCommand(); // +1
+            queue.ExecuteCommand(); // +2
+            queue.ExecuteCommand(); // +3
+            REQUIRE(value->GetValue() == 6);
+            REQUIRE_FALSE(queue.HasPendingCommand());
+            REQUIRE(queue.HasPendingRollbackCommand());
+            REQUIRE(queue.GetCommandIndex() == 3);
+            REQUIRE(queue.GetCommandQueueSize() == 3);
+
+            queue.RollbackCommand(); // -3
+            REQUIRE(value->GetValue() == 3);
+            REQUIRE(queue.HasPendingCommand());
+            REQUIRE(queue.HasPendingRollbackCommand());
+            REQUIRE(queue.GetCommandIndex() == 2);
+            REQUIRE(queue.GetCommandQueueSize() == 3);
+
+            queue.RollbackCommand(); // -2
+            queue.RollbackCommand(); // -1
+            REQUIRE(value->GetValue() == 0);
+            REQUIRE(queue.HasPendingCommand());
+            REQUIRE_FALSE(queue.HasPendingRollbackCommand());
+            REQUIRE(queue.GetCommandIndex() == 0);
+            REQUIRE(queue.GetCommandQueueSize() == 3);
+        }
+
+        SECTION("Bulk Cursor Commands")
+        {
+            queue.QueueCommand(CreateCommand(value, 1));
+            queue.QueueCommand(CreateCommand(value, 2));
+            queue.QueueCommand(CreateLambdaCommand(value, 3));
+            queue.QueueCommand(CreateLambdaCommand(value, 4));
+            queue.QueueCommand(CreateCommand(value, 5));
+
+            queue.ExecuteN(2); // +1, +2
+            REQUIRE(value->GetValue() == 3);
+            REQUIRE(queue.GetCommandIndex() == 2);
+
+            queue.ExecuteAll(); // +3, +4, +5
+            REQUIRE(value->GetValue() == 15);
+            REQUIRE_FALSE(queue.HasPendingCommand());
+            REQUIRE(queue.GetCommandIndex() == 5);
+
+            queue.RollbackTo(1); // -5, -4, -3, -2
+            REQUIRE(value->GetValue() == 1);
+            REQUIRE(queue.GetCommandIndex() == 1);
+
+            queue.SeekTo(4); // +2, +3, +4
+            REQUIRE(value->GetValue() == 10);
+            REQUIRE(queue.GetCommandIndex() == 4);
+
+            queue.SeekTo(3); // -4
+            REQUIRE(value->GetValue() == 6);
+            REQUIRE(queue.GetCommandIndex() == 3);
+
+            queue.SeekTo(3);
+            REQUIRE(value->GetValue() == 6);
+
+            queue.RollbackTo(0); // -3, -2, -1
+            REQUIRE(value->GetValue() == 0);
+            REQUIRE(queue.GetCommandIndex() == 0);
+            REQUIRE_FALSE(queue.HasPendingRollbackCommand());
+            REQUIRE(queue.GetCommandQueueSize() == 5);
+        }
+    }
+
+    TEST_CASE("Command Queue - Static Dispatch - Creation Benchmark")
+    {
+        BENCHMARK("Benchmark")
+        {
+            constexpr uint32_t creationCount{50'000};
+            std::shared_ptr<WorkingValue> value{std::make_shared<WorkingValue>()};
+            TestCommandQueue queue{};
+
+            for(uint32_t i{0}; i != creationCount; ++i)
+            {
+                queue.QueueCommand(CreateCommand(value, 0));
+                queue.QueueCommand(CreateLambdaCommand(value, 0));
+            }
+
+            while(queue.HasPendingCommand())
+            {
+                queue.ExecuteCommand();
+            }
+
+            while(queue.HasPendingRollbackCommand())
+            {
+                queue.RollbackCommand();
+            }
+        };
+    }
+
+    TEST_CASE("Command Queue - Static Dispatch - Execute/Rollback Benchmark")
+    {
+        constexpr uint32_t creationCount{50'000};
+        std::shared_ptr<WorkingValue> value{std::make_shared<WorkingValue>()};
+        ReferenceSemantics::CommandQueue referenceQueue{};
+        ValueSemantics::CommandQueue valueQueue{};
+        TestCommandQueue staticQueue{};
+
+        for(uint32_t i{0}; i != creationCount; ++i)
+        {
+            referenceQueue.QueueCommand(std::make_unique<VirtualModifyValueCommand>(value, 0));
+            referenceQueue.QueueCommand(CreateVirtualLambdaCommand(value, 0));
+            valueQueue.QueueCommand(CreateCommand(value, 0));
+            valueQueue.QueueCommand(CreateLambdaCommand(value, 0));
+            staticQueue.QueueCommand(CreateCommand(value, 0));
+            staticQueue.QueueCommand(CreateLambdaCommand(value, 0));
+        }
+
+        BENCHMARK("Reference Semantics")
+        {
+            while(referenceQueue.HasPendingCommand())
+            {
+                referenceQueue.ExecuteCommand();
+            }
+
+            while(referenceQueue.HasPendingRollbackCommand())
+            {
+                referenceQueue.RollbackCommand();
+            }
+        };
+
+        BENCHMARK("Value Semantics")
+        {
+            while(valueQueue.HasPendingCommand())
+            {
+                valueQueue.ExecuteCommand();
+            }
+
+            while(valueQueue.HasPendingRollbackCommand())
+            {
+                valueQueue.RollbackCommand();
+            }
+        };
+
+        BENCHMARK("Static Dispatch")
+        {
+            while(staticQueue.HasPendingCommand())
+            {
+                staticQueue.ExecuteCommand();
+            }
+
+            while(staticQueue.HasPendingRollbackCommand())
+            {
+                staticQueue.RollbackCommand();
+            }
+        };
+
+        BENCHMARK("Static Dispatch - Bulk")
+        {
+            staticQueue.ExecuteAll();
+            staticQueue.RollbackTo(0);
+        };
+    }
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <unordered_map>
+#include <utility>
+
+#include "workingvalue.h"
+
+/// Maps WorkingValues to ids which stay the same across sessions, so serialized commands can refer to their target.
+class TargetRegistry
+{
+public:
+    /// Replaces any value already registered with id.
+    void Register(const uint32_t id, std::shared_ptr<WorkingValue> value)
+    {
+        if(const auto itr{m_Values.find(id)}; itr != std::end(m_Values))
+            m_Ids.erase(itr->second.get());
+
+        m_Ids[value.get()] = id;
+        m_Values[id] = std::move(value);
+    }
+
+    [[nodiscard]] std::optional<uint32_t> FindId(const WorkingValue* const value) const
+    {
+        const auto itr{m_Ids.find(value)};
+        if(itr == std::end(m_Ids))
+            return std::nullopt;
+
+        return itr->second;
+    }
+
+    /// Returns nullptr when no value is registered with id.
+    [[nodiscard]] std::shared_ptr<WorkingValue> Find(const uint32_t id) const
+    {
+        const auto itr{m_Values.find(id)};
+        if(itr == std::end(m_Values))
+            return nullptr;
+
+        return itr->second;
+    }
+private:
+    std::unordered_map<uint32_t, std::shared_ptr<WorkingValue>> m_Values{};
+    std::unordered_map<const WorkingValue*, uint32_t> m_Ids{};
+};
@@ -0,0 +1,152 @@
+#include "threadpool.h"
+
+#include <algorithm>
+
+ThreadPool::ThreadPool(const uint32_t threadCount)
+{
+    const uint32_t workerCount{threadCount > 1 ? threadCount - 1 : 0};
+    m_RangeQueues = std::make_unique<RangeQueue[]>(workerCount + 1);
+
+    m_Workers.reserve(workerCount);
+    for(uint32_t i{0}; i != workerCount; ++i)
+    {
+        m_Workers.emplace_back(&ThreadPool::RunWorker, this, i + 1);
+    }
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        const std::scoped_lock lock{m_Mutex};
+        m_Stopping = true;
+    }
+    m_WorkAvailable.notify_all();
+
+    for(std::thread& worker : m_Workers)
+    {
+        worker.join();
+    }
+}
+
+void ThreadPool::ParallelFor(const uint32_t count, const uint32_t grainSize, const RangeFunction& function)
+{
+    const uint32_t rangeSize{std::max(grainSize, 1u)};
+    if(count <= rangeSize || m_Workers.empty())
+    {
+        if(count != 0)
+            function(0, count);
+        return;
+    }
+
+    {
+        const std::scoped_lock lock{m_Mutex};
+        m_Function = &function;
+        m_Count = count;
+        m_GrainSize = rangeSize;
+
+        // Deal contiguous blocks of ranges out to every thread
+        const uint32_t threadCount{GetThreadCount()};
+        const uint32_t rangeCount{(count + rangeSize - 1) / rangeSize};
+        for(uint32_t threadIndex{0}; threadIndex != threadCount; ++threadIndex)
+        {
+            RangeQueue& queue{m_RangeQueues[threadIndex]};
+            const std::scoped_lock queueLock{queue.m_Mutex};
+            queue.m_Front = static_cast<uint32_t>(uint64_t{rangeCount} * threadIndex / threadCount);
+            queue.m_Back = static_cast<uint32_t>(uint64_t{rangeCount} * (threadIndex + 1) / threadCount);
+        }
+
+        m_FinishedWorkerCount = 0;
+        ++m_Generation;
+    }
+    m_WorkAvailable.notify_all();
+
+    RunRanges(0);
+
+    std::unique_lock lock{m_Mutex};
+    m_WorkFinished.wait(lock, [this] { return m_FinishedWorkerCount == m_Workers.size(); });
+    m_Function = nullptr;
+}
+
+uint64_t ThreadPool::GetStealCount() const
+{
+    uint64_t stealCount{0};
+    for(uint32_t threadIndex{0}; threadIndex != GetThreadCount(); ++threadIndex)
+    {
+        RangeQueue& queue{m_RangeQueues[threadIndex]};
+        const std::scoped_lock lock{queue.m_Mutex};
+        stealCount += queue.m_StealCount;
+    }
+    return stealCount;
+}
+
+void ThreadPool::RunWorker(const uint32_t threadIndex)
+{
+    uint64_t generation{0};
+    for(;;)
+    {
+        {
+            std::unique_lock lock{m_Mutex};
+            m_WorkAvailable.wait(lock, [this, generation] { return m_Stopping || m_Generation != generation; });
+            if(m_Stopping)
+                return;
+
+            generation = m_Generation;
+        }
+
+        RunRanges(threadIndex);
+
+        bool finished{false};
+        {
+            const std::scoped_lock lock{m_Mutex};
+            ++m_FinishedWorkerCount;
+            finished = m_FinishedWorkerCount == m_Workers.size();
+        }
+
+        if(finished)
+            m_WorkFinished.notify_one();
+    }
+}
+
+void ThreadPool::RunRanges(const uint32_t threadIndex)
+{
+    // No ranges are added while a job runs, so once every queue is empty the job has been fully claimed
+    uint32_t range{0};
+    while(PopRange(threadIndex, range) || StealRange(threadIndex, range))
+    {
+        const uint32_t begin{range * m_GrainSize};
+        (*m_Function)(begin, std::min(begin + m_GrainSize, m_Count));
+    }
+}
+
+bool ThreadPool::PopRange(const uint32_t threadIndex, uint32_t& range)
+{
+    RangeQueue& queue{m_RangeQueues[threadIndex]};
+    const std::scoped_lock lock{queue.m_Mutex};
+    if(queue.m_Front == queue.m_Back)
+        return false;
+
+    range = --queue.m_Back;
+    return true;
+}
+
+bool ThreadPool::StealRange(const uint32_t threadIndex, uint32_t& range)
+{
+    const uint32_t threadCount{GetThreadCount()};
+    for(uint32_t offset{1}; offset != threadCount; ++offset)
+    {
+        {
+            RangeQueue& victim{m_RangeQueues[(threadIndex + offset) % threadCount]};
+            const std::scoped_lock lock{victim.m_Mutex};
+            if(victim.m_Front == victim.m_Back)
+                continue;
+
+            range = victim.m_Front++;
+        }
+
+        RangeQueue& queue{m_RangeQueues[threadIndex]};
+        const std::scoped_lock lock{queue.m_Mutex};
+        ++queue.m_StealCount;
+        return true;
+    }
+    return false;
+}
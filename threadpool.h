@@ -0,0 +1,66 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/// Fixed set of worker threads which run ParallelFor() jobs together with the calling thread.
+/// Each job is split into ranges dealt out evenly to every thread's own queue. Threads take ranges from the back
+/// of their own queue and, once it is empty, steal from the front of the other queues,
+/// so a few expensive ranges don't leave the other threads idle.
+class ThreadPool
+{
+public:
+    using RangeFunction = std::function<void(uint32_t begin, uint32_t end)>;
+
+    /// threadCount includes the thread calling ParallelFor(), so threadCount - 1 workers are started.
+    explicit ThreadPool(uint32_t threadCount = std::thread::hardware_concurrency());
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    /// Calls function over [0, count) in ranges of at most grainSize and returns once every range has run.
+    /// Runs inline when count fits a single range. function must not throw.
+    /// Only one thread may call ParallelFor() at a time.
+    void ParallelFor(uint32_t count, uint32_t grainSize, const RangeFunction& function);
+
+    [[nodiscard]] uint32_t GetThreadCount() const
+    {
+        return static_cast<uint32_t>(m_Workers.size()) + 1;
+    }
+
+    /// Number of ranges taken from another thread's queue since the pool was created.
+    [[nodiscard]] uint64_t GetStealCount() const;
+
+private:
+    /// The ranges [m_Front, m_Back) still to run by one thread, aligned so threads don't false share.
+    struct alignas(64) RangeQueue
+    {
+        std::mutex m_Mutex{};
+        uint32_t m_Front{0};
+        uint32_t m_Back{0};
+        uint64_t m_StealCount{0};
+    };
+
+    void RunWorker(uint32_t threadIndex);
+    void RunRanges(uint32_t threadIndex);
+    [[nodiscard]] bool PopRange(uint32_t threadIndex, uint32_t& range);
+    [[nodiscard]] bool StealRange(uint32_t threadIndex, uint32_t& range);
+
+    std::vector<std::thread> m_Workers{};
+    std::unique_ptr<RangeQueue[]> m_RangeQueues{};
+    std::mutex m_Mutex{};
+    std::condition_variable m_WorkAvailable{};
+    std::condition_variable m_WorkFinished{};
+    const RangeFunction* m_Function{nullptr};
+    uint32_t m_Count{0};
+    uint32_t m_GrainSize{1};
+    uint32_t m_FinishedWorkerCount{0};
+    uint64_t m_Generation{0};
+    bool m_Stopping{false};
+};
@@ -0,0 +1,160 @@
+#pragma once
+
+#include <bit>
+#include <cstdint>
+#include <optional>
+#include <utility>
+#include <vector>
+
+#include "valuesemantics/commandqueue.h"
+
+namespace ValueSemantics
+{
+    /// Command queue backed by a ring buffer which keeps at most historyCapacity executed commands.
+    /// Once the history exceeds its capacity by evictionBatchSize commands the oldest executed commands
+    /// are destroyed, so memory stays constant while the number of pending commands is bounded.
+    /// GetCommandIndex() and GetCommandQueueSize() are relative to the retained commands,
+    /// add GetEvictedCommandCount() for positions relative to the first command ever queued.
+    class BoundedCommandQueue
+    {
+    public:
+        explicit BoundedCommandQueue(const uint32_t historyCapacity, const uint32_t evictionBatchSize = 1)
+            : m_HistoryCapacity{historyCapacity}
+            , m_EvictionBatchSize{evictionBatchSize == 0 ? 1 : evictionBatchSize}
+        {
+            m_Ring.resize(std::bit_ceil(historyCapacity + m_EvictionBatchSize));
+        }
+
+        /// HasPendingCommand() has to be true before calling
+        void ExecuteCommand()
+        {
+            GetSlot(m_CommandIndex)->Execute();
+            ++m_CommandIndex;
+
+            if(m_CommandIndex >= m_HistoryCapacity + m_EvictionBatchSize)
+                Evict(m_CommandIndex - m_HistoryCapacity);
+        }
+
+        /// HasPendingRollbackCommand() has to be true before calling
+        void RollbackCommand()
+        {
+            --m_CommandIndex;
+            GetSlot(m_CommandIndex)->Rollback();
+        }
+
+        void ClearQueue()
+        {
+            m_EvictedCount += m_Size;
+            for(uint32_t index{0}; index != m_Size; ++index)
+            {
+                GetSlot(index).reset();
+            }
+            m_Head = 0;
+            m_Size = 0;
+            m_CommandIndex = 0;
+        }
+
+        /// Removes any commands ahead of and including the current pending command.
+        /// HasPendingCommand() has to be true before calling
+        void ClearPendingCommands()
+        {
+            for(uint32_t index{m_CommandIndex}; index != m_Size; ++index)
+            {
+                GetSlot(index).reset();
+            }
+            m_Size = m_CommandIndex;
+        }
+
+        [[nodiscard]] bool HasPendingCommand() const
+        {
+            return GetCommandQueueSize() > m_CommandIndex;
+        }
+
+        [[nodiscard]] bool HasPendingRollbackCommand() const
+        {
+            return m_CommandIndex != 0 && GetCommandQueueSize() >= m_CommandIndex;
+        }
+
+        void QueueCommand(Command&& command)
+        {
+            if(m_Size == m_Ring.size())
+                Grow();
+
+            GetSlot(m_Size).emplace(std::move(command));
+            ++m_Size;
+        }
+
+        /// Destroys any executed commands beyond the history capacity.
+        /// Use with a large eviction batch size to move eviction off the hot path, e.g. to the end of a frame.
+        void TrimHistory()
+        {
+            if(m_CommandIndex > m_HistoryCapacity)
+                Evict(m_CommandIndex - m_HistoryCapacity);
+        }
+
+        [[nodiscard]] uint32_t GetCommandIndex() const
+        {
+            return m_CommandIndex;
+        }
+
+        [[nodiscard]] uint32_t GetCommandQueueSize() const
+        {
+            return m_Size;
+        }
+
+        /// Number of commands destroyed since the queue was created, either evicted or cleared.
+        [[nodiscard]] uint64_t GetEvictedCommandCount() const
+        {
+            return m_EvictedCount;
+        }
+
+        [[nodiscard]] uint32_t GetHistoryCapacity() const
+        {
+            return m_HistoryCapacity;
+        }
+
+        /// Number of command slots allocated by the ring buffer.
+        [[nodiscard]] uint32_t GetCapacity() const
+        {
+            return static_cast<uint32_t>(m_Ring.size());
+        }
+
+    private:
+        [[nodiscard]] std::optional<Command>& GetSlot(const uint32_t index)
+        {
+            return m_Ring[(m_Head + index) & (m_Ring.size() - 1)];
+        }
+
+        /// Destroys the count oldest commands, which have to have been executed.
+        void Evict(const uint32_t count)
+        {
+            for(uint32_t index{0}; index != count; ++index)
+            {
+                GetSlot(index).reset();
+            }
+            m_Head = (m_Head + count) & (m_Ring.size() - 1);
+            m_Size -= count;
+            m_CommandIndex -= count;
+            m_EvictedCount += count;
+        }
+
+        void Grow()
+        {
+            std::vector<std::optional<Command>> ring(m_Ring.size() * 2);
+            for(uint32_t index{0}; index != m_Size; ++index)
+            {
+                ring[index] = std::move(GetSlot(index));
+            }
+            m_Ring = std::move(ring);
+            m_Head = 0;
+        }
+
+        std::vector<std::optional<Command>> m_Ring{};
+        uint64_t m_EvictedCount{0};
+        uint32_t m_HistoryCapacity{0};
+        uint32_t m_EvictionBatchSize{1};
+        uint32_t m_Head{0};
+        uint32_t m_Size{0};
+        uint32_t m_CommandIndex{0};
+    };
+}
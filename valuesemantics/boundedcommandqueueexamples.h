@@ -0,0 +1,180 @@
+#pragma once
+
+#include <algorithm>
+
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/benchmark/catch_benchmark.hpp>
+
+#include "valuesemantics/boundedcommandqueue.h"
+#include "valuesemantics/commandqueueexamples.h"
+#include "processmemory.h"
+#include "workingvalue.h"
+
+namespace ValueSemantics
+{
+    TEST_CASE("Bounded Command Queue - Value Semantics - Unit Tests")
+    {
+        std::shared_ptr<WorkingValue> value{std::make_shared<WorkingValue>()};
+        BoundedCommandQueue queue{3};
+        REQUIRE_FALSE(queue.HasPendingCommand());
+        REQUIRE_FALSE(queue.HasPendingRollbackCommand());
+        REQUIRE(queue.GetCommandIndex() == 0);
+        REQUIRE(queue.GetCommandQueueSize() == 0);
+        REQUIRE(queue.GetHistoryCapacity() == 3);
+
+        SECTION("Execute Rollback Commands")
+        {
+            queue.QueueCommand(CreateCommand(value, 1));
+            queue.QueueCommand(CreateLambdaCommand(value, 2));
+            queue.ExecuteCommand(); // +1
+            queue.ExecuteCommand(); // +2
+            REQUIRE(value->GetValue() == 3);
+            REQUIRE(queue.GetCommandIndex() == 2);
+
+            queue.RollbackCommand(); // -2
+            queue.RollbackCommand(); // -1
+            REQUIRE(value->GetValue() == 0);
+            REQUIRE_FALSE(queue.HasPendingRollbackCommand());
+            REQUIRE(queue.GetCommandQueueSize() == 2);
+            REQUIRE(queue.GetEvictedCommandCount() == 0);
+        }
+
+        SECTION("Evict Oldest Commands")
+        {
+            for(int32_t i{1}; i != 6; ++i)
+            {
+                queue.QueueCommand(CreateCommand(value, i));
+            }
+
+            queue.ExecuteCommand(); // +1
+            queue.ExecuteCommand(); // +2
+            queue.ExecuteCommand(); // +3
+            REQUIRE(queue.GetEvictedCommandCount() == 0);
+            REQUIRE(queue.GetCommandIndex() == 3);
+
+            queue.ExecuteCommand(); // +4, evicts +1
+            REQUIRE(value->GetValue() == 10);
+            REQUIRE(queue.GetEvictedCommandCount() == 1);
+            REQUIRE(queue.GetCommandIndex() == 3);
+            REQUIRE(queue.GetCommandQueueSize() == 4);
+            REQUIRE(value.use_count() == 5);
+
+            queue.ExecuteCommand(); // +5, evicts +2
+            REQUIRE(value->GetValue() == 15);
+            REQUIRE(queue.GetEvictedCommandCount() == 2);
+            REQUIRE(queue.GetCommandIndex() == 3);
+            REQUIRE_FALSE(queue.HasPendingCommand());
+
+            queue.RollbackCommand(); // -5
+            queue.RollbackCommand(); // -4
+            queue.RollbackCommand(); // -3
+            REQUIRE(value->GetValue() == 3);
+            REQUIRE_FALSE(queue.HasPendingRollbackCommand());
+            REQUIRE(queue.GetCommandQueueSize() == 3);
+        }
+
+        SECTION("Evict In Batches")
+        {
+            BoundedCommandQueue batchedQueue{4, 4};
+            for(int32_t i{0}; i != 7; ++i)
+            {
+                batchedQueue.QueueCommand(CreateCommand(value, 1));
+                batchedQueue.ExecuteCommand();
+            }
+            REQUIRE(batchedQueue.GetEvictedCommandCount() == 0);
+            REQUIRE(batchedQueue.GetCommandIndex() == 7);
+
+            batchedQueue.QueueCommand(CreateCommand(value, 1));
+            batchedQueue.ExecuteCommand(); // Evicts 4 commands at once
+            REQUIRE(batchedQueue.GetEvictedCommandCount() == 4);
+            REQUIRE(batchedQueue.GetCommandIndex() == 4);
+
+            batchedQueue.QueueCommand(CreateCommand(value, 1));
+            batchedQueue.ExecuteCommand();
+            batchedQueue.TrimHistory(); // Evicts 1 command
+            REQUIRE(batchedQueue.GetEvictedCommandCount() == 5);
+            REQUIRE(batchedQueue.GetCommandIndex() == 4);
+            REQUIRE(value->GetValue() == 9);
+        }
+
+        SECTION("Clear Commands")
+        {
+            for(int32_t i{1}; i != 6; ++i)
+            {
+                queue.QueueCommand(CreateCommand(value, i));
+            }
+            queue.ExecuteCommand(); // +1
+            queue.ExecuteCommand(); // +2
+            queue.ExecuteCommand(); // +3
+            queue.ExecuteCommand(); // +4, evicts +1
+
+            queue.ClearPendingCommands(); // Remove +5
+            REQUIRE_FALSE(queue.HasPendingCommand());
+            REQUIRE(queue.GetCommandQueueSize() == 3);
+
+            queue.ClearQueue(); // Remove +2, +3, +4
+            REQUIRE(value->GetValue() == 10);
+            REQUIRE(queue.GetCommandQueueSize() == 0);
+            REQUIRE(queue.GetCommandIndex() == 0);
+            REQUIRE(queue.GetEvictedCommandCount() == 4);
+            REQUIRE(value.use_count() == 1);
+        }
+
+        SECTION("Constant Capacity")
+        {
+            const uint32_t capacity{queue.GetCapacity()};
+            for(int32_t i{0}; i != 10'000; ++i)
+            {
+                queue.QueueCommand(CreateCommand(value, 1));
+                queue.ExecuteCommand();
+            }
+            REQUIRE(value->GetValue() == 10'000);
+            REQUIRE(queue.GetCapacity() == capacity);
+            REQUIRE(queue.GetEvictedCommandCount() + queue.GetCommandIndex() == 10'000);
+            REQUIRE(value.use_count() == 4);
+
+            for(int32_t i{0}; i != 100; ++i)
+            {
+                queue.QueueCommand(CreateCommand(value, 1));
+            }
+            REQUIRE(queue.GetCommandQueueSize() == 103);
+            REQUIRE(queue.GetCapacity() > capacity);
+
+            while(queue.HasPendingCommand())
+            {
+                queue.ExecuteCommand();
+            }
+            REQUIRE(value->GetValue() == 10'100);
+            REQUIRE(queue.GetCommandIndex() == 3);
+        }
+    }
+
+    TEST_CASE("Bounded Command Queue - Value Semantics - Soak Benchmark", "[.][soak]")
+    {
+        constexpr uint32_t commandCount{10'000'000};
+        constexpr uint32_t historyCapacity{1'000};
+        std::shared_ptr<WorkingValue> value{std::make_shared<WorkingValue>()};
+
+        const std::size_t startResidentSetSize{GetCurrentResidentSetSize()};
+        std::size_t peakResidentSetSize{startResidentSetSize};
+
+        BENCHMARK("Bounded - 10000000")
+        {
+            BoundedCommandQueue queue{historyCapacity, 64};
+
+            for(uint32_t i{0}; i != commandCount; ++i)
+            {
+                queue.QueueCommand(CreateCommand(value, 1));
+                queue.ExecuteCommand();
+
+                if(i % 1'000'000 == 0)
+                    peakResidentSetSize = std::max(peakResidentSetSize, GetCurrentResidentSetSize());
+            }
+
+            return queue.GetCapacity();
+        };
+
+        WARN("Resident set size before: " << startResidentSetSize / 1024 << " KB, "
+            << "peak while soaking: " << peakResidentSetSize / 1024 << " KB");
+    }
+}
@@ -0,0 +1,240 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <utility>
+#include <vector>
+
+#include "valuesemantics/commandqueue.h"
+
+namespace ValueSemantics
+{
+    /// Command queue which snapshots state every checkpointInterval executed commands, so seeking far away
+    /// restores the nearest checkpoint at or before the target and executes forward from there
+    /// instead of rolling back every command in between.
+    /// The snapshot has to capture all state the queued commands modify, and that state may only be modified
+    /// through the queue while checkpoints are kept.
+    /// At most maxCheckpointCount snapshots are kept, once exceeded the interval doubles and every other
+    /// checkpoint is discarded, so checkpoint memory is bounded by maxCheckpointCount * sizeof(TSnapshot)
+    /// plus whatever the snapshots own.
+    template<class TSnapshot>
+    class CheckpointCommandQueue
+    {
+    public:
+        using SnapshotFunction = std::function<TSnapshot()>;
+        using RestoreFunction = std::function<void(const TSnapshot&)>;
+
+        CheckpointCommandQueue(SnapshotFunction&& snapshot, RestoreFunction&& restore,
+            const uint32_t checkpointInterval, const uint32_t maxCheckpointCount)
+            : m_Snapshot{std::move(snapshot)}
+            , m_Restore{std::move(restore)}
+            , m_CheckpointInterval{checkpointInterval == 0 ? 1 : checkpointInterval}
+            , m_MaxCheckpointCount{maxCheckpointCount == 0 ? 1 : maxCheckpointCount}
+        {
+        }
+
+        /// HasPendingCommand() has to be true before calling
+        void ExecuteCommand()
+        {
+            TryTakeCheckpoint();
+            m_CommandQueue[m_CommandIndex].Execute();
+            ++m_CommandIndex;
+        }
+
+        /// HasPendingRollbackCommand() has to be true before calling
+        void RollbackCommand()
+        {
+            --m_CommandIndex;
+            m_CommandQueue[m_CommandIndex].Rollback();
+        }
+
+        /// Executes every pending command.
+        void ExecuteAll()
+        {
+            ExecuteN(GetCommandQueueSize() - m_CommandIndex);
+        }
+
+        /// count has to be no greater than the number of pending commands
+        void ExecuteN(const uint32_t count)
+        {
+            const uint32_t end{m_CommandIndex + count};
+            while(m_CommandIndex != end)
+            {
+                TryTakeCheckpoint();
+
+                const uint32_t nextCheckpointIndex{(m_CommandIndex / m_CheckpointInterval + 1) * m_CheckpointInterval};
+                const uint32_t runEnd{std::min(end, nextCheckpointIndex)};
+                for(; m_CommandIndex != runEnd; ++m_CommandIndex)
+                {
+                    m_CommandQueue[m_CommandIndex].Execute();
+                }
+            }
+        }
+
+        /// Rolls back commands until GetCommandIndex() == index, restoring a checkpoint when executing forward
+        /// from it takes fewer commands than rolling back.
+        /// index has to be no greater than GetCommandIndex()
+        void RollbackTo(const uint32_t index)
+        {
+            if(!m_Checkpoints.empty())
+            {
+                const uint32_t checkpointIndex{GetCheckpointIndexAtOrBefore(index)};
+                if(index - checkpointIndex < m_CommandIndex - index)
+                {
+                    RestoreCheckpoint(checkpointIndex);
+                    ExecuteN(index - checkpointIndex);
+                    return;
+                }
+            }
+
+            for(; m_CommandIndex != index;)
+            {
+                --m_CommandIndex;
+                m_CommandQueue[m_CommandIndex].Rollback();
+            }
+        }
+
+        /// Executes or rolls back commands until GetCommandIndex() == index, skipping ahead through
+        /// a checkpoint past the current command when there is one.
+        /// index has to be no greater than GetCommandQueueSize()
+        void SeekTo(const uint32_t index)
+        {
+            if(index <= m_CommandIndex)
+            {
+                RollbackTo(index);
+                return;
+            }
+
+            if(!m_Checkpoints.empty())
+            {
+                const uint32_t checkpointIndex{GetCheckpointIndexAtOrBefore(index)};
+                if(checkpointIndex > m_CommandIndex)
+                    RestoreCheckpoint(checkpointIndex);
+            }
+            ExecuteN(index - m_CommandIndex);
+        }
+
+        void ClearQueue()
+        {
+            m_CommandQueue.clear();
+            m_Checkpoints.clear();
+            m_CommandIndex = 0;
+        }
+
+        /// Removes any commands ahead of and including the current pending command,
+        /// along with the checkpoints taken after the current command.
+        /// HasPendingCommand() has to be true before calling
+        void ClearPendingCommands()
+        {
+            const auto itr{std::begin(m_CommandQueue) + m_CommandIndex};
+            m_CommandQueue.erase(itr, std::end(m_CommandQueue));
+
+            while(!m_Checkpoints.empty() && GetLastCheckpointIndex() > m_CommandIndex)
+            {
+                m_Checkpoints.pop_back();
+            }
+        }
+
+        [[nodiscard]] bool HasPendingCommand() const
+        {
+            return GetCommandQueueSize() > m_CommandIndex;
+        }
+
+        [[nodiscard]] bool HasPendingRollbackCommand() const
+        {
+            return m_CommandIndex != 0 && GetCommandQueueSize() >= m_CommandIndex;
+        }
+
+        void QueueCommand(Command&& command)
+        {
+            m_CommandQueue.push_back(std::move(command));
+        }
+
+        [[nodiscard]] uint32_t GetCommandIndex() const
+        {
+            return m_CommandIndex;
+        }
+
+        [[nodiscard]] uint32_t GetCommandQueueSize() const
+        {
+            return static_cast<uint32_t>(m_CommandQueue.size());
+        }
+
+        [[nodiscard]] uint32_t GetCheckpointCount() const
+        {
+            return static_cast<uint32_t>(m_Checkpoints.size());
+        }
+
+        /// Number of commands between checkpoints, doubles each time the checkpoints are thinned.
+        [[nodiscard]] uint32_t GetCheckpointInterval() const
+        {
+            return m_CheckpointInterval;
+        }
+
+        /// Number of times a checkpoint has been restored.
+        [[nodiscard]] uint64_t GetRestoreCount() const
+        {
+            return m_RestoreCount;
+        }
+
+    private:
+        // Checkpoints are always taken at every multiple of the interval from 0 up to the last checkpoint,
+        // so m_Checkpoints[i] holds the state at command index i * m_CheckpointInterval.
+
+        [[nodiscard]] uint32_t GetLastCheckpointIndex() const
+        {
+            return static_cast<uint32_t>(m_Checkpoints.size() - 1) * m_CheckpointInterval;
+        }
+
+        /// m_Checkpoints must not be empty
+        [[nodiscard]] uint32_t GetCheckpointIndexAtOrBefore(const uint32_t index) const
+        {
+            return std::min(index / m_CheckpointInterval * m_CheckpointInterval, GetLastCheckpointIndex());
+        }
+
+        void TryTakeCheckpoint()
+        {
+            if(m_CommandIndex % m_CheckpointInterval != 0)
+                return;
+
+            if(!m_Checkpoints.empty() && m_CommandIndex <= GetLastCheckpointIndex())
+                return;
+
+            m_Checkpoints.push_back(m_Snapshot());
+
+            while(m_Checkpoints.size() > m_MaxCheckpointCount)
+            {
+                ThinCheckpoints();
+            }
+        }
+
+        /// Doubles the checkpoint interval, keeping every other checkpoint.
+        void ThinCheckpoints()
+        {
+            const std::size_t keptCount{(m_Checkpoints.size() + 1) / 2};
+            for(std::size_t kept{1}; kept != keptCount; ++kept)
+            {
+                m_Checkpoints[kept] = std::move(m_Checkpoints[kept * 2]);
+            }
+            m_Checkpoints.erase(std::begin(m_Checkpoints) + keptCount, std::end(m_Checkpoints));
+            m_CheckpointInterval *= 2;
+        }
+
+        void RestoreCheckpoint(const uint32_t checkpointIndex)
+        {
+            m_Restore(m_Checkpoints[checkpointIndex / m_CheckpointInterval]);
+            m_CommandIndex = checkpointIndex;
+            ++m_RestoreCount;
+        }
+
+        SnapshotFunction m_Snapshot{};
+        RestoreFunction m_Restore{};
+        std::vector<Command> m_CommandQueue{};
+        std::vector<TSnapshot> m_Checkpoints{};
+        uint64_t m_RestoreCount{0};
+        uint32_t m_CheckpointInterval{1};
+        uint32_t m_MaxCheckpointCount{1};
+        uint32_t m_CommandIndex{0};
+    };
+}
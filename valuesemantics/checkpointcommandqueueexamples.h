@@ -0,0 +1,170 @@
+#pragma once
+
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/benchmark/catch_benchmark.hpp>
+
+#include "valuesemantics/checkpointcommandqueue.h"
+#include "valuesemantics/commandqueueexamples.h"
+#include "workingvalue.h"
+
+namespace ValueSemantics
+{
+    namespace
+    {
+        using ValueCheckpointCommandQueue = CheckpointCommandQueue<WorkingValue::ValueType>;
+
+        [[nodiscard]] static ValueCheckpointCommandQueue CreateCheckpointCommandQueue(
+            std::shared_ptr<WorkingValue> value, const uint32_t checkpointInterval, const uint32_t maxCheckpointCount)
+        {
+            return ValueCheckpointCommandQueue{
+                [value]
+                {
+                    return value->GetValue();
+                },
+                [value](const WorkingValue::ValueType snapshot)
+                {
+                    value->SetValue(snapshot);
+                },
+                checkpointInterval,
+                maxCheckpointCount};
+        }
+    }
+
+    TEST_CASE("Checkpoint Command Queue - Value Semantics - Unit Tests")
+    {
+        std::shared_ptr<WorkingValue> value{std::make_shared<WorkingValue>()};
+        ValueCheckpointCommandQueue queue{CreateCheckpointCommandQueue(value, 4, 8)};
+        REQUIRE_FALSE(queue.HasPendingCommand());
+        REQUIRE_FALSE(queue.HasPendingRollbackCommand());
+        REQUIRE(queue.GetCheckpointCount() == 0);
+        REQUIRE(queue.GetCheckpointInterval() == 4);
+
+        for(int32_t i{1}; i != 21; ++i)
+        {
+            queue.QueueCommand(CreateCommand(value, i));
+        }
+
+        SECTION("Take Checkpoints")
+        {
+            queue.ExecuteCommand(); // +1
+            REQUIRE(queue.GetCheckpointCount() == 1);
+
+            queue.ExecuteN(9); // +2 ... +10
+            REQUIRE(value->GetValue() == 55);
+            REQUIRE(queue.GetCheckpointCount() == 3); // 0, 4, 8
+
+            queue.RollbackCommand(); // -10
+            queue.ExecuteCommand(); // +10
+            REQUIRE(queue.GetCheckpointCount() == 3);
+            REQUIRE(queue.GetRestoreCount() == 0);
+        }
+
+        SECTION("Rollback Through Checkpoint")
+        {
+            queue.ExecuteAll(); // +1 ... +20
+            REQUIRE(value->GetValue() == 210);
+            REQUIRE(queue.GetCheckpointCount() == 5); // 0, 4, 8, 12, 16
+
+            queue.RollbackTo(19); // -20
+            REQUIRE(value->GetValue() == 190);
+            REQUIRE(queue.GetRestoreCount() == 0);
+
+            queue.RollbackTo(5); // Restore 4, +5
+            REQUIRE(value->GetValue() == 15);
+            REQUIRE(queue.GetCommandIndex() == 5);
+            REQUIRE(queue.GetRestoreCount() == 1);
+
+            queue.SeekTo(18); // Restore 16, +17, +18
+            REQUIRE(value->GetValue() == 171);
+            REQUIRE(queue.GetCommandIndex() == 18);
+            REQUIRE(queue.GetRestoreCount() == 2);
+
+            queue.SeekTo(0); // Restore 0
+            REQUIRE(value->GetValue() == 0);
+            REQUIRE_FALSE(queue.HasPendingRollbackCommand());
+            REQUIRE(queue.GetRestoreCount() == 3);
+        }
+
+        SECTION("Thin Checkpoints")
+        {
+            ValueCheckpointCommandQueue thinQueue{CreateCheckpointCommandQueue(value, 1, 4)};
+            for(int32_t i{1}; i != 21; ++i)
+            {
+                thinQueue.QueueCommand(CreateCommand(value, i));
+            }
+
+            thinQueue.ExecuteAll();
+            REQUIRE(value->GetValue() == 210);
+            REQUIRE(thinQueue.GetCheckpointCount() <= 4);
+            REQUIRE(thinQueue.GetCheckpointInterval() == 8); // 0, 8, 16
+
+            thinQueue.RollbackTo(9); // Restore 8, +9
+            REQUIRE(value->GetValue() == 45);
+            REQUIRE(thinQueue.GetRestoreCount() == 1);
+
+            for(uint32_t index{0}; index != 21; ++index)
+            {
+                thinQueue.SeekTo(index);
+                REQUIRE(value->GetValue() == static_cast<int32_t>(index * (index + 1) / 2));
+            }
+        }
+
+        SECTION("Clear Commands")
+        {
+            queue.ExecuteAll();
+            queue.RollbackTo(6); // Restore 4, +5, +6
+            REQUIRE(value->GetValue() == 21);
+
+            queue.ClearPendingCommands(); // Remove +7 ... +20 and checkpoints 8, 12, 16
+            REQUIRE(queue.GetCommandQueueSize() == 6);
+            REQUIRE(queue.GetCheckpointCount() == 2);
+
+            queue.QueueCommand(CreateCommand(value, 100));
+            queue.QueueCommand(CreateCommand(value, 100));
+            queue.ExecuteAll(); // +100, +100
+            REQUIRE(value->GetValue() == 221);
+            REQUIRE(queue.GetCheckpointCount() == 2);
+
+            queue.RollbackTo(4); // Restore 4
+            REQUIRE(value->GetValue() == 10);
+
+            queue.ClearQueue();
+            REQUIRE(queue.GetCheckpointCount() == 0);
+            REQUIRE(queue.GetCommandQueueSize() == 0);
+            REQUIRE(queue.GetCommandIndex() == 0);
+        }
+    }
+
+    TEST_CASE("Checkpoint Command Queue - Value Semantics - Seek Benchmark")
+    {
+        constexpr uint32_t commandCount{1'000'000};
+        std::shared_ptr<WorkingValue> value{std::make_shared<WorkingValue>()};
+        CommandQueue queue{};
+        ValueCheckpointCommandQueue checkpointQueue{CreateCheckpointCommandQueue(value, 1'024, 1'024)};
+
+        for(uint32_t i{0}; i != commandCount; ++i)
+        {
+            queue.QueueCommand(CreateCommand(value, 1));
+            checkpointQueue.QueueCommand(CreateCommand(value, 1));
+        }
+        queue.ExecuteAll();
+        checkpointQueue.ExecuteAll();
+
+        for(const uint32_t distance : {1'000u, 10'000u, 100'000u, 500'000u})
+        {
+            BENCHMARK("Rollback - " + std::to_string(distance))
+            {
+                queue.SeekTo(commandCount - distance);
+                queue.SeekTo(commandCount);
+            };
+
+            BENCHMARK("Checkpoint - " + std::to_string(distance))
+            {
+                checkpointQueue.SeekTo(commandCount - distance);
+                checkpointQueue.SeekTo(commandCount);
+            };
+        }
+
+        REQUIRE(value->GetValue() == 2 * static_cast<int32_t>(commandCount));
+    }
+}
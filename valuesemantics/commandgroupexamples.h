@@ -0,0 +1,229 @@
+#pragma once
+
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/benchmark/catch_benchmark.hpp>
+
+#include "valuesemantics/commandqueueexamples.h"
+#include "workingvalue.h"
+
+namespace ValueSemantics
+{
+    TEST_CASE("Command Groups - Value Semantics - Unit Tests")
+    {
+        std::shared_ptr<WorkingValue> value{std::make_shared<WorkingValue>()};
+        CommandQueue queue{};
+        REQUIRE_FALSE(queue.IsGroupOpen());
+
+        queue.QueueCommand(CreateCommand(value, 1));
+        queue.BeginGroup();
+        queue.QueueCommand(CreateCommand(value, 2));
+        queue.QueueCommand(CreateLambdaCommand(value, 4));
+        REQUIRE(queue.IsGroupOpen());
+        REQUIRE(queue.GetCommandQueueSize() == 1); // The open group isn't a step yet
+        queue.EndGroup();
+        queue.QueueCommand(CreateCommand(value, 8));
+        REQUIRE_FALSE(queue.IsGroupOpen());
+        REQUIRE(queue.GetCommandQueueSize() == 3);
+        REQUIRE(queue.GetStoredCommandCount() == 4);
+
+        SECTION("Execute And Rollback As One Step")
+        {
+            queue.ExecuteCommand(); // +1
+            queue.ExecuteCommand(); // +2, +4
+            REQUIRE(value->GetValue() == 7);
+            REQUIRE(queue.GetCommandIndex() == 2);
+
+            queue.RollbackCommand(); // -4, -2
+            REQUIRE(value->GetValue() == 1);
+
+            queue.ExecuteAll(); // +2, +4, +8
+            REQUIRE(value->GetValue() == 15);
+            queue.SeekTo(1); // -8, -4, -2
+            REQUIRE(value->GetValue() == 1);
+            queue.RollbackTo(0); // -1
+            REQUIRE(value->GetValue() == 0);
+        }
+
+        SECTION("Rollback Order Within Group")
+        {
+            std::vector<int32_t> order{};
+            queue.ClearQueue();
+            queue.BeginGroup();
+            for(int32_t i{0}; i != 3; ++i)
+            {
+                queue.QueueCommand(LambdaCommand{
+                    [&order, i]
+                    {
+                        order.push_back(i);
+                    },
+                    [&order, i]
+                    {
+                        order.push_back(-i);
+                    }});
+            }
+            queue.EndGroup();
+
+            queue.ExecuteCommand();
+            queue.RollbackCommand();
+            REQUIRE(order == std::vector<int32_t>{0, 1, 2, -2, -1, 0});
+        }
+
+        SECTION("Nested Groups")
+        {
+            queue.BeginGroup();
+            queue.QueueCommand(CreateCommand(value, 16));
+            queue.BeginGroup();
+            queue.QueueCommand(CreateCommand(value, 32));
+            queue.EndGroup(); // Still inside the outer group
+            REQUIRE(queue.IsGroupOpen());
+            REQUIRE(queue.GetCommandQueueSize() == 3);
+            queue.EndGroup();
+            REQUIRE(queue.GetCommandQueueSize() == 4);
+
+            queue.ExecuteAll();
+            REQUIRE(value->GetValue() == 63);
+            queue.RollbackCommand(); // -32, -16
+            REQUIRE(value->GetValue() == 15);
+        }
+
+        SECTION("Empty Group")
+        {
+            queue.BeginGroup();
+            queue.EndGroup();
+            REQUIRE(queue.GetCommandQueueSize() == 3);
+            REQUIRE(queue.GetStoredCommandCount() == 4);
+        }
+
+        SECTION("Open Group Isn't Executed")
+        {
+            queue.BeginGroup();
+            queue.QueueCommand(CreateCommand(value, 16));
+            REQUIRE(queue.GetStoredCommandCount() == 5);
+
+            queue.ExecuteAll();
+            REQUIRE(value->GetValue() == 15);
+            REQUIRE_FALSE(queue.HasPendingCommand());
+
+            queue.EndGroup();
+            REQUIRE(queue.HasPendingCommand());
+            queue.ExecuteCommand(); // +16
+            REQUIRE(value->GetValue() == 31);
+        }
+
+        SECTION("Clear Pending Group")
+        {
+            queue.ExecuteCommand(); // +1
+            queue.ClearPendingCommands();
+            REQUIRE(queue.GetCommandQueueSize() == 1);
+            REQUIRE(queue.GetStoredCommandCount() == 1);
+            REQUIRE(value.use_count() == 2);
+
+            queue.QueueCommand(CreateCommand(value, 16));
+            queue.ExecuteAll();
+            REQUIRE(value->GetValue() == 17);
+        }
+
+        SECTION("Clear Pending Commands Discards Open Group")
+        {
+            queue.ExecuteCommand(); // +1
+            queue.BeginGroup();
+            queue.BeginGroup();
+            queue.QueueCommand(CreateCommand(value, 16));
+            queue.ClearPendingCommands();
+            REQUIRE_FALSE(queue.IsGroupOpen());
+            REQUIRE(queue.GetCommandQueueSize() == 1);
+            REQUIRE(queue.GetStoredCommandCount() == 1);
+
+            queue.QueueCommand(CreateCommand(value, 32)); // A step of its own
+            REQUIRE(queue.GetCommandQueueSize() == 2);
+            queue.ExecuteAll();
+            REQUIRE(value->GetValue() == 33);
+        }
+
+        SECTION("No Coalescing Into Groups")
+        {
+            queue.ClearQueue();
+            queue.SetCoalescePolicy(CoalescePolicy::PendingOnly);
+            queue.BeginGroup();
+            queue.QueueCommand(CreateCommand(value, 1));
+            queue.QueueCommand(CreateCommand(value, 2));
+            queue.EndGroup();
+            queue.QueueCommand(CreateCommand(value, 4)); // Not merged into the group
+            REQUIRE(queue.GetCommandQueueSize() == 2);
+            REQUIRE(queue.GetStoredCommandCount() == 3);
+
+            queue.QueueCommand(CreateCommand(value, 8)); // Merged into +4
+            REQUIRE(queue.GetCommandQueueSize() == 2);
+            REQUIRE(queue.GetStoredCommandCount() == 3);
+
+            queue.ExecuteAll();
+            REQUIRE(value->GetValue() == 15);
+            queue.RollbackCommand(); // -12
+            REQUIRE(value->GetValue() == 3);
+        }
+
+        queue.ClearQueue();
+        REQUIRE(value.use_count() == 1);
+    }
+
+    TEST_CASE("Command Groups - Value Semantics - Benchmark")
+    {
+        constexpr uint32_t childCount{10'000};
+        std::shared_ptr<WorkingValue> value{std::make_shared<WorkingValue>()};
+
+        CommandQueue groupQueue{};
+        groupQueue.BeginGroup();
+        for(uint32_t i{0}; i != childCount; ++i)
+        {
+            groupQueue.QueueCommand(CreateCommand(value, 1));
+        }
+        groupQueue.EndGroup();
+
+        CommandQueue separateQueue{};
+        for(uint32_t i{0}; i != childCount; ++i)
+        {
+            separateQueue.QueueCommand(CreateCommand(value, 1));
+        }
+
+        // The alternative to groups, a command owning its children on a heap allocation of its own
+        std::shared_ptr<std::vector<Command>> children{std::make_shared<std::vector<Command>>()};
+        for(uint32_t i{0}; i != childCount; ++i)
+        {
+            children->push_back(CreateCommand(value, 1));
+        }
+        CommandQueue nestedQueue{};
+        nestedQueue.QueueCommand(LambdaCommand{
+            [children]
+            {
+                for(Command& child : *children)
+                {
+                    child.Execute();
+                }
+            },
+            [children]
+            {
+                for(auto itr{children->rbegin()}; itr != children->rend(); ++itr)
+                {
+                    itr->Rollback();
+                }
+            }});
+
+        BENCHMARK("Group")
+        {
+            groupQueue.ExecuteCommand();
+            groupQueue.RollbackCommand();
+        };
+
+        BENCHMARK("Separate Commands")
+        {
+            separateQueue.ExecuteAll();
+            separateQueue.RollbackTo(0);
+        };
+
+        BENCHMARK("Nested Command Vector")
+        {
+            nestedQueue.ExecuteCommand();
+            nestedQueue.RollbackCommand();
+        };
+    }
+}
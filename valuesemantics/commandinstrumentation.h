@@ -0,0 +1,239 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstdint>
+#include <span>
+#include <typeinfo>
+#include <vector>
+
+#include "cyclecounter.h"
+
+namespace ValueSemantics
+{
+    /// Instrumentation policy of BasicCommandQueue which records nothing, every call inlines to the bare command call.
+    class NullInstrumentation
+    {
+    public:
+        template<class TCommand>
+        void Execute(TCommand& command)
+        {
+            command.Execute();
+        }
+
+        template<class TCommand>
+        void Rollback(TCommand& command)
+        {
+            command.Rollback();
+        }
+
+        template<class TCommand>
+        void ExecuteRange(const std::span<TCommand> commands)
+        {
+            for(TCommand& command : commands)
+            {
+                command.Execute();
+            }
+        }
+
+        /// Rolls back commands from last to first.
+        template<class TCommand>
+        void RollbackRange(const std::span<TCommand> commands)
+        {
+            for(auto itr{commands.rbegin()}; itr != commands.rend(); ++itr)
+            {
+                itr->Rollback();
+            }
+        }
+
+        void RecordQueueDepth(uint32_t, uint32_t)
+        {
+        }
+    };
+
+    /// Log2 histogram of cycle counts, bucket i counts samples below 2^i cycles and at least 2^(i - 1).
+    /// The last bucket also counts every longer sample.
+    class CycleHistogram
+    {
+    public:
+        static constexpr uint32_t BucketCount{32};
+
+        void Record(const uint64_t cycles)
+        {
+            ++m_Buckets[std::min(static_cast<uint32_t>(std::bit_width(cycles)), BucketCount - 1)];
+            ++m_Count;
+            m_TotalCycles += cycles;
+        }
+
+        /// Upper bound in cycles of the bucket reaching fraction of the samples, e.g. 0.99 for the 99th percentile.
+        [[nodiscard]] uint64_t GetPercentileUpperBound(const double fraction) const
+        {
+            const uint64_t target{static_cast<uint64_t>(static_cast<double>(m_Count) * fraction)};
+            uint64_t count{0};
+            for(uint32_t bucket{0}; bucket != BucketCount; ++bucket)
+            {
+                count += m_Buckets[bucket];
+                if(count != 0 && count >= target)
+                    return uint64_t{1} << bucket;
+            }
+            return uint64_t{1} << (BucketCount - 1);
+        }
+
+        [[nodiscard]] const std::array<uint64_t, BucketCount>& GetBuckets() const
+        {
+            return m_Buckets;
+        }
+
+        [[nodiscard]] uint64_t GetCount() const
+        {
+            return m_Count;
+        }
+
+        [[nodiscard]] uint64_t GetTotalCycles() const
+        {
+            return m_TotalCycles;
+        }
+    private:
+        std::array<uint64_t, BucketCount> m_Buckets{};
+        uint64_t m_Count{0};
+        uint64_t m_TotalCycles{0};
+    };
+
+    /// Execute and rollback timings of every command of one type, in cycles of ReadCycleCounter().
+    struct CommandTypeStatistics
+    {
+        const std::type_info* m_Type{nullptr};
+        CycleHistogram m_Execute{};
+        CycleHistogram m_Rollback{};
+    };
+
+    /// Instrumentation policy of BasicCommandQueue which times every command executed or rolled back,
+    /// grouped by command type, and tracks the queue's high-water marks.
+    /// Commands run through a ParallelCommandExecutor aren't timed.
+    class StatisticsInstrumentation
+    {
+    public:
+        template<class TCommand>
+        void Execute(TCommand& command)
+        {
+            CommandTypeStatistics& statistics{FindStatistics(command.GetType())};
+            const uint64_t start{ReadCycleCounter()};
+            command.Execute();
+            statistics.m_Execute.Record(ReadCycleCounter() - start);
+        }
+
+        template<class TCommand>
+        void Rollback(TCommand& command)
+        {
+            CommandTypeStatistics& statistics{FindStatistics(command.GetType())};
+            const uint64_t start{ReadCycleCounter()};
+            command.Rollback();
+            statistics.m_Rollback.Record(ReadCycleCounter() - start);
+        }
+
+        /// Each cycle counter read ends one command's time and starts the next, halving the reads of timing
+        /// commands one by one. A command's time then includes the bookkeeping done before running it.
+        template<class TCommand>
+        void ExecuteRange(const std::span<TCommand> commands)
+        {
+            uint64_t start{ReadCycleCounter()};
+            for(TCommand& command : commands)
+            {
+                CommandTypeStatistics& statistics{FindStatistics(command.GetType())};
+                command.Execute();
+                const uint64_t end{ReadCycleCounter()};
+                statistics.m_Execute.Record(end - start);
+                start = end;
+            }
+        }
+
+        /// Rolls back commands from last to first, timed as ExecuteRange().
+        template<class TCommand>
+        void RollbackRange(const std::span<TCommand> commands)
+        {
+            uint64_t start{ReadCycleCounter()};
+            for(auto itr{commands.rbegin()}; itr != commands.rend(); ++itr)
+            {
+                CommandTypeStatistics& statistics{FindStatistics(itr->GetType())};
+                itr->Rollback();
+                const uint64_t end{ReadCycleCounter()};
+                statistics.m_Rollback.Record(end - start);
+                start = end;
+            }
+        }
+
+        void RecordQueueDepth(const uint32_t queueSize, const uint32_t pendingCount)
+        {
+            m_QueueSizeHighWaterMark = std::max(m_QueueSizeHighWaterMark, queueSize);
+            m_PendingHighWaterMark = std::max(m_PendingHighWaterMark, pendingCount);
+        }
+
+        /// One entry per command type, in the order the types first ran.
+        [[nodiscard]] const std::vector<CommandTypeStatistics>& GetTypeStatistics() const
+        {
+            return m_TypeStatistics;
+        }
+
+        /// Returns nullptr when no TCommand has been executed or rolled back.
+        template<class TCommand>
+        [[nodiscard]] const CommandTypeStatistics* FindTypeStatistics() const
+        {
+            const auto found{std::find_if(m_TypeStatistics.begin(), m_TypeStatistics.end(),
+                [](const CommandTypeStatistics& statistics)
+                {
+                    return *statistics.m_Type == typeid(TCommand);
+                })};
+            return found != m_TypeStatistics.end() ? &*found : nullptr;
+        }
+
+        [[nodiscard]] uint32_t GetQueueSizeHighWaterMark() const
+        {
+            return m_QueueSizeHighWaterMark;
+        }
+
+        [[nodiscard]] uint32_t GetPendingHighWaterMark() const
+        {
+            return m_PendingHighWaterMark;
+        }
+
+        void Reset()
+        {
+            m_TypeStatistics.clear();
+            m_LastIndex = 0;
+            m_QueueSizeHighWaterMark = 0;
+            m_PendingHighWaterMark = 0;
+        }
+    private:
+        /// Queues rarely hold more than a handful of command types, so a linear search starting at the last type
+        /// found beats hashing, runs of one type skip the search entirely.
+        [[nodiscard]] CommandTypeStatistics& FindStatistics(const std::type_info& type)
+        {
+            if(m_LastIndex < m_TypeStatistics.size() && *m_TypeStatistics[m_LastIndex].m_Type == type)
+                return m_TypeStatistics[m_LastIndex];
+
+            for(std::size_t index{0}; index != m_TypeStatistics.size(); ++index)
+            {
+                if(*m_TypeStatistics[index].m_Type == type)
+                {
+                    m_LastIndex = index;
+                    return m_TypeStatistics[index];
+                }
+            }
+
+            m_LastIndex = m_TypeStatistics.size();
+            return m_TypeStatistics.emplace_back(CommandTypeStatistics{&type});
+        }
+
+        std::vector<CommandTypeStatistics> m_TypeStatistics{};
+        std::size_t m_LastIndex{0};
+        uint32_t m_QueueSizeHighWaterMark{0};
+        uint32_t m_PendingHighWaterMark{0};
+    };
+
+#ifdef COMMAND_PATTERN_INSTRUMENTATION
+    using DefaultInstrumentation = StatisticsInstrumentation;
+#else
+    using DefaultInstrumentation = NullInstrumentation;
+#endif
+}
@@ -0,0 +1,118 @@
+#pragma once
+
+#include <numeric>
+
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/benchmark/catch_benchmark.hpp>
+
+#include "valuesemantics/commandinstrumentation.h"
+#include "valuesemantics/commandqueue.h"
+#include "valuesemantics/commandqueueexamples.h"
+#include "workingvalue.h"
+
+namespace ValueSemantics
+{
+    TEST_CASE("Command Instrumentation - Value Semantics - Unit Tests")
+    {
+        using InstrumentedCommandQueue = BasicCommandQueue<StatisticsInstrumentation>;
+        static_assert(sizeof(BasicCommandQueue<NullInstrumentation>) == sizeof(std::vector<Command>) + sizeof(std::vector<uint32_t>) + 4 * sizeof(uint32_t));
+
+        std::shared_ptr<WorkingValue> value{std::make_shared<WorkingValue>()};
+        InstrumentedCommandQueue queue{};
+        const StatisticsInstrumentation& statistics{queue.GetInstrumentation()};
+        REQUIRE(statistics.GetTypeStatistics().empty());
+        REQUIRE(statistics.GetQueueSizeHighWaterMark() == 0);
+        REQUIRE(statistics.GetPendingHighWaterMark() == 0);
+
+        queue.QueueCommand(CreateCommand(value, 1));
+        queue.QueueCommand(CreateCommand(value, 2));
+        queue.QueueCommand(CreateLambdaCommand(value, 4));
+        queue.QueueCommand(CreateCommand(value, 8));
+        REQUIRE(statistics.GetQueueSizeHighWaterMark() == 4);
+        REQUIRE(statistics.GetPendingHighWaterMark() == 4);
+
+        SECTION("Count Per Command Type")
+        {
+            queue.ExecuteCommand(); // +1
+            queue.ExecuteAll(); // +2, +4, +8
+            queue.RollbackCommand(); // -8
+            queue.RollbackTo(1); // -4, -2
+            REQUIRE(value->GetValue() == 1);
+
+            REQUIRE(statistics.GetTypeStatistics().size() == 2);
+            const CommandTypeStatistics* const modifyStatistics{statistics.FindTypeStatistics<ModifyValueCommand>()};
+            const CommandTypeStatistics* const lambdaStatistics{statistics.FindTypeStatistics<LambdaCommand>()};
+            REQUIRE(modifyStatistics);
+            REQUIRE(lambdaStatistics);
+            REQUIRE(statistics.FindTypeStatistics<WorkingValue>() == nullptr);
+
+            REQUIRE(modifyStatistics->m_Execute.GetCount() == 3);
+            REQUIRE(modifyStatistics->m_Rollback.GetCount() == 2);
+            REQUIRE(lambdaStatistics->m_Execute.GetCount() == 1);
+            REQUIRE(lambdaStatistics->m_Rollback.GetCount() == 1);
+
+            const auto& buckets{modifyStatistics->m_Execute.GetBuckets()};
+            REQUIRE(std::accumulate(buckets.begin(), buckets.end(), uint64_t{0}) == 3);
+            REQUIRE(modifyStatistics->m_Execute.GetPercentileUpperBound(1.0) > 0);
+            REQUIRE(modifyStatistics->m_Execute.GetPercentileUpperBound(0.5)
+                <= modifyStatistics->m_Execute.GetPercentileUpperBound(1.0));
+        }
+
+        SECTION("Track High-Water Marks")
+        {
+            queue.ExecuteAll();
+            queue.QueueCommand(CreateCommand(value, 16));
+            REQUIRE(statistics.GetQueueSizeHighWaterMark() == 5);
+            REQUIRE(statistics.GetPendingHighWaterMark() == 4);
+
+            queue.ClearQueue();
+            queue.QueueCommand(CreateCommand(value, 32));
+            REQUIRE(statistics.GetQueueSizeHighWaterMark() == 5);
+
+            queue.GetInstrumentation().Reset();
+            REQUIRE(statistics.GetTypeStatistics().empty());
+            REQUIRE(statistics.GetQueueSizeHighWaterMark() == 0);
+
+            queue.QueueCommand(CreateCommand(value, 64));
+            REQUIRE(statistics.GetQueueSizeHighWaterMark() == 2);
+            REQUIRE(statistics.GetPendingHighWaterMark() == 2);
+        }
+
+        SECTION("Count Coalesced Commands")
+        {
+            queue.ExecuteAll();
+            queue.SetCoalescePolicy(CoalescePolicy::AcrossCursor);
+            queue.QueueCommand(CreateCommand(value, 16)); // Merged into the executed +8 and executed
+            REQUIRE(value->GetValue() == 31);
+            REQUIRE(statistics.FindTypeStatistics<ModifyValueCommand>()->m_Execute.GetCount() == 4);
+        }
+    }
+
+    TEST_CASE("Command Instrumentation - Value Semantics - Overhead Benchmark")
+    {
+        constexpr uint32_t commandCount{100'000};
+        std::shared_ptr<WorkingValue> value{std::make_shared<WorkingValue>()};
+
+        BasicCommandQueue<NullInstrumentation> queue{};
+        BasicCommandQueue<StatisticsInstrumentation> instrumentedQueue{};
+        for(uint32_t i{0}; i != commandCount; ++i)
+        {
+            queue.QueueCommand(i % 4 == 0 ? Command{CreateLambdaCommand(value, 1)} : Command{CreateCommand(value, 1)});
+            instrumentedQueue.QueueCommand(i % 4 == 0 ? Command{CreateLambdaCommand(value, 1)} : Command{CreateCommand(value, 1)});
+        }
+
+        BENCHMARK("Null Instrumentation - Execute/Rollback")
+        {
+            queue.ExecuteAll();
+            queue.RollbackTo(0);
+        };
+
+        BENCHMARK("Statistics Instrumentation - Execute/Rollback")
+        {
+            instrumentedQueue.ExecuteAll();
+            instrumentedQueue.RollbackTo(0);
+        };
+
+        REQUIRE(instrumentedQueue.GetInstrumentation().GetTypeStatistics().size() == 2);
+    }
+}
@@ -0,0 +1,211 @@
+#include "valuesemantics/commandjournal.h"
+#include "valuesemantics/commands.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace ValueSemantics
+{
+    namespace
+    {
+        constexpr uint64_t JournalMagic{0x4C4E524A444D4331}; // "1CMDJRNL"
+        constexpr uint32_t JournalVersion{1};
+        constexpr std::size_t InitialFileSize{1 << 16};
+
+        struct JournalHeader
+        {
+            uint64_t m_Magic{0};
+            uint32_t m_Version{0};
+            uint32_t m_RecordSize{0};
+            uint32_t m_CommandIndex{0};
+        };
+
+        struct JournalRecord
+        {
+            uint32_t m_Checksum{0};
+            uint16_t m_TypeId{0};
+            uint16_t m_Reserved{0};
+            uint32_t m_TargetId{0};
+            uint32_t m_Payload{0};
+        };
+
+        static_assert(sizeof(JournalHeader) <= CommandJournal::HeaderSize);
+        static_assert(sizeof(JournalRecord) == CommandJournal::RecordSize);
+
+        /// Mixes the record's fields and its index, so a record is only valid at the position it was written to.
+        [[nodiscard]] uint32_t CalculateChecksum(const JournalRecord& record, const uint32_t index)
+        {
+            const uint64_t type{record.m_TypeId | (uint32_t{record.m_Reserved} << 16)};
+            uint64_t hash{(type << 32 | record.m_TargetId) ^ ((uint64_t{record.m_Payload} << 32 | index) * 0x9E3779B97F4A7C15)};
+
+            // SplitMix64 finalizer
+            hash = (hash ^ (hash >> 30)) * 0xBF58476D1CE4E5B9;
+            hash = (hash ^ (hash >> 27)) * 0x94D049BB133111EB;
+            hash ^= hash >> 31;
+            return static_cast<uint32_t>(hash ^ (hash >> 32));
+        }
+
+        [[nodiscard]] JournalHeader ReadHeader(const std::byte* const data)
+        {
+            JournalHeader header{};
+            std::memcpy(&header, data, sizeof(header));
+            return header;
+        }
+
+        [[nodiscard]] JournalRecord ReadJournalRecord(const std::byte* const data)
+        {
+            JournalRecord record{};
+            std::memcpy(&record, data, sizeof(record));
+            return record;
+        }
+    }
+
+    CommandJournal::~CommandJournal()
+    {
+        Close();
+    }
+
+    bool CommandJournal::Open(const std::filesystem::path& path)
+    {
+        Close();
+
+        if(!m_File.Open(path, InitialFileSize))
+            return false;
+
+        JournalHeader header{ReadHeader(m_File.GetData())};
+        if(header.m_Magic == 0)
+        {
+            header = JournalHeader{JournalMagic, JournalVersion, RecordSize, 0};
+            std::memcpy(m_File.GetData(), &header, sizeof(header));
+        }
+        else if(!IsValidHeader(m_File.GetData()))
+        {
+            m_File.Close();
+            return false;
+        }
+
+        m_RecordCount = 0;
+        while(GetRecordOffset(m_RecordCount) + RecordSize <= m_File.GetSize()
+            && ReadRecord(m_File.GetData() + GetRecordOffset(m_RecordCount), m_RecordCount))
+        {
+            ++m_RecordCount;
+        }
+
+        // Clear the torn tail so records appended from here on can't be mistaken for older ones
+        const std::size_t endOffset{std::min(GetRecordOffset(m_RecordCount), m_File.GetSize())};
+        std::memset(m_File.GetData() + endOffset, 0, m_File.GetSize() - endOffset);
+
+        m_FlushedOffset = 0;
+        Flush();
+        return true;
+    }
+
+    void CommandJournal::Close()
+    {
+        if(!m_File.IsOpen())
+            return;
+
+        Flush();
+        m_File.Close();
+        m_RecordCount = 0;
+    }
+
+    bool CommandJournal::Append(const CommandRecord& record)
+    {
+        if(!m_File.IsOpen())
+            return false;
+
+        const std::size_t offset{GetRecordOffset(m_RecordCount)};
+        if(offset + RecordSize > m_File.GetSize() && !m_File.Resize(m_File.GetSize() * 2))
+        {
+            // Resize() closed the file
+            m_RecordCount = 0;
+            return false;
+        }
+
+        JournalRecord journalRecord{0, static_cast<uint16_t>(record.m_TypeId), 0, record.m_TargetId, record.m_Payload};
+        journalRecord.m_Checksum = CalculateChecksum(journalRecord, m_RecordCount);
+        std::memcpy(m_File.GetData() + offset, &journalRecord, sizeof(journalRecord));
+        ++m_RecordCount;
+
+        const std::size_t endOffset{offset + RecordSize};
+        if(endOffset - m_FlushedOffset >= m_FlushInterval)
+        {
+            m_File.Flush(0, HeaderSize, false);
+            m_File.Flush(m_FlushedOffset, endOffset - m_FlushedOffset, false);
+            m_FlushedOffset = endOffset;
+        }
+        return true;
+    }
+
+    void CommandJournal::Truncate(const uint32_t count)
+    {
+        if(!m_File.IsOpen())
+            return;
+
+        const std::size_t offset{GetRecordOffset(count)};
+        std::memset(m_File.GetData() + offset, 0, GetRecordOffset(m_RecordCount) - offset);
+        m_RecordCount = count;
+        m_FlushedOffset = std::min(m_FlushedOffset, offset);
+    }
+
+    void CommandJournal::SetCommandIndex(const uint32_t index)
+    {
+        if(!m_File.IsOpen())
+            return;
+
+        std::memcpy(m_File.GetData() + offsetof(JournalHeader, m_CommandIndex), &index, sizeof(index));
+    }
+
+    void CommandJournal::Flush()
+    {
+        if(!m_File.IsOpen())
+            return;
+
+        m_File.Flush(0, m_File.GetSize(), true);
+        m_FlushedOffset = GetRecordOffset(m_RecordCount);
+    }
+
+    CommandRecord CommandJournal::GetRecord(const uint32_t index) const
+    {
+        const JournalRecord record{ReadJournalRecord(m_File.GetData() + GetRecordOffset(index))};
+        return CommandRecord{static_cast<CommandTypeId>(record.m_TypeId), record.m_TargetId, record.m_Payload};
+    }
+
+    uint32_t CommandJournal::GetCommandIndex() const
+    {
+        if(!m_File.IsOpen())
+            return 0;
+
+        return ReadHeader(m_File.GetData()).m_CommandIndex;
+    }
+
+    bool CommandJournal::IsValidHeader(const std::byte* const data)
+    {
+        const JournalHeader header{ReadHeader(data)};
+        return header.m_Magic == JournalMagic && header.m_Version == JournalVersion && header.m_RecordSize == RecordSize;
+    }
+
+    std::optional<CommandRecord> CommandJournal::ReadRecord(const std::byte* const data, const uint32_t index)
+    {
+        const JournalRecord record{ReadJournalRecord(data)};
+        if(record.m_TypeId == static_cast<uint16_t>(CommandTypeId::None) || record.m_Checksum != CalculateChecksum(record, index))
+            return std::nullopt;
+
+        return CommandRecord{static_cast<CommandTypeId>(record.m_TypeId), record.m_TargetId, record.m_Payload};
+    }
+
+    std::optional<Command> DeserializeCommand(const CommandRecord& record, const TargetRegistry& registry)
+    {
+        switch(record.m_TypeId)
+        {
+        case CommandTypeId::ModifyValue:
+            if(std::shared_ptr<WorkingValue> value{registry.Find(record.m_TargetId)})
+                return Command{ModifyValueCommand{std::move(value), static_cast<int32_t>(record.m_Payload)}};
+            break;
+        case CommandTypeId::None:
+            break;
+        }
+        return std::nullopt;
+    }
+}
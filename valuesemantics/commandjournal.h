@@ -0,0 +1,97 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+
+#include "valuesemantics/commandqueue.h"
+#include "valuesemantics/commandrecord.h"
+#include "mappedfile.h"
+#include "targetregistry.h"
+
+namespace ValueSemantics
+{
+    /// Append-only file of CommandRecords plus the command index of the queue it belongs to, written through
+    /// a memory mapping so appending is a copy into memory. Records are checksummed, so a record torn by a crash
+    /// ends the journal when it is reopened, and the mapping is written back to the file every flushInterval bytes.
+    /// While closed, Append() fails and every other change is ignored.
+    class CommandJournal
+    {
+    public:
+        static constexpr std::size_t DefaultFlushInterval{1 << 20};
+
+        explicit CommandJournal(const std::size_t flushInterval = DefaultFlushInterval)
+            : m_FlushInterval{flushInterval}
+        {
+        }
+
+        ~CommandJournal();
+
+        CommandJournal(const CommandJournal&) = delete;
+        CommandJournal& operator=(const CommandJournal&) = delete;
+
+        /// Opens the journal at path, creating an empty one when missing. Records are recovered up to the first
+        /// torn or corrupt record, which is discarded along with everything after it.
+        /// Returns false when the file can't be mapped or isn't a journal.
+        [[nodiscard]] bool Open(const std::filesystem::path& path);
+
+        /// Flushes and closes the journal.
+        void Close();
+
+        /// Returns false, closing the journal, when the file can't be grown or the journal is closed.
+        [[nodiscard]] bool Append(const CommandRecord& record);
+
+        /// Discards every record from count onwards.
+        /// count has to be no greater than GetRecordCount()
+        void Truncate(uint32_t count);
+
+        void SetCommandIndex(uint32_t index);
+
+        /// Writes every change back to the file and waits for it to reach the disk.
+        void Flush();
+
+        [[nodiscard]] bool IsOpen() const
+        {
+            return m_File.IsOpen();
+        }
+
+        /// index has to be less than GetRecordCount()
+        [[nodiscard]] CommandRecord GetRecord(uint32_t index) const;
+
+        [[nodiscard]] uint32_t GetRecordCount() const
+        {
+            return m_RecordCount;
+        }
+
+        /// Command index stored in the journal, may be ahead of GetRecordCount() after a torn tail was discarded.
+        /// 0 while closed.
+        [[nodiscard]] uint32_t GetCommandIndex() const;
+
+        /// Size in bytes of the journal header and of each record in the file.
+        static constexpr std::size_t HeaderSize{64};
+        static constexpr std::size_t RecordSize{16};
+
+        /// True when the HeaderSize bytes at data are the header of a journal this version can read.
+        [[nodiscard]] static bool IsValidHeader(const std::byte* data);
+
+        /// Decodes the RecordSize bytes at data as the record at index.
+        /// Returns std::nullopt for empty, torn or corrupt records.
+        [[nodiscard]] static std::optional<CommandRecord> ReadRecord(const std::byte* data, uint32_t index);
+
+    private:
+        [[nodiscard]] static std::size_t GetRecordOffset(const uint32_t index)
+        {
+            return HeaderSize + std::size_t{index} * RecordSize;
+        }
+
+        MappedFile m_File{};
+        std::size_t m_FlushInterval{DefaultFlushInterval};
+        std::size_t m_FlushedOffset{0};
+        uint32_t m_RecordCount{0};
+    };
+
+    /// Rebuilds the command record was serialized from.
+    /// Returns std::nullopt when the type is unknown or its target isn't registered.
+    [[nodiscard]] std::optional<Command> DeserializeCommand(const CommandRecord& record, const TargetRegistry& registry);
+}
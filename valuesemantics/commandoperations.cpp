@@ -13,6 +13,61 @@ namespace ValueSemantics
         command.Rollback();
     }
 
+    bool TryMerge(ModifyValueCommand& command, const ModifyValueCommand& next)
+    {
+        return command.TryMerge(next);
+    }
+
+    void DeclareAccess(const ModifyValueCommand& command, CommandAccess& access)
+    {
+        command.DeclareAccess(access);
+    }
+
+    bool Serialize(const ModifyValueCommand& command, const TargetRegistry& registry, CommandRecord& record)
+    {
+        return command.Serialize(registry, record);
+    }
+
+    bool IsNoOp(const ModifyValueCommand& command)
+    {
+        return command.IsNoOp();
+    }
+
+    const void* GetTargetKey(const ModifyValueCommand& command)
+    {
+        return command.GetTargetKey();
+    }
+
+    void Execute(ModifyStoredValueCommand& command)
+    {
+        command.Execute();
+    }
+
+    void Rollback(ModifyStoredValueCommand& command)
+    {
+        command.Rollback();
+    }
+
+    bool TryMerge(ModifyStoredValueCommand& command, const ModifyStoredValueCommand& next)
+    {
+        return command.TryMerge(next);
+    }
+
+    void DeclareAccess(const ModifyStoredValueCommand& command, CommandAccess& access)
+    {
+        command.DeclareAccess(access);
+    }
+
+    bool IsNoOp(const ModifyStoredValueCommand& command)
+    {
+        return command.IsNoOp();
+    }
+
+    const void* GetTargetKey(const ModifyStoredValueCommand& command)
+    {
+        return command.GetTargetKey();
+    }
+
     void Execute(LambdaCommand& command)
     {
         command.Execute();
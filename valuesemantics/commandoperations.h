@@ -1,14 +1,48 @@
 #pragma once
 
+class CommandAccess;
+class TargetRegistry;
+
 namespace ValueSemantics
 {
+    struct CommandRecord;
+
     class ModifyValueCommand;
 
     void Execute(ModifyValueCommand& command);
     void Rollback(ModifyValueCommand& command);
+    bool TryMerge(ModifyValueCommand& command, const ModifyValueCommand& next);
+    void DeclareAccess(const ModifyValueCommand& command, CommandAccess& access);
+    bool Serialize(const ModifyValueCommand& command, const TargetRegistry& registry, CommandRecord& record);
+    bool IsNoOp(const ModifyValueCommand& command);
+    const void* GetTargetKey(const ModifyValueCommand& command);
+
+    class ModifyStoredValueCommand;
+
+    void Execute(ModifyStoredValueCommand& command);
+    void Rollback(ModifyStoredValueCommand& command);
+    bool TryMerge(ModifyStoredValueCommand& command, const ModifyStoredValueCommand& next);
+    void DeclareAccess(const ModifyStoredValueCommand& command, CommandAccess& access);
+    bool IsNoOp(const ModifyStoredValueCommand& command);
+    const void* GetTargetKey(const ModifyStoredValueCommand& command);
 
     class LambdaCommand;
 
     void Execute(LambdaCommand& command);
     void Rollback(LambdaCommand& command);
+
+    template<class TFunction>
+    class DirectionalLambdaCommand;
+
+    template<class TFunction>
+    void Execute(DirectionalLambdaCommand<TFunction>& command)
+    {
+        command.Execute();
+    }
+
+    template<class TFunction>
+    void Rollback(DirectionalLambdaCommand<TFunction>& command)
+    {
+        command.Rollback();
+    }
 }
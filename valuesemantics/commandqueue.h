@@ -1,37 +1,80 @@
 #pragma once
 
-#include <memory>
+#include <algorithm>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <span>
+#include <type_traits>
+#include <typeinfo>
+#include <utility>
 #include <vector>
 
+#include "valuesemantics/commandinstrumentation.h"
 #include "valuesemantics/commandoperations.h"
+#include "commandaccess.h"
+#include "parallelcommandexecutor.h"
 
 namespace ValueSemantics
 {
-    class Command
+    /// Commands that fit within TBufferSize bytes are stored inline, larger commands are heap allocated.
+    template<std::size_t TBufferSize>
+    class BasicCommand
     {
     public:
         template<class TCommand>
-        Command(TCommand&& command)
-            : m_Pimpl{std::make_unique<CommandModel<TCommand>>(std::move(command))}
+            requires (!std::is_same_v<std::remove_cvref_t<TCommand>, BasicCommand>)
+        BasicCommand(TCommand&& command)
         {
+            using Model = CommandModel<std::remove_cvref_t<TCommand>>;
+
+            if constexpr(FitsInBuffer<std::remove_cvref_t<TCommand>>())
+            {
+                m_Pimpl = ::new(static_cast<void*>(m_Buffer)) Model{std::forward<TCommand>(command)};
+            }
+            else
+            {
+                m_Pimpl = new Model{std::forward<TCommand>(command)};
+            }
         }
 
-        Command(const Command& other)
-            : m_Pimpl{other.m_Pimpl->Clone()}
+        ~BasicCommand()
         {
+            Reset();
         }
 
-        Command& operator=(const Command& other)
+        BasicCommand(const BasicCommand& other)
+            : m_Pimpl{other.m_Pimpl->CloneInto(m_Buffer)}
+        {
+        }
+
+        BasicCommand& operator=(const BasicCommand& other)
         {
             if(this == &other)
                 return *this;
 
-            other.m_Pimpl->Clone().swap(m_Pimpl);
+            BasicCommand copy{other};
+            *this = std::move(copy);
             return *this;
         }
 
-        Command(Command&& other) = default;
-        Command& operator=(Command&& other) = default;
+        BasicCommand(BasicCommand&& other) noexcept
+            : m_Pimpl{other.m_Pimpl ? other.m_Pimpl->MoveInto(m_Buffer) : nullptr}
+        {
+            other.m_Pimpl = nullptr;
+        }
+
+        BasicCommand& operator=(BasicCommand&& other) noexcept
+        {
+            if(this == &other)
+                return *this;
+
+            Reset();
+            m_Pimpl = other.m_Pimpl ? other.m_Pimpl->MoveInto(m_Buffer) : nullptr;
+            other.m_Pimpl = nullptr;
+            return *this;
+        }
 
         void Execute()
         {
@@ -43,28 +86,113 @@ namespace ValueSemantics
             m_Pimpl->Rollback();
         }
 
+        /// Absorbs next into this command so executing it once has the effect of executing both.
+        /// Only commands of the same type with a TryMerge(TCommand&, const TCommand&) overload can be merged,
+        /// returns false, leaving both commands untouched, otherwise.
+        bool TryMerge(const BasicCommand& next)
+        {
+            return m_Pimpl->TryMerge(*next.m_Pimpl);
+        }
+
+        /// Adds the resources the command reads and writes to access. Returns false when the command type has no
+        /// DeclareAccess(const TCommand&, CommandAccess&) overload, the command then conflicts with every other command.
+        bool DeclareAccess(CommandAccess& access) const
+        {
+            return m_Pimpl->DeclareAccess(access);
+        }
+
+        /// True when the command has no effect, e.g. after merging a command with its inverse.
+        /// Returns false when the command type has no IsNoOp(const TCommand&) overload.
+        [[nodiscard]] bool IsNoOp() const
+        {
+            return m_Pimpl->IsNoOp();
+        }
+
+        /// Identity of the one resource the command modifies, commands with different keys touch disjoint state
+        /// and can be reordered. Returns nullptr when the command type has no GetTargetKey(const TCommand&) overload.
+        [[nodiscard]] const void* GetTargetKey() const
+        {
+            return m_Pimpl->GetTargetKey();
+        }
+
+        /// Type of the stored command, e.g. typeid(ModifyValueCommand).
+        [[nodiscard]] const std::type_info& GetType() const
+        {
+            return m_Pimpl->GetType();
+        }
+
+        /// True when TCommand is stored within the command's buffer rather than on the heap.
+        template<class TCommand>
+        [[nodiscard]] static constexpr bool StoresInline()
+        {
+            return FitsInBuffer<TCommand>();
+        }
+
     private:
         class CommandConcept
         {
         public:
             virtual ~CommandConcept() = default;
-            virtual std::unique_ptr<CommandConcept> Clone() const = 0;
+            /// Copies the model into buffer if it fits, otherwise onto the heap.
+            virtual CommandConcept* CloneInto(std::byte* buffer) const = 0;
+            /// Moves an inline model into buffer, heap models transfer ownership of themselves.
+            virtual CommandConcept* MoveInto(std::byte* buffer) noexcept = 0;
+            virtual void Destroy() noexcept = 0;
             virtual void Execute() = 0;
             virtual void Rollback() = 0;
+            virtual bool TryMerge(const CommandConcept& next) = 0;
+            virtual bool DeclareAccess(CommandAccess& access) const = 0;
+            virtual bool IsNoOp() const = 0;
+            virtual const void* GetTargetKey() const = 0;
+            virtual const std::type_info& GetType() const = 0;
         };
 
         template<class TCommand>
         class CommandModel final : public CommandConcept
         {
         public:
-            CommandModel(TCommand&& command)
-                : m_Command{std::move(command)}
+            template<class TArg>
+            CommandModel(TArg&& command)
+                : m_Command{std::forward<TArg>(command)}
+            {
+            }
+
+            CommandConcept* CloneInto(std::byte* buffer) const override
+            {
+                if constexpr(FitsInBuffer<TCommand>())
+                {
+                    return ::new(static_cast<void*>(buffer)) CommandModel{m_Command};
+                }
+                else
+                {
+                    return new CommandModel{m_Command};
+                }
+            }
+
+            CommandConcept* MoveInto(std::byte* buffer) noexcept override
             {
+                if constexpr(FitsInBuffer<TCommand>())
+                {
+                    CommandConcept* const moved{::new(static_cast<void*>(buffer)) CommandModel{std::move(m_Command)}};
+                    this->~CommandModel();
+                    return moved;
+                }
+                else
+                {
+                    return this;
+                }
             }
 
-            std::unique_ptr<CommandConcept> Clone() const override
+            void Destroy() noexcept override
             {
-                return std::make_unique<CommandModel>(*this);
+                if constexpr(FitsInBuffer<TCommand>())
+                {
+                    this->~CommandModel();
+                }
+                else
+                {
+                    delete this;
+                }
             }
 
             void Execute() override
@@ -77,41 +205,197 @@ namespace ValueSemantics
                 ValueSemantics::Rollback(m_Command);
             }
 
-            TCommand m_Command{};
+            bool TryMerge(const CommandConcept& next) override
+            {
+                if constexpr(requires(TCommand& command, const TCommand& next)
+                    { { ValueSemantics::TryMerge(command, next) } -> std::same_as<bool>; })
+                {
+                    if(typeid(next) == typeid(CommandModel))
+                        return ValueSemantics::TryMerge(m_Command, static_cast<const CommandModel&>(next).m_Command);
+                }
+                return false;
+            }
+
+            bool DeclareAccess(CommandAccess& access) const override
+            {
+                if constexpr(requires(const TCommand& command, CommandAccess& declared) { ValueSemantics::DeclareAccess(command, declared); })
+                {
+                    ValueSemantics::DeclareAccess(m_Command, access);
+                    return true;
+                }
+                else
+                {
+                    return false;
+                }
+            }
+
+            bool IsNoOp() const override
+            {
+                if constexpr(requires(const TCommand& command) { { ValueSemantics::IsNoOp(command) } -> std::same_as<bool>; })
+                    return ValueSemantics::IsNoOp(m_Command);
+                else
+                    return false;
+            }
+
+            const void* GetTargetKey() const override
+            {
+                if constexpr(requires(const TCommand& command) { { ValueSemantics::GetTargetKey(command) } -> std::convertible_to<const void*>; })
+                    return ValueSemantics::GetTargetKey(m_Command);
+                else
+                    return nullptr;
+            }
+
+            const std::type_info& GetType() const override
+            {
+                return typeid(TCommand);
+            }
+
+            TCommand m_Command;
         };
 
-        std::unique_ptr<CommandConcept> m_Pimpl{};
+        template<class TCommand>
+        [[nodiscard]] static constexpr bool FitsInBuffer()
+        {
+            return sizeof(CommandModel<TCommand>) <= TBufferSize
+                && alignof(CommandModel<TCommand>) <= alignof(std::max_align_t)
+                && std::is_nothrow_move_constructible_v<TCommand>;
+        }
+
+        void Reset() noexcept
+        {
+            if(m_Pimpl)
+            {
+                m_Pimpl->Destroy();
+                m_Pimpl = nullptr;
+            }
+        }
+
+        alignas(std::max_align_t) std::byte m_Buffer[TBufferSize == 0 ? 1 : TBufferSize];
+        CommandConcept* m_Pimpl{nullptr};
+    };
+
+    /// Sized so a Command occupies a single 64 byte cache line on 64-bit targets.
+    inline constexpr std::size_t DefaultCommandBufferSize{48};
+
+    using Command = BasicCommand<DefaultCommandBufferSize>;
+
+    /// Rules for folding a queued command into the last command in the queue through Command::TryMerge().
+    enum class CoalescePolicy
+    {
+        /// Every queued command is kept as its own entry.
+        Disabled,
+        /// Commands are only merged into the last command while it is still pending.
+        PendingOnly,
+        /// As PendingOnly, and with no pending commands a command may also be merged into the last executed one.
+        /// The merged command is executed immediately so the queue's state stays consistent with its history.
+        AcrossCursor
+    };
+
+    /// Commands eliminated by BasicCommandQueue::OptimizePendingCommands().
+    struct PeepholeStatistics
+    {
+        /// Commands merged into an earlier pending command on the same target.
+        uint32_t m_FoldedCount{0};
+        /// Commands removed because they, or the result of folding commands into them, had no effect.
+        uint32_t m_NoOpCount{0};
+
+        [[nodiscard]] uint32_t GetEliminatedCount() const
+        {
+            return m_FoldedCount + m_NoOpCount;
+        }
     };
 
-    class CommandQueue
+    /// TInstrumentation wraps every command executed or rolled back, except through a ParallelCommandExecutor,
+    /// and sees the queue's depth.
+    /// NullInstrumentation compiles down to the bare calls, StatisticsInstrumentation is queried
+    /// through GetInstrumentation(). Define COMMAND_PATTERN_INSTRUMENTATION to instrument every CommandQueue.
+    /// Commands queued between BeginGroup() and EndGroup() form a group which is executed and rolled back as one step,
+    /// so indices and sizes count steps rather than commands. Groups are stored inline with every other command.
+    template<class TInstrumentation>
+    class BasicCommandQueue : private TInstrumentation
     {
     public:
         /// HasPendingCommand() has to be true before calling
         void ExecuteCommand()
         {
-            m_CommandQueue[m_CommandIndex].Execute();
-            ++m_CommandIndex;
+            ExecuteN(1);
         }
 
         /// HasPendingRollbackCommand() has to be true before calling
         void RollbackCommand()
         {
-            --m_CommandIndex;
-            m_CommandQueue[m_CommandIndex].Rollback();
+            RollbackTo(m_CommandIndex - 1);
         }
 
+        /// Executes every pending command.
+        void ExecuteAll()
+        {
+            ExecuteN(GetCommandQueueSize() - m_CommandIndex);
+        }
+
+        /// Not exception safe: the cursor only moves once the whole range has run, so when a command throws the commands
+        /// which already ran aren't counted. Step with ExecuteCommand() where commands may throw.
+        /// count has to be no greater than the number of pending commands
+        void ExecuteN(const uint32_t count)
+        {
+            TInstrumentation::ExecuteRange(GetSteps(m_CommandIndex, m_CommandIndex + count));
+            m_CommandIndex += count;
+        }
+
+        /// Rolls back commands until GetCommandIndex() == index.
+        /// Not exception safe: the cursor only moves once the whole range has run, so when a command throws the commands
+        /// which already ran aren't counted. Step with RollbackCommand() where commands may throw.
+        /// index has to be no greater than GetCommandIndex()
+        void RollbackTo(const uint32_t index)
+        {
+            TInstrumentation::RollbackRange(GetSteps(index, m_CommandIndex));
+            m_CommandIndex = index;
+        }
+
+        /// Executes every pending command through executor, running commands with disjoint accesses in parallel.
+        /// The result is the same as ExecuteAll().
+        void ExecuteAll(ParallelCommandExecutor& executor)
+        {
+            executor.Execute(GetSteps(m_CommandIndex, GetCommandQueueSize()));
+            m_CommandIndex = GetCommandQueueSize();
+        }
+
+        /// Rolls back commands until GetCommandIndex() == index through executor, the exact reverse of executing them.
+        /// index has to be no greater than GetCommandIndex()
+        void RollbackTo(const uint32_t index, ParallelCommandExecutor& executor)
+        {
+            executor.Rollback(GetSteps(index, m_CommandIndex));
+            m_CommandIndex = index;
+        }
+
+        /// Executes or rolls back commands until GetCommandIndex() == index.
+        /// index has to be no greater than GetCommandQueueSize()
+        void SeekTo(const uint32_t index)
+        {
+            if(index > m_CommandIndex)
+                ExecuteN(index - m_CommandIndex);
+            else
+                RollbackTo(index);
+        }
+
+        /// Also discards an open group.
         void ClearQueue()
         {
             m_CommandQueue.clear();
+            m_StepEnds.clear();
             m_CommandIndex = 0;
+            m_GroupDepth = 0;
         }
 
         /// Removes any commands ahead of and including the current pending command.
-        /// HasPendingCommand() has to be true before calling
+        /// Also discards an open group along with the commands queued into it, the next command is a step of its own.
+        /// HasPendingCommand() or IsGroupOpen() has to be true before calling
         void ClearPendingCommands()
         {
-            const auto itr{std::begin(m_CommandQueue) + m_CommandIndex};
+            const auto itr{std::begin(m_CommandQueue) + GetStepBegin(m_CommandIndex)};
             m_CommandQueue.erase(itr, std::end(m_CommandQueue));
+            m_StepEnds.resize(m_CommandIndex);
+            m_GroupDepth = 0;
         }
 
         [[nodiscard]] bool HasPendingCommand() const
@@ -124,22 +408,226 @@ namespace ValueSemantics
             return m_CommandIndex != 0 && GetCommandQueueSize() >= m_CommandIndex;
         }
 
+        /// Within a group the command is added to the group, otherwise it's a step of its own.
         void QueueCommand(Command&& command)
         {
+            if(m_GroupDepth == 0 && TryCoalesce(command))
+                return;
+
             m_CommandQueue.push_back(std::move(command));
+            if(m_GroupDepth == 0)
+                m_StepEnds.push_back(GetStoredCommandCount());
+
+            TInstrumentation::RecordQueueDepth(GetCommandQueueSize(), GetCommandQueueSize() - m_CommandIndex);
         }
 
+        /// Starts a group, commands queued until the matching EndGroup() are executed and rolled back as one step.
+        /// Groups may be nested, inner groups are part of the outermost group.
+        void BeginGroup()
+        {
+            ++m_GroupDepth;
+        }
+
+        /// Closes the group opened by the last BeginGroup(). An empty group adds no step.
+        /// A group has to be open before calling
+        void EndGroup()
+        {
+            --m_GroupDepth;
+            if(m_GroupDepth == 0 && GetStoredCommandCount() != GetStepBegin(GetCommandQueueSize()))
+            {
+                m_StepEnds.push_back(GetStoredCommandCount());
+                TInstrumentation::RecordQueueDepth(GetCommandQueueSize(), GetCommandQueueSize() - m_CommandIndex);
+            }
+        }
+
+        /// Optimization pass over the pending commands, executed history is never touched. A pending command is folded
+        /// into the last earlier pending command with the same target key when TryMerge() succeeds, which may move it
+        /// ahead of commands on other targets, and commands which turn out to be no-ops are removed, so a command
+        /// followed by its inverse cancels out. Commands without a target key and groups are kept as they are and
+        /// nothing is folded across them. Commands of an open group are left untouched.
+        PeepholeStatistics OptimizePendingCommands()
+        {
+            PeepholeStatistics statistics{};
+            const uint32_t firstStep{m_CommandIndex};
+            const uint32_t stepCount{GetCommandQueueSize()};
+            std::vector<bool> removed(stepCount - firstStep);
+            // Last step of each target since the last barrier. Frames touch few targets, a flat list beats hashing
+            std::vector<std::pair<const void*, uint32_t>> lastStepByTarget{};
+
+            for(uint32_t step{firstStep}; step != stepCount; ++step)
+            {
+                const uint32_t begin{GetStepBegin(step)};
+                if(m_StepEnds[step] - begin != 1)
+                {
+                    lastStepByTarget.clear();
+                    continue;
+                }
+
+                Command& command{m_CommandQueue[begin]};
+                if(command.IsNoOp())
+                {
+                    removed[step - firstStep] = true;
+                    ++statistics.m_NoOpCount;
+                    continue;
+                }
+
+                const void* const target{command.GetTargetKey()};
+                if(!target)
+                {
+                    lastStepByTarget.clear();
+                    continue;
+                }
+
+                const auto last{std::find_if(lastStepByTarget.begin(), lastStepByTarget.end(),
+                    [target](const std::pair<const void*, uint32_t>& entry)
+                    {
+                        return entry.first == target;
+                    })};
+                if(last == lastStepByTarget.end())
+                {
+                    lastStepByTarget.emplace_back(target, step);
+                    continue;
+                }
+
+                Command& lastCommand{m_CommandQueue[GetStepBegin(last->second)]};
+                if(!lastCommand.TryMerge(command))
+                {
+                    last->second = step;
+                    continue;
+                }
+
+                removed[step - firstStep] = true;
+                ++statistics.m_FoldedCount;
+                if(lastCommand.IsNoOp())
+                {
+                    removed[last->second - firstStep] = true;
+                    ++statistics.m_NoOpCount;
+                    lastStepByTarget.erase(last);
+                }
+            }
+
+            if(statistics.GetEliminatedCount() != 0)
+                RemoveSteps(firstStep, removed);
+
+            return statistics;
+        }
+
+        [[nodiscard]] bool IsGroupOpen() const
+        {
+            return m_GroupDepth != 0;
+        }
+
+        void SetCoalescePolicy(const CoalescePolicy policy)
+        {
+            m_CoalescePolicy = policy;
+        }
+
+        [[nodiscard]] CoalescePolicy GetCoalescePolicy() const
+        {
+            return m_CoalescePolicy;
+        }
+
+        /// Number of steps executed.
         [[nodiscard]] uint32_t GetCommandIndex() const
         {
             return m_CommandIndex;
         }
 
+        /// Number of steps, a group counts as one.
         [[nodiscard]] uint32_t GetCommandQueueSize() const
+        {
+            return static_cast<uint32_t>(m_StepEnds.size());
+        }
+
+        /// Number of commands, counting every command of a group and of an open group.
+        [[nodiscard]] uint32_t GetStoredCommandCount() const
         {
             return static_cast<uint32_t>(m_CommandQueue.size());
         }
+
+        [[nodiscard]] const TInstrumentation& GetInstrumentation() const
+        {
+            return *this;
+        }
+
+        [[nodiscard]] TInstrumentation& GetInstrumentation()
+        {
+            return *this;
+        }
     private:
+        [[nodiscard]] uint32_t GetStepBegin(const uint32_t step) const
+        {
+            return step == 0 ? 0 : m_StepEnds[step - 1];
+        }
+
+        /// Commands of the steps [beginStep, endStep).
+        [[nodiscard]] std::span<Command> GetSteps(const uint32_t beginStep, const uint32_t endStep)
+        {
+            const uint32_t begin{GetStepBegin(beginStep)};
+            return std::span{m_CommandQueue}.subspan(begin, GetStepBegin(endStep) - begin);
+        }
+
+        /// Removes the steps from firstStep on flagged in removed, moving the later commands down.
+        void RemoveSteps(const uint32_t firstStep, const std::vector<bool>& removed)
+        {
+            uint32_t read{GetStepBegin(firstStep)};
+            uint32_t write{read};
+            uint32_t keptStep{firstStep};
+            for(uint32_t step{firstStep}; step != GetCommandQueueSize(); ++step)
+            {
+                const uint32_t end{m_StepEnds[step]};
+                if(removed[step - firstStep])
+                {
+                    read = end;
+                    continue;
+                }
+
+                for(; read != end; ++read, ++write)
+                {
+                    if(read != write)
+                        m_CommandQueue[write] = std::move(m_CommandQueue[read]);
+                }
+                m_StepEnds[keptStep++] = write;
+            }
+
+            // Commands of an open group follow the last step
+            for(; read != GetStoredCommandCount(); ++read, ++write)
+            {
+                if(read != write)
+                    m_CommandQueue[write] = std::move(m_CommandQueue[read]);
+            }
+
+            m_CommandQueue.erase(std::begin(m_CommandQueue) + write, std::end(m_CommandQueue));
+            m_StepEnds.resize(keptStep);
+        }
+
+        /// Merges command into the last queued command when the coalesce policy allows it.
+        /// Commands are never merged into a group.
+        [[nodiscard]] bool TryCoalesce(Command& command)
+        {
+            if(m_CoalescePolicy == CoalescePolicy::Disabled || m_StepEnds.empty())
+                return false;
+
+            if(GetStepBegin(GetCommandQueueSize() - 1) + 1 != GetStoredCommandCount())
+                return false;
+
+            if(HasPendingCommand())
+                return m_CommandQueue.back().TryMerge(command);
+
+            if(m_CoalescePolicy != CoalescePolicy::AcrossCursor || !m_CommandQueue.back().TryMerge(command))
+                return false;
+
+            TInstrumentation::Execute(command);
+            return true;
+        }
+
         std::vector<Command> m_CommandQueue{};
+        /// End of each step within m_CommandQueue. Commands past the last step belong to the open group.
+        std::vector<uint32_t> m_StepEnds{};
         uint32_t m_CommandIndex{0};
+        uint32_t m_GroupDepth{0};
+        CoalescePolicy m_CoalescePolicy{CoalescePolicy::Disabled};
     };
+
+    using CommandQueue = BasicCommandQueue<DefaultInstrumentation>;
 }
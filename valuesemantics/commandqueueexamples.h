@@ -1,10 +1,13 @@
 #pragma once
 
+#include <limits>
+
 #include <catch2/catch_test_macros.hpp>
 #include <catch2/benchmark/catch_benchmark.hpp>
 
 #include "valuesemantics/commands.h"
 #include "valuesemantics/commandqueue.h"
+#include "allocationcounter.h"
 #include "workingvalue.h"
 
 namespace ValueSemantics
@@ -25,6 +28,16 @@ namespace ValueSemantics
                 }};
         }
 
+        [[nodiscard]] static auto CreateDirectionalLambdaCommand(
+            std::shared_ptr<WorkingValue> value, const int32_t valueModification)
+        {
+            return DirectionalLambdaCommand{
+                [value = std::move(value), valueModification](const Direction direction)
+                {
+                    value->ModifyValue(direction == Direction::Execute ? valueModification : -valueModification);
+                }};
+        }
+
         [[nodiscard]] static ModifyValueCommand CreateCommand(
             std::shared_ptr<WorkingValue> value, const int32_t valueModification)
         {
@@ -249,10 +262,279 @@ namespace ValueSemantics
             REQUIRE(queue.GetCommandIndex() == 0);
             REQUIRE(queue.GetCommandQueueSize() == 3);
         }
+
+        SECTION("Directional Lambda Commands")
+        {
+            queue.QueueCommand(CreateDirectionalLambdaCommand(value, 1));
+            queue.QueueCommand(CreateCommand(value, 2));
+            queue.QueueCommand(CreateDirectionalLambdaCommand(value, 3));
+            REQUIRE(value.use_count() == 4);
+
+            queue.ExecuteCommand(); // +1
+            queue.ExecuteCommand(); // +2
+            queue.ExecuteCommand(); // +3
+            REQUIRE(value->GetValue() == 6);
+
+            queue.RollbackCommand(); // -3
+            REQUIRE(value->GetValue() == 3);
+
+            queue.RollbackCommand(); // -2
+            queue.RollbackCommand(); // -1
+            REQUIRE(value->GetValue() == 0);
+        }
+
+        SECTION("Copy Command Queue")
+        {
+            static_assert(Command::StoresInline<ModifyValueCommand>());
+
+            queue.QueueCommand(CreateCommand(value, 1));
+            queue.QueueCommand(CreateLambdaCommand(value, 2));
+            queue.ExecuteCommand(); // +1
+
+            CommandQueue copy{queue};
+            REQUIRE(copy.GetCommandIndex() == 1);
+            REQUIRE(copy.GetCommandQueueSize() == 2);
+
+            copy.ExecuteCommand(); // +2
+            REQUIRE(value->GetValue() == 3);
+
+            queue = std::move(copy);
+            REQUIRE(queue.GetCommandIndex() == 2);
+            REQUIRE(queue.GetCommandQueueSize() == 2);
+
+            queue.RollbackCommand(); // -2
+            queue.RollbackCommand(); // -1
+            REQUIRE(value->GetValue() == 0);
+        }
+
+        SECTION("Bulk Cursor Commands")
+        {
+            queue.QueueCommand(CreateCommand(value, 1));
+            queue.QueueCommand(CreateCommand(value, 2));
+            queue.QueueCommand(CreateLambdaCommand(value, 3));
+            queue.QueueCommand(CreateLambdaCommand(value, 4));
+            queue.QueueCommand(CreateCommand(value, 5));
+
+            queue.ExecuteN(2); // +1, +2
+            REQUIRE(value->GetValue() == 3);
+            REQUIRE(queue.GetCommandIndex() == 2);
+
+            queue.ExecuteAll(); // +3, +4, +5
+            REQUIRE(value->GetValue() == 15);
+            REQUIRE_FALSE(queue.HasPendingCommand());
+            REQUIRE(queue.GetCommandIndex() == 5);
+
+            queue.RollbackTo(1); // -5, -4, -3, -2
+            REQUIRE(value->GetValue() == 1);
+            REQUIRE(queue.GetCommandIndex() == 1);
+
+            queue.SeekTo(4); // +2, +3, +4
+            REQUIRE(value->GetValue() == 10);
+            REQUIRE(queue.GetCommandIndex() == 4);
+
+            queue.SeekTo(3); // -4
+            REQUIRE(value->GetValue() == 6);
+            REQUIRE(queue.GetCommandIndex() == 3);
+
+            queue.SeekTo(3);
+            REQUIRE(value->GetValue() == 6);
+
+            queue.RollbackTo(0); // -3, -2, -1
+            REQUIRE(value->GetValue() == 0);
+            REQUIRE(queue.GetCommandIndex() == 0);
+            REQUIRE_FALSE(queue.HasPendingRollbackCommand());
+            REQUIRE(queue.GetCommandQueueSize() == 5);
+        }
+
+        SECTION("Coalesce Commands")
+        {
+            std::shared_ptr<WorkingValue> otherValue{std::make_shared<WorkingValue>()};
+            REQUIRE(queue.GetCoalescePolicy() == CoalescePolicy::Disabled);
+
+            queue.SetCoalescePolicy(CoalescePolicy::PendingOnly);
+            queue.QueueCommand(CreateCommand(value, 1));
+            queue.QueueCommand(CreateCommand(value, 2)); // Merged into +1
+            queue.QueueCommand(CreateCommand(otherValue, 4));
+            queue.QueueCommand(CreateLambdaCommand(value, 8));
+            queue.QueueCommand(CreateCommand(value, 16));
+            REQUIRE(queue.GetCommandQueueSize() == 4);
+            REQUIRE(value.use_count() == 5);
+
+            queue.ExecuteAll(); // +3, +4, +8, +16
+            REQUIRE(value->GetValue() == 27);
+            REQUIRE(otherValue->GetValue() == 4);
+
+            queue.QueueCommand(CreateCommand(value, 32)); // Not merged into the executed +16
+            REQUIRE(queue.GetCommandQueueSize() == 5);
+
+            queue.ExecuteCommand(); // +32
+            queue.SetCoalescePolicy(CoalescePolicy::AcrossCursor);
+            queue.QueueCommand(CreateCommand(value, 64)); // Merged into the executed +32 and executed
+            REQUIRE(value->GetValue() == 123);
+            REQUIRE_FALSE(queue.HasPendingCommand());
+            REQUIRE(queue.GetCommandQueueSize() == 5);
+
+            queue.RollbackCommand(); // -96
+            REQUIRE(value->GetValue() == 27);
+
+            queue.RollbackTo(0); // -16, -8, -4, -3
+            REQUIRE(value->GetValue() == 0);
+            REQUIRE(otherValue->GetValue() == 0);
+        }
+
+        SECTION("Coalesce Commands Without Overflow")
+        {
+            constexpr int32_t maxValue{std::numeric_limits<int32_t>::max()};
+            queue.SetCoalescePolicy(CoalescePolicy::PendingOnly);
+            queue.QueueCommand(CreateCommand(value, maxValue));
+            queue.QueueCommand(CreateCommand(value, 1)); // Not merged, the sum overflows
+            queue.QueueCommand(CreateCommand(value, -maxValue)); // Merged into +1
+            queue.QueueCommand(CreateCommand(value, -1)); // Merged into -(maxValue - 1)
+            queue.QueueCommand(CreateCommand(value, -1)); // Not merged, the sum is the minimum which can't be rolled back
+            queue.QueueCommand(CreateCommand(value, -2)); // Merged into -1
+            REQUIRE(queue.GetCommandQueueSize() == 3);
+
+            queue.ExecuteCommand();
+            REQUIRE(value->GetValue() == maxValue);
+            queue.ExecuteAll();
+            REQUIRE(value->GetValue() == -3);
+
+            queue.RollbackTo(0);
+            REQUIRE(value->GetValue() == 0);
+
+            constexpr int32_t minValue{std::numeric_limits<int32_t>::min()};
+            STATIC_REQUIRE(WorkingValue::CanMerge(maxValue, -1));
+            STATIC_REQUIRE(WorkingValue::CanMerge(-maxValue, 0));
+            STATIC_REQUIRE_FALSE(WorkingValue::CanMerge(-maxValue, -1));
+            STATIC_REQUIRE_FALSE(WorkingValue::CanMerge(minValue, 0));
+            STATIC_REQUIRE_FALSE(WorkingValue::CanMerge(maxValue, 1));
+        }
     }
 
     TEST_CASE("Command Queue - Value Semantics - Creation Benchmark")
     {
+        using HeapCommand = BasicCommand<0>;
+        static_assert(Command::StoresInline<ModifyValueCommand>());
+        static_assert(!HeapCommand::StoresInline<ModifyValueCommand>());
+
+        {
+            constexpr uint32_t creationCount{50'000};
+            std::shared_ptr<WorkingValue> value{std::make_shared<WorkingValue>()};
+            std::vector<Command> inlineCommands{};
+            std::vector<HeapCommand> heapCommands{};
+            inlineCommands.reserve(creationCount);
+            heapCommands.reserve(creationCount);
+
+            const AllocationCounter inlineCounter{};
+            for(uint32_t i{0}; i != creationCount; ++i)
+            {
+                inlineCommands.push_back(CreateCommand(value, 0));
+            }
+            REQUIRE(inlineCounter.GetAllocationCount() == 0);
+
+            const AllocationCounter heapCounter{};
+            for(uint32_t i{0}; i != creationCount; ++i)
+            {
+                heapCommands.push_back(CreateCommand(value, 0));
+            }
+            REQUIRE(heapCounter.GetAllocationCount() == creationCount);
+        }
+
+        {
+            constexpr uint32_t creationCount{50'000};
+            std::shared_ptr<WorkingValue> value{std::make_shared<WorkingValue>()};
+            std::vector<Command> lambdaCommands{};
+            std::vector<Command> directionalCommands{};
+            lambdaCommands.reserve(creationCount);
+            directionalCommands.reserve(creationCount);
+
+            const AllocationCounter lambdaCounter{};
+            for(uint32_t i{0}; i != creationCount; ++i)
+            {
+                lambdaCommands.push_back(CreateLambdaCommand(value, 0));
+            }
+            REQUIRE(lambdaCounter.GetAllocationCount() >= creationCount);
+
+            const AllocationCounter directionalCounter{};
+            for(uint32_t i{0}; i != creationCount; ++i)
+            {
+                directionalCommands.push_back(CreateDirectionalLambdaCommand(value, 0));
+            }
+            REQUIRE(directionalCounter.GetAllocationCount() == 0);
+        }
+
+        BENCHMARK("Inline Commands")
+        {
+            constexpr uint32_t creationCount{50'000};
+            std::shared_ptr<WorkingValue> value{std::make_shared<WorkingValue>()};
+            std::vector<Command> commands{};
+            commands.reserve(creationCount);
+
+            for(uint32_t i{0}; i != creationCount; ++i)
+            {
+                commands.push_back(CreateCommand(value, 0));
+            }
+
+            for(Command& command : commands)
+            {
+                command.Execute();
+            }
+        };
+
+        BENCHMARK("Heap Allocated Commands")
+        {
+            constexpr uint32_t creationCount{50'000};
+            std::shared_ptr<WorkingValue> value{std::make_shared<WorkingValue>()};
+            std::vector<HeapCommand> commands{};
+            commands.reserve(creationCount);
+
+            for(uint32_t i{0}; i != creationCount; ++i)
+            {
+                commands.push_back(CreateCommand(value, 0));
+            }
+
+            for(HeapCommand& command : commands)
+            {
+                command.Execute();
+            }
+        };
+
+        BENCHMARK("Lambda Commands")
+        {
+            constexpr uint32_t creationCount{50'000};
+            std::shared_ptr<WorkingValue> value{std::make_shared<WorkingValue>()};
+            std::vector<Command> commands{};
+            commands.reserve(creationCount);
+
+            for(uint32_t i{0}; i != creationCount; ++i)
+            {
+                commands.push_back(CreateLambdaCommand(value, 0));
+            }
+
+            for(Command& command : commands)
+            {
+                command.Execute();
+            }
+        };
+
+        BENCHMARK("Directional Lambda Commands")
+        {
+            constexpr uint32_t creationCount{50'000};
+            std::shared_ptr<WorkingValue> value{std::make_shared<WorkingValue>()};
+            std::vector<Command> commands{};
+            commands.reserve(creationCount);
+
+            for(uint32_t i{0}; i != creationCount; ++i)
+            {
+                commands.push_back(CreateDirectionalLambdaCommand(value, 0));
+            }
+
+            for(Command& command : commands)
+            {
+                command.Execute();
+            }
+        };
+
         BENCHMARK("Benchmark")
         {
             constexpr uint32_t creationCount{50'000};
@@ -277,6 +559,86 @@ namespace ValueSemantics
         };
     }
 
+    TEST_CASE("Command Queue - Value Semantics - Coalescing Benchmark")
+    {
+        constexpr uint32_t traceLength{100'000};
+        constexpr uint32_t runLength{20};
+        std::shared_ptr<WorkingValue> value{std::make_shared<WorkingValue>()};
+        std::shared_ptr<WorkingValue> otherValue{std::make_shared<WorkingValue>()};
+
+        // Synthetic input trace, a +1 per tick in runs of runLength ticks alternating between two values
+        const auto queueTrace{
+            [&](CommandQueue& queue, const bool executeEachTick)
+            {
+                for(uint32_t i{0}; i != traceLength; ++i)
+                {
+                    queue.QueueCommand(CreateCommand((i / runLength) % 2 == 0 ? value : otherValue, 1));
+                    if(executeEachTick && queue.HasPendingCommand())
+                        queue.ExecuteCommand();
+                }
+            }};
+
+        {
+            CommandQueue uncoalesced{};
+            CommandQueue pendingOnly{};
+            CommandQueue acrossCursor{};
+            pendingOnly.SetCoalescePolicy(CoalescePolicy::PendingOnly);
+            acrossCursor.SetCoalescePolicy(CoalescePolicy::AcrossCursor);
+
+            queueTrace(uncoalesced, false);
+            queueTrace(pendingOnly, false);
+            queueTrace(acrossCursor, true);
+
+            // 20:1 compression, one entry per run
+            REQUIRE(uncoalesced.GetCommandQueueSize() == traceLength);
+            REQUIRE(pendingOnly.GetCommandQueueSize() == traceLength / runLength);
+            REQUIRE(acrossCursor.GetCommandQueueSize() == traceLength / runLength);
+
+            uncoalesced.ExecuteAll();
+            pendingOnly.ExecuteAll();
+            REQUIRE(value->GetValue() == 3 * traceLength / 2);
+            REQUIRE(otherValue->GetValue() == 3 * traceLength / 2);
+
+            uncoalesced.RollbackTo(0);
+            pendingOnly.RollbackTo(0);
+            acrossCursor.RollbackTo(0);
+            REQUIRE(value->GetValue() == 0);
+            REQUIRE(otherValue->GetValue() == 0);
+        }
+
+        BENCHMARK("Uncoalesced Replay")
+        {
+            CommandQueue queue{};
+            queueTrace(queue, false);
+            queue.ExecuteAll();
+            queue.RollbackTo(0);
+        };
+
+        BENCHMARK("Coalesced Replay")
+        {
+            CommandQueue queue{};
+            queue.SetCoalescePolicy(CoalescePolicy::PendingOnly);
+            queueTrace(queue, false);
+            queue.ExecuteAll();
+            queue.RollbackTo(0);
+        };
+
+        BENCHMARK("Uncoalesced Execute Each Tick")
+        {
+            CommandQueue queue{};
+            queueTrace(queue, true);
+            queue.RollbackTo(0);
+        };
+
+        BENCHMARK("Coalesced Execute Each Tick")
+        {
+            CommandQueue queue{};
+            queue.SetCoalescePolicy(CoalescePolicy::AcrossCursor);
+            queueTrace(queue, true);
+            queue.RollbackTo(0);
+        };
+    }
+
     TEST_CASE("Command Queue - Value Semantics - Execute/Rollback Benchmark")
     {
         constexpr uint32_t creationCount{50'000};
@@ -301,5 +663,11 @@ namespace ValueSemantics
                 queue.RollbackCommand();
             }
         };
+
+        BENCHMARK("Bulk")
+        {
+            queue.ExecuteAll();
+            queue.RollbackTo(0);
+        };
     }
 }
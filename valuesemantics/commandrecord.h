@@ -0,0 +1,21 @@
+#pragma once
+
+#include <cstdint>
+
+namespace ValueSemantics
+{
+    /// Ids of the command types which can be serialized, None marks an empty record.
+    enum class CommandTypeId : uint16_t
+    {
+        None,
+        ModifyValue
+    };
+
+    /// Compact serialized form of a command, the meaning of the payload depends on the command type.
+    struct CommandRecord
+    {
+        CommandTypeId m_TypeId{CommandTypeId::None};
+        uint32_t m_TargetId{0};
+        uint32_t m_Payload{0};
+    };
+}
@@ -1,9 +1,15 @@
 #pragma once
 
 #include <memory>
+#include <optional>
 #include <functional>
+#include <utility>
 
+#include "valuesemantics/commandrecord.h"
+#include "commandaccess.h"
+#include "targetregistry.h"
 #include "workingvalue.h"
+#include "workingvaluestore.h"
 
 namespace ValueSemantics
 {
@@ -25,11 +31,113 @@ namespace ValueSemantics
         {
             m_Value->ModifyValue(-m_Modification);
         }
+
+        /// Sums next's modification into this command when both modify the same value
+        /// and WorkingValue::CanMerge() allows it.
+        bool TryMerge(const ModifyValueCommand& next)
+        {
+            if(next.m_Value != m_Value || !WorkingValue::CanMerge(m_Modification, next.m_Modification))
+                return false;
+
+            m_Modification += next.m_Modification;
+            return true;
+        }
+
+        void DeclareAccess(CommandAccess& access) const
+        {
+            access.Write(m_Value.get());
+        }
+
+        [[nodiscard]] bool IsNoOp() const
+        {
+            return m_Modification == 0;
+        }
+
+        [[nodiscard]] const void* GetTargetKey() const
+        {
+            return m_Value.get();
+        }
+
+        /// Returns false when the value isn't registered.
+        bool Serialize(const TargetRegistry& registry, CommandRecord& record) const
+        {
+            const std::optional<uint32_t> targetId{registry.FindId(m_Value.get())};
+            if(!targetId)
+                return false;
+
+            record.m_TypeId = CommandTypeId::ModifyValue;
+            record.m_TargetId = *targetId;
+            record.m_Payload = static_cast<uint32_t>(m_Modification);
+            return true;
+        }
     private:
         std::shared_ptr<WorkingValue> m_Value{};
         WorkingValue::ValueType m_Modification{};
     };
 
+    /// ModifyValueCommand targeting a value of WorkingValueStore::GetShared() by handle, 8 bytes with no reference count.
+    /// The store is hard-wired: a store pointer would double the command to 16 bytes, so handles always resolve against
+    /// the shared store and values of any other WorkingValueStore can't be targeted.
+    /// Executing or rolling back once the value has been destroyed does nothing but report the stale handle
+    /// through WorkingValueStore::Resolve(), check IsValid() first to avoid that.
+    class ModifyStoredValueCommand
+    {
+    public:
+        ModifyStoredValueCommand(const WorkingValueHandle value, const int32_t valueModification)
+            : m_Value{value}
+            , m_Modification{valueModification}
+        {
+        }
+
+        void Execute()
+        {
+            if(WorkingValue* const value{WorkingValueStore::GetShared().Resolve(m_Value)})
+                value->ModifyValue(m_Modification);
+        }
+
+        void Rollback()
+        {
+            if(WorkingValue* const value{WorkingValueStore::GetShared().Resolve(m_Value)})
+                value->ModifyValue(-m_Modification);
+        }
+
+        /// False once the value has been destroyed.
+        [[nodiscard]] bool IsValid() const
+        {
+            return WorkingValueStore::GetShared().Contains(m_Value);
+        }
+
+        /// Sums next's modification into this command when both modify the same value
+        /// and WorkingValue::CanMerge() allows it.
+        bool TryMerge(const ModifyStoredValueCommand& next)
+        {
+            if(next.m_Value != m_Value || !WorkingValue::CanMerge(m_Modification, next.m_Modification))
+                return false;
+
+            m_Modification += next.m_Modification;
+            return true;
+        }
+
+        void DeclareAccess(CommandAccess& access) const
+        {
+            access.Write(WorkingValueStore::GetShared().Find(m_Value));
+        }
+
+        [[nodiscard]] bool IsNoOp() const
+        {
+            return m_Modification == 0;
+        }
+
+        /// nullptr once the value has been destroyed.
+        [[nodiscard]] const void* GetTargetKey() const
+        {
+            return WorkingValueStore::GetShared().Find(m_Value);
+        }
+    private:
+        WorkingValueHandle m_Value{};
+        WorkingValue::ValueType m_Modification{};
+    };
+
     class LambdaCommand
     {
     public:
@@ -54,4 +162,35 @@ namespace ValueSemantics
         FunctionSignature m_Execute{};
         FunctionSignature m_Rollback{};
     };
+
+    enum class Direction
+    {
+        Execute,
+        Rollback
+    };
+
+    /// Runs execute and rollback through a single callable taking the Direction to run,
+    /// so any state it captures is shared by both. TFunction is stored inline, Command requires it to be
+    /// copyable while PackedCommandQueue only requires it to be movable.
+    template<class TFunction>
+    class DirectionalLambdaCommand
+    {
+    public:
+        explicit DirectionalLambdaCommand(TFunction&& function)
+            : m_Function{std::move(function)}
+        {
+        }
+
+        void Execute()
+        {
+            m_Function(Direction::Execute);
+        }
+
+        void Rollback()
+        {
+            m_Function(Direction::Rollback);
+        }
+    private:
+        TFunction m_Function;
+    };
 }
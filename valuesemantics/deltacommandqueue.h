@@ -0,0 +1,192 @@
+#pragma once
+
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include "workingvalue.h"
+
+namespace ValueSemantics
+{
+    /// Command queue specialized for adding a delta to a value, the command ModifyValueCommand models.
+    /// Commands are stored as two parallel arrays of target index and delta, so executing or rolling back a range
+    /// is a loop of indexed adds with no per-command dispatch, pointer chase or reference count.
+    /// Deltas commute, so every full block of BlockCommandCount commands also keeps its runs of commands sharing a
+    /// target summed into one delta, and a range applies the runs of the blocks it covers rather than each command.
+    /// A run is split wherever WorkingValue::CanMerge() refuses its sum, so applying and negating runs stays in range
+    /// whenever applying the commands one by one does.
+    /// Follows the cursor semantics of CommandQueue.
+    class DeltaCommandQueue
+    {
+    public:
+        /// Commands target values by their index within values, which has to outlive the queue.
+        explicit DeltaCommandQueue(const std::span<WorkingValue> values)
+            : m_Values{values}
+        {
+        }
+
+        /// HasPendingCommand() has to be true before calling
+        void ExecuteCommand()
+        {
+            ExecuteN(1);
+        }
+
+        /// HasPendingRollbackCommand() has to be true before calling
+        void RollbackCommand()
+        {
+            RollbackTo(m_CommandIndex - 1);
+        }
+
+        /// Executes every pending command.
+        void ExecuteAll()
+        {
+            ExecuteN(GetCommandQueueSize() - m_CommandIndex);
+        }
+
+        /// count has to be no greater than the number of pending commands
+        void ExecuteN(const uint32_t count)
+        {
+            Apply(m_CommandIndex, m_CommandIndex + count, 1);
+            m_CommandIndex += count;
+        }
+
+        /// Rolls back commands until GetCommandIndex() == index.
+        /// index has to be no greater than GetCommandIndex()
+        void RollbackTo(const uint32_t index)
+        {
+            Apply(index, m_CommandIndex, -1);
+            m_CommandIndex = index;
+        }
+
+        /// Executes or rolls back commands until GetCommandIndex() == index.
+        /// index has to be no greater than GetCommandQueueSize()
+        void SeekTo(const uint32_t index)
+        {
+            if(index > m_CommandIndex)
+                ExecuteN(index - m_CommandIndex);
+            else
+                RollbackTo(index);
+        }
+
+        void ClearQueue()
+        {
+            m_Targets.clear();
+            m_Deltas.clear();
+            m_RunTargets.clear();
+            m_RunDeltas.clear();
+            m_BlockRunEnds.clear();
+            m_CommandIndex = 0;
+        }
+
+        /// Removes any commands ahead of and including the current pending command.
+        /// HasPendingCommand() has to be true before calling
+        void ClearPendingCommands()
+        {
+            m_Targets.resize(m_CommandIndex);
+            m_Deltas.resize(m_CommandIndex);
+
+            const uint32_t blockCount{m_CommandIndex / BlockCommandCount};
+            if(blockCount < m_BlockRunEnds.size())
+            {
+                m_BlockRunEnds.resize(blockCount);
+                m_RunTargets.resize(GetRunBegin(blockCount));
+                m_RunDeltas.resize(GetRunBegin(blockCount));
+            }
+        }
+
+        [[nodiscard]] bool HasPendingCommand() const
+        {
+            return GetCommandQueueSize() > m_CommandIndex;
+        }
+
+        [[nodiscard]] bool HasPendingRollbackCommand() const
+        {
+            return m_CommandIndex != 0 && GetCommandQueueSize() >= m_CommandIndex;
+        }
+
+        /// Queues adding delta to the value at target.
+        /// target has to be less than the number of values and delta greater than the minimum ValueType before calling
+        void QueueCommand(const uint32_t target, const WorkingValue::ValueType delta)
+        {
+            m_Targets.push_back(target);
+            m_Deltas.push_back(delta);
+
+            if(m_Targets.size() % BlockCommandCount == 0)
+                SumBlockRuns();
+        }
+
+        [[nodiscard]] uint32_t GetCommandIndex() const
+        {
+            return m_CommandIndex;
+        }
+
+        [[nodiscard]] uint32_t GetCommandQueueSize() const
+        {
+            return static_cast<uint32_t>(m_Targets.size());
+        }
+    private:
+        static constexpr uint32_t BlockCommandCount{64};
+
+        /// First run of block within the run arrays.
+        [[nodiscard]] uint32_t GetRunBegin(const uint32_t block) const
+        {
+            return block == 0 ? 0 : m_BlockRunEnds[block - 1];
+        }
+
+        /// Sums the runs of the last block, which has just been filled.
+        void SumBlockRuns()
+        {
+            const uint32_t end{GetCommandQueueSize()};
+            for(uint32_t index{end - BlockCommandCount}; index != end; ++index)
+            {
+                if(m_RunTargets.size() != GetRunBegin(static_cast<uint32_t>(m_BlockRunEnds.size()))
+                    && m_RunTargets.back() == m_Targets[index] && WorkingValue::CanMerge(m_RunDeltas.back(), m_Deltas[index]))
+                {
+                    m_RunDeltas.back() += m_Deltas[index];
+                }
+                else
+                {
+                    m_RunTargets.push_back(m_Targets[index]);
+                    m_RunDeltas.push_back(m_Deltas[index]);
+                }
+            }
+            m_BlockRunEnds.push_back(static_cast<uint32_t>(m_RunTargets.size()));
+        }
+
+        /// Adds sign times the deltas of the commands [begin, end), the blocks fully within the range through their runs.
+        void Apply(const uint32_t begin, const uint32_t end, const WorkingValue::ValueType sign)
+        {
+            const uint32_t firstBlock{(begin + BlockCommandCount - 1) / BlockCommandCount};
+            const uint32_t lastBlock{end / BlockCommandCount};
+            if(firstBlock >= lastBlock)
+            {
+                Apply(m_Targets.data(), m_Deltas.data(), begin, end, sign);
+                return;
+            }
+
+            Apply(m_Targets.data(), m_Deltas.data(), begin, firstBlock * BlockCommandCount, sign);
+            Apply(m_RunTargets.data(), m_RunDeltas.data(), GetRunBegin(firstBlock), GetRunBegin(lastBlock), sign);
+            Apply(m_Targets.data(), m_Deltas.data(), lastBlock * BlockCommandCount, end, sign);
+        }
+
+        void Apply(const uint32_t* const targets, const WorkingValue::ValueType* const deltas,
+            const uint32_t begin, const uint32_t end, const WorkingValue::ValueType sign)
+        {
+            WorkingValue* const values{m_Values.data()};
+            for(uint32_t index{begin}; index != end; ++index)
+            {
+                values[targets[index]].ModifyValue(sign * deltas[index]);
+            }
+        }
+
+        std::span<WorkingValue> m_Values{};
+        std::vector<uint32_t> m_Targets{};
+        std::vector<WorkingValue::ValueType> m_Deltas{};
+        /// Runs of consecutive commands sharing a target within each full block, with their deltas summed.
+        std::vector<uint32_t> m_RunTargets{};
+        std::vector<WorkingValue::ValueType> m_RunDeltas{};
+        /// End of each full block's runs within the run arrays.
+        std::vector<uint32_t> m_BlockRunEnds{};
+        uint32_t m_CommandIndex{0};
+    };
+}
@@ -0,0 +1,173 @@
+#pragma once
+
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/benchmark/catch_benchmark.hpp>
+
+#include <array>
+#include <limits>
+
+#include "valuesemantics/commandqueueexamples.h"
+#include "valuesemantics/deltacommandqueue.h"
+#include "workingvalue.h"
+
+namespace ValueSemantics
+{
+    TEST_CASE("Delta Command Queue - Value Semantics - Unit Tests")
+    {
+        std::vector<WorkingValue> values(3);
+        DeltaCommandQueue queue{values};
+        REQUIRE_FALSE(queue.HasPendingCommand());
+        REQUIRE_FALSE(queue.HasPendingRollbackCommand());
+
+        queue.QueueCommand(0, 1);
+        queue.QueueCommand(1, 2);
+        queue.QueueCommand(0, 4);
+        queue.QueueCommand(2, 8);
+        REQUIRE(queue.GetCommandQueueSize() == 4);
+        REQUIRE(values[0].GetValue() == 0);
+
+        SECTION("Execute And Rollback")
+        {
+            queue.ExecuteCommand(); // values[0] + 1
+            REQUIRE(values[0].GetValue() == 1);
+            queue.ExecuteN(2); // values[1] + 2, values[0] + 4
+            REQUIRE(values[0].GetValue() == 5);
+            REQUIRE(values[1].GetValue() == 2);
+
+            queue.RollbackCommand(); // values[0] - 4
+            REQUIRE(values[0].GetValue() == 1);
+
+            queue.ExecuteAll();
+            REQUIRE(values[0].GetValue() == 5);
+            REQUIRE(values[2].GetValue() == 8);
+            REQUIRE_FALSE(queue.HasPendingCommand());
+
+            queue.SeekTo(1);
+            REQUIRE(values[0].GetValue() == 1);
+            REQUIRE(values[1].GetValue() == 0);
+            REQUIRE(values[2].GetValue() == 0);
+            queue.RollbackTo(0);
+            REQUIRE(values[0].GetValue() == 0);
+        }
+
+        SECTION("Clear Pending Commands")
+        {
+            queue.ExecuteN(2);
+            queue.ClearPendingCommands();
+            REQUIRE(queue.GetCommandQueueSize() == 2);
+
+            queue.QueueCommand(2, 16);
+            queue.ExecuteAll();
+            REQUIRE(values[0].GetValue() == 1);
+            REQUIRE(values[1].GetValue() == 2);
+            REQUIRE(values[2].GetValue() == 16);
+        }
+
+        SECTION("Seek Across Blocks")
+        {
+            // Runs of a target, spanning and splitting the summed blocks
+            queue.ClearQueue();
+            for(uint32_t i{0}; i != 1'000; ++i)
+            {
+                queue.QueueCommand((i / 10) % 3, static_cast<int32_t>(i));
+            }
+
+            const auto requireValuesAt{[&values](const uint32_t index)
+                {
+                    std::array<int32_t, 3> expected{};
+                    for(uint32_t i{0}; i != index; ++i)
+                    {
+                        expected[(i / 10) % 3] += static_cast<int32_t>(i);
+                    }
+                    for(uint32_t target{0}; target != 3; ++target)
+                    {
+                        REQUIRE(values[target].GetValue() == expected[target]);
+                    }
+                }};
+
+            for(const uint32_t index : {1'000u, 3u, 64u, 65u, 700u, 127u, 128u, 0u, 999u, 5u})
+            {
+                queue.SeekTo(index);
+                requireValuesAt(index);
+            }
+
+            queue.SeekTo(300);
+            queue.ClearPendingCommands(); // Drops the summed blocks past the cursor
+            queue.QueueCommand(0, 1'000'000);
+            queue.ExecuteAll();
+            queue.RollbackTo(130);
+            requireValuesAt(130);
+        }
+
+        SECTION("Runs Without Overflow")
+        {
+            // Applied one by one every command stays in range, summed the runs of values[0] and values[1] wouldn't
+            constexpr int32_t maxValue{std::numeric_limits<int32_t>::max()};
+            queue.ClearQueue();
+            values[0].SetValue(-maxValue);
+            values[1].SetValue(maxValue);
+            for(uint32_t i{0}; i != 32; ++i)
+            {
+                queue.QueueCommand(0, i < 2 ? maxValue : 0); // Sums to 2 * maxValue
+            }
+            for(uint32_t i{0}; i != 32; ++i)
+            {
+                queue.QueueCommand(1, i == 0 ? -maxValue : (i == 1 ? -1 : 0)); // Sums to the minimum, can't be negated
+            }
+            REQUIRE(queue.GetCommandQueueSize() == 64);
+
+            queue.ExecuteAll();
+            REQUIRE(values[0].GetValue() == maxValue);
+            REQUIRE(values[1].GetValue() == -1);
+
+            queue.RollbackTo(0);
+            REQUIRE(values[0].GetValue() == -maxValue);
+            REQUIRE(values[1].GetValue() == maxValue);
+        }
+
+        SECTION("Clear Queue")
+        {
+            queue.ExecuteAll();
+            queue.ClearQueue();
+            REQUIRE(queue.GetCommandQueueSize() == 0);
+            REQUIRE(queue.GetCommandIndex() == 0);
+            REQUIRE(values[0].GetValue() == 5);
+        }
+    }
+
+    TEST_CASE("Delta Command Queue - Value Semantics - Benchmark")
+    {
+        constexpr uint32_t commandCount{100'000};
+        constexpr uint32_t valueCount{1'024};
+
+        std::shared_ptr<WorkingValue> value{std::make_shared<WorkingValue>()};
+        CommandQueue commandQueue{};
+        std::vector<WorkingValue> values(valueCount);
+        DeltaCommandQueue deltaQueue{values};
+        DeltaCommandQueue spreadDeltaQueue{values};
+        for(uint32_t i{0}; i != commandCount; ++i)
+        {
+            commandQueue.QueueCommand(CreateCommand(value, 1));
+            deltaQueue.QueueCommand(0, 1);
+            spreadDeltaQueue.QueueCommand((i * 7) % valueCount, 1);
+        }
+
+        BENCHMARK("ModifyValueCommand")
+        {
+            commandQueue.ExecuteAll();
+            commandQueue.RollbackTo(0);
+        };
+
+        BENCHMARK("Delta Single Target")
+        {
+            deltaQueue.ExecuteAll();
+            deltaQueue.RollbackTo(0);
+        };
+
+        BENCHMARK("Delta Spread Targets")
+        {
+            spreadDeltaQueue.ExecuteAll();
+            spreadDeltaQueue.RollbackTo(0);
+        };
+    }
+}
@@ -0,0 +1,173 @@
+#pragma once
+
+#include <algorithm>
+#include <concepts>
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <utility>
+
+#include "valuesemantics/commandjournal.h"
+#include "valuesemantics/commandqueue.h"
+#include "valuesemantics/commandrecord.h"
+#include "targetregistry.h"
+
+namespace ValueSemantics
+{
+    /// Command queue which writes every queued command and its command index to a CommandJournal,
+    /// so the session can be recovered after a crash or reloaded for debugging.
+    /// Only commands with a Serialize(const TCommand&, const TargetRegistry&, CommandRecord&) overload can be queued.
+    class JournaledCommandQueue
+    {
+    public:
+        /// registry has to outlive the queue.
+        explicit JournaledCommandQueue(const TargetRegistry& registry,
+            const std::size_t flushInterval = CommandJournal::DefaultFlushInterval)
+            : m_Registry{&registry}
+            , m_Journal{flushInterval}
+        {
+        }
+
+        /// Opens the journal at path, creating it when missing, and rebuilds the queue from the commands in it.
+        /// The commands before the journaled command index are executed again to restore the state of their targets,
+        /// which have to be in the state they were in when the journal was created.
+        /// Recovery stops at the first torn or corrupt record, which CommandJournal discards.
+        /// Returns false when the journal can't be opened, or, leaving the journal closed and its file untouched,
+        /// when a record's target isn't registered.
+        [[nodiscard]] bool Open(const std::filesystem::path& path)
+        {
+            m_CommandQueue.ClearQueue();
+            if(!m_Journal.Open(path))
+                return false;
+
+            const uint32_t recordCount{m_Journal.GetRecordCount()};
+            for(uint32_t index{0}; index != recordCount; ++index)
+            {
+                std::optional<Command> command{DeserializeCommand(m_Journal.GetRecord(index), *m_Registry)};
+                if(!command)
+                {
+                    // A registry missing targets is a setup mistake, the record is valid and has to be kept
+                    m_CommandQueue.ClearQueue();
+                    m_Journal.Close();
+                    return false;
+                }
+                m_CommandQueue.QueueCommand(std::move(*command));
+            }
+
+            m_CommandQueue.ExecuteN(std::min(m_Journal.GetCommandIndex(), m_CommandQueue.GetCommandQueueSize()));
+            m_Journal.SetCommandIndex(m_CommandQueue.GetCommandIndex());
+            return true;
+        }
+
+        /// Flushes and closes the journal, the queue keeps its commands. From then on, as after QueueCommand() fails to
+        /// grow the journal, the queue is no longer journaled: moving the cursor and clearing commands still work,
+        /// queueing commands fails.
+        void Close()
+        {
+            m_Journal.Close();
+        }
+
+        /// Writes every change back to the journal file and waits for it to reach the disk.
+        void Flush()
+        {
+            m_Journal.Flush();
+        }
+
+        /// HasPendingCommand() has to be true before calling
+        void ExecuteCommand()
+        {
+            m_CommandQueue.ExecuteCommand();
+            m_Journal.SetCommandIndex(m_CommandQueue.GetCommandIndex());
+        }
+
+        /// HasPendingRollbackCommand() has to be true before calling
+        void RollbackCommand()
+        {
+            m_CommandQueue.RollbackCommand();
+            m_Journal.SetCommandIndex(m_CommandQueue.GetCommandIndex());
+        }
+
+        /// Executes every pending command.
+        void ExecuteAll()
+        {
+            m_CommandQueue.ExecuteAll();
+            m_Journal.SetCommandIndex(m_CommandQueue.GetCommandIndex());
+        }
+
+        /// count has to be no greater than the number of pending commands
+        void ExecuteN(const uint32_t count)
+        {
+            m_CommandQueue.ExecuteN(count);
+            m_Journal.SetCommandIndex(m_CommandQueue.GetCommandIndex());
+        }
+
+        /// Rolls back commands until GetCommandIndex() == index.
+        /// index has to be no greater than GetCommandIndex()
+        void RollbackTo(const uint32_t index)
+        {
+            m_CommandQueue.RollbackTo(index);
+            m_Journal.SetCommandIndex(m_CommandQueue.GetCommandIndex());
+        }
+
+        /// Executes or rolls back commands until GetCommandIndex() == index.
+        /// index has to be no greater than GetCommandQueueSize()
+        void SeekTo(const uint32_t index)
+        {
+            m_CommandQueue.SeekTo(index);
+            m_Journal.SetCommandIndex(m_CommandQueue.GetCommandIndex());
+        }
+
+        void ClearQueue()
+        {
+            m_CommandQueue.ClearQueue();
+            m_Journal.Truncate(0);
+            m_Journal.SetCommandIndex(0);
+        }
+
+        /// Removes any commands ahead of and including the current pending command.
+        /// HasPendingCommand() has to be true before calling
+        void ClearPendingCommands()
+        {
+            m_CommandQueue.ClearPendingCommands();
+            m_Journal.Truncate(m_CommandQueue.GetCommandQueueSize());
+        }
+
+        [[nodiscard]] bool HasPendingCommand() const
+        {
+            return m_CommandQueue.HasPendingCommand();
+        }
+
+        [[nodiscard]] bool HasPendingRollbackCommand() const
+        {
+            return m_CommandQueue.HasPendingRollbackCommand();
+        }
+
+        /// Returns false, without queueing the command, when it can't be serialized or written to the journal.
+        template<class TCommand>
+            requires requires(const TCommand& command, const TargetRegistry& registry, CommandRecord& record)
+                { { ValueSemantics::Serialize(command, registry, record) } -> std::same_as<bool>; }
+        bool QueueCommand(TCommand&& command)
+        {
+            CommandRecord record{};
+            if(!ValueSemantics::Serialize(command, *m_Registry, record) || !m_Journal.Append(record))
+                return false;
+
+            m_CommandQueue.QueueCommand(std::forward<TCommand>(command));
+            return true;
+        }
+
+        [[nodiscard]] uint32_t GetCommandIndex() const
+        {
+            return m_CommandQueue.GetCommandIndex();
+        }
+
+        [[nodiscard]] uint32_t GetCommandQueueSize() const
+        {
+            return m_CommandQueue.GetCommandQueueSize();
+        }
+    private:
+        const TargetRegistry* m_Registry{nullptr};
+        CommandJournal m_Journal;
+        CommandQueue m_CommandQueue{};
+    };
+}
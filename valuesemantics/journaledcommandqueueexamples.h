@@ -0,0 +1,281 @@
+#pragma once
+
+#include <filesystem>
+#include <fstream>
+
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/benchmark/catch_benchmark.hpp>
+
+#include "valuesemantics/commandjournal.h"
+#include "valuesemantics/commandqueueexamples.h"
+#include "valuesemantics/journaledcommandqueue.h"
+#include "targetregistry.h"
+#include "workingvalue.h"
+
+namespace ValueSemantics
+{
+    namespace
+    {
+        /// Removes the file at path when created and destroyed.
+        class TemporaryFile
+        {
+        public:
+            explicit TemporaryFile(const char* const name)
+                : m_Path{std::filesystem::temp_directory_path() / name}
+            {
+                std::filesystem::remove(m_Path);
+            }
+
+            ~TemporaryFile()
+            {
+                std::error_code error{};
+                std::filesystem::remove(m_Path, error);
+            }
+
+            [[nodiscard]] const std::filesystem::path& GetPath() const
+            {
+                return m_Path;
+            }
+        private:
+            std::filesystem::path m_Path{};
+        };
+
+        /// Overwrites bytes of the file at path, as a crash partway through writing them would.
+        static void OverwriteFile(const std::filesystem::path& path, const std::size_t offset, const std::size_t size, const char byte)
+        {
+            std::fstream file{path, std::ios::in | std::ios::out | std::ios::binary};
+            file.seekp(static_cast<std::streamoff>(offset));
+            for(std::size_t i{0}; i != size; ++i)
+            {
+                file.put(byte);
+            }
+        }
+
+        [[nodiscard]] static std::size_t GetJournalRecordOffset(const uint32_t index)
+        {
+            return CommandJournal::HeaderSize + index * CommandJournal::RecordSize;
+        }
+    }
+
+    TEST_CASE("Journaled Command Queue - Value Semantics - Unit Tests")
+    {
+        const TemporaryFile journalFile{"command-pattern-journal-test.bin"};
+        std::shared_ptr<WorkingValue> value{std::make_shared<WorkingValue>()};
+        std::shared_ptr<WorkingValue> otherValue{std::make_shared<WorkingValue>()};
+        TargetRegistry registry{};
+        registry.Register(1, value);
+        registry.Register(2, otherValue);
+
+        {
+            JournaledCommandQueue queue{registry};
+            REQUIRE(queue.Open(journalFile.GetPath()));
+            REQUIRE(queue.GetCommandQueueSize() == 0);
+
+            for(int32_t i{1}; i != 11; ++i)
+            {
+                REQUIRE(queue.QueueCommand(CreateCommand(i % 2 == 0 ? value : otherValue, i)));
+            }
+            REQUIRE_FALSE(queue.QueueCommand(CreateCommand(std::make_shared<WorkingValue>(), 100)));
+            REQUIRE(queue.GetCommandQueueSize() == 10);
+
+            queue.ExecuteN(6); // +1 ... +6
+            REQUIRE(value->GetValue() == 12);
+            REQUIRE(otherValue->GetValue() == 9);
+        }
+
+        // A new session starts from the state the targets were in when the journal was created
+        value->SetValue(0);
+        otherValue->SetValue(0);
+
+        SECTION("Recover Queue And Command Index")
+        {
+            JournaledCommandQueue queue{registry};
+            REQUIRE(queue.Open(journalFile.GetPath()));
+            REQUIRE(queue.GetCommandQueueSize() == 10);
+            REQUIRE(queue.GetCommandIndex() == 6);
+            REQUIRE(value->GetValue() == 12);
+            REQUIRE(otherValue->GetValue() == 9);
+
+            queue.ExecuteAll(); // +7 ... +10
+            REQUIRE(value->GetValue() == 30);
+            REQUIRE(otherValue->GetValue() == 25);
+
+            queue.RollbackTo(0);
+            REQUIRE(value->GetValue() == 0);
+            REQUIRE(otherValue->GetValue() == 0);
+        }
+
+        SECTION("Recover Torn Tail")
+        {
+            OverwriteFile(journalFile.GetPath(), GetJournalRecordOffset(9) + 8, 8, 0); // Half written +10
+
+            JournaledCommandQueue queue{registry};
+            REQUIRE(queue.Open(journalFile.GetPath()));
+            REQUIRE(queue.GetCommandQueueSize() == 9);
+            REQUIRE(queue.GetCommandIndex() == 6);
+            REQUIRE(value->GetValue() == 12);
+
+            REQUIRE(queue.QueueCommand(CreateCommand(value, 100)));
+            queue.ExecuteAll(); // +7, +8, +9, +100
+            REQUIRE(value->GetValue() == 120);
+            REQUIRE(otherValue->GetValue() == 25);
+        }
+
+        SECTION("Recover Corrupt Record Before Command Index")
+        {
+            OverwriteFile(journalFile.GetPath(), GetJournalRecordOffset(3), 1, 'x'); // Corrupt +4
+
+            JournaledCommandQueue queue{registry};
+            REQUIRE(queue.Open(journalFile.GetPath()));
+            REQUIRE(queue.GetCommandQueueSize() == 3);
+            REQUIRE(queue.GetCommandIndex() == 3);
+            REQUIRE(value->GetValue() == 2);
+            REQUIRE(otherValue->GetValue() == 4);
+        }
+
+        SECTION("Recover Cleared Commands")
+        {
+            {
+                JournaledCommandQueue queue{registry};
+                REQUIRE(queue.Open(journalFile.GetPath()));
+                queue.RollbackTo(4); // -6, -5
+                queue.ClearPendingCommands(); // Remove +5 ... +10
+                REQUIRE(queue.QueueCommand(CreateCommand(value, 100)));
+            }
+
+            value->SetValue(0);
+            otherValue->SetValue(0);
+
+            JournaledCommandQueue queue{registry};
+            REQUIRE(queue.Open(journalFile.GetPath()));
+            REQUIRE(queue.GetCommandQueueSize() == 5);
+            REQUIRE(queue.GetCommandIndex() == 4);
+
+            queue.ExecuteAll(); // +100
+            REQUIRE(value->GetValue() == 106);
+            REQUIRE(otherValue->GetValue() == 4);
+        }
+
+        SECTION("Reject Unregistered Target")
+        {
+            {
+                TargetRegistry partialRegistry{};
+                partialRegistry.Register(2, otherValue);
+
+                JournaledCommandQueue queue{partialRegistry};
+                REQUIRE_FALSE(queue.Open(journalFile.GetPath()));
+                REQUIRE(queue.GetCommandQueueSize() == 0);
+                REQUIRE(otherValue->GetValue() == 0);
+            }
+
+            // The history is still whole once every target is registered
+            JournaledCommandQueue queue{registry};
+            REQUIRE(queue.Open(journalFile.GetPath()));
+            REQUIRE(queue.GetCommandQueueSize() == 10);
+            REQUIRE(queue.GetCommandIndex() == 6);
+            REQUIRE(value->GetValue() == 12);
+            REQUIRE(otherValue->GetValue() == 9);
+        }
+
+        SECTION("Use Queue After Close")
+        {
+            JournaledCommandQueue queue{registry};
+            REQUIRE(queue.Open(journalFile.GetPath()));
+            queue.Close();
+
+            REQUIRE(queue.GetCommandQueueSize() == 10);
+            queue.ExecuteCommand(); // +7
+            queue.RollbackTo(4); // -7, -6, -5
+            REQUIRE(value->GetValue() == 6);
+            REQUIRE(otherValue->GetValue() == 4);
+            queue.Flush();
+
+            queue.ClearPendingCommands();
+            REQUIRE(queue.GetCommandQueueSize() == 4);
+            REQUIRE_FALSE(queue.QueueCommand(CreateCommand(value, 100))); // Not journaled
+            REQUIRE(queue.GetCommandQueueSize() == 4);
+            queue.ClearQueue();
+            REQUIRE(queue.GetCommandQueueSize() == 0);
+
+            // The journal still holds the session as it was when closed
+            JournaledCommandQueue reopenedQueue{registry};
+            REQUIRE(reopenedQueue.Open(journalFile.GetPath()));
+            REQUIRE(reopenedQueue.GetCommandQueueSize() == 10);
+            REQUIRE(reopenedQueue.GetCommandIndex() == 6);
+        }
+
+        SECTION("Reject Other Files")
+        {
+            OverwriteFile(journalFile.GetPath(), 0, 8, 'x');
+
+            JournaledCommandQueue queue{registry};
+            REQUIRE_FALSE(queue.Open(journalFile.GetPath()));
+        }
+    }
+
+    TEST_CASE("Journaled Command Queue - Value Semantics - Execute Benchmark")
+    {
+        constexpr uint32_t commandCount{100'000};
+        const TemporaryFile journalFile{"command-pattern-journal-benchmark.bin"};
+        std::shared_ptr<WorkingValue> value{std::make_shared<WorkingValue>()};
+        TargetRegistry registry{};
+        registry.Register(1, value);
+
+        CommandQueue queue{};
+        JournaledCommandQueue journaledQueue{registry};
+        REQUIRE(journaledQueue.Open(journalFile.GetPath()));
+
+        for(uint32_t i{0}; i != commandCount; ++i)
+        {
+            queue.QueueCommand(CreateCommand(value, 1));
+            journaledQueue.QueueCommand(CreateCommand(value, 1));
+        }
+        REQUIRE(journaledQueue.GetCommandQueueSize() == commandCount);
+
+        BENCHMARK("Command Queue - Execute/Rollback")
+        {
+            while(queue.HasPendingCommand())
+            {
+                queue.ExecuteCommand();
+            }
+
+            while(queue.HasPendingRollbackCommand())
+            {
+                queue.RollbackCommand();
+            }
+        };
+
+        BENCHMARK("Journaled Command Queue - Execute/Rollback")
+        {
+            while(journaledQueue.HasPendingCommand())
+            {
+                journaledQueue.ExecuteCommand();
+            }
+
+            while(journaledQueue.HasPendingRollbackCommand())
+            {
+                journaledQueue.RollbackCommand();
+            }
+        };
+
+        BENCHMARK("Command Queue - Queue/Execute")
+        {
+            queue.ClearQueue();
+            for(uint32_t i{0}; i != commandCount; ++i)
+            {
+                queue.QueueCommand(CreateCommand(value, 1));
+            }
+            queue.ExecuteAll();
+        };
+
+        BENCHMARK("Journaled Command Queue - Queue/Execute")
+        {
+            journaledQueue.ClearQueue();
+            for(uint32_t i{0}; i != commandCount; ++i)
+            {
+                journaledQueue.QueueCommand(CreateCommand(value, 1));
+            }
+            journaledQueue.ExecuteAll();
+        };
+    }
+}
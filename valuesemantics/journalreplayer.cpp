@@ -0,0 +1,160 @@
+#include "valuesemantics/journalreplayer.h"
+#include "valuesemantics/commandjournal.h"
+
+#include <optional>
+#include <thread>
+
+namespace ValueSemantics
+{
+    JournalReplayer::JournalReplayer(const TargetRegistry& registry, const uint32_t chunkRecordCount, const uint32_t rollbackWindow)
+        : m_Registry{&registry}
+        , m_ChunkRecordCount{chunkRecordCount == 0 ? 1 : chunkRecordCount}
+    {
+        m_ChunkBuffer.resize(std::size_t{m_ChunkRecordCount} * CommandJournal::RecordSize);
+        m_Chunk.reserve(m_ChunkRecordCount);
+        m_History.resize(rollbackWindow == 0 ? 1 : rollbackWindow);
+    }
+
+    bool JournalReplayer::Open(const std::filesystem::path& path)
+    {
+        m_File = std::ifstream{path, std::ios::binary};
+        m_Chunk.clear();
+        m_ChunkPosition = 0;
+        m_CommandIndex = 0;
+        m_HistoryEnd = 0;
+        m_HistoryCount = 0;
+        m_RecordsRead = 0;
+        m_EndOfJournal = true;
+
+        std::byte header[CommandJournal::HeaderSize]{};
+        if(!m_File.read(reinterpret_cast<char*>(header), sizeof(header)) || !CommandJournal::IsValidHeader(header))
+            return false;
+
+        m_EndOfJournal = false;
+        SetReplayRate(m_ReplayRate);
+        return true;
+    }
+
+    uint32_t JournalReplayer::ExecuteN(const uint32_t count)
+    {
+        uint32_t executed{0};
+        for(; executed != count; ++executed)
+        {
+            // Commands which were rolled back are executed again from the history
+            if(m_CommandIndex != m_HistoryEnd)
+            {
+                ExecuteRecord(m_History[m_CommandIndex % m_History.size()]);
+                ++m_CommandIndex;
+                continue;
+            }
+
+            if(m_ChunkPosition == m_Chunk.size())
+            {
+                WaitForReplayRate();
+                if(!ReadChunk())
+                    break;
+            }
+
+            const CommandRecord& record{m_Chunk[m_ChunkPosition]};
+            if(!ExecuteRecord(record))
+            {
+                m_EndOfJournal = true;
+                m_Chunk.clear();
+                m_ChunkPosition = 0;
+                break;
+            }
+
+            m_History[m_HistoryEnd % m_History.size()] = record;
+            ++m_HistoryEnd;
+            if(m_HistoryCount != m_History.size())
+                ++m_HistoryCount;
+
+            ++m_ChunkPosition;
+            ++m_CommandIndex;
+        }
+        return executed;
+    }
+
+    uint64_t JournalReplayer::ExecuteAll()
+    {
+        uint64_t executed{0};
+        for(uint32_t chunkExecuted{ExecuteN(m_ChunkRecordCount)}; chunkExecuted != 0; chunkExecuted = ExecuteN(m_ChunkRecordCount))
+        {
+            executed += chunkExecuted;
+        }
+        return executed;
+    }
+
+    uint32_t JournalReplayer::RollbackN(const uint32_t count)
+    {
+        uint32_t rolledBack{0};
+        for(; rolledBack != count && GetRollbackCount() != 0; ++rolledBack)
+        {
+            --m_CommandIndex;
+            RollbackRecord(m_History[m_CommandIndex % m_History.size()]);
+        }
+        return rolledBack;
+    }
+
+    void JournalReplayer::SetReplayRate(const uint32_t commandsPerSecond)
+    {
+        m_ReplayRate = commandsPerSecond;
+        m_ReplayStart = std::chrono::steady_clock::now();
+        m_ReplayStartIndex = m_RecordsRead;
+    }
+
+    bool JournalReplayer::ReadChunk()
+    {
+        m_Chunk.clear();
+        m_ChunkPosition = 0;
+        if(m_EndOfJournal)
+            return false;
+
+        m_File.read(reinterpret_cast<char*>(m_ChunkBuffer.data()), static_cast<std::streamsize>(m_ChunkBuffer.size()));
+        const std::size_t recordCount{static_cast<std::size_t>(m_File.gcount()) / CommandJournal::RecordSize};
+
+        for(std::size_t index{0}; index != recordCount; ++index)
+        {
+            const std::optional<CommandRecord> record{CommandJournal::ReadRecord(
+                m_ChunkBuffer.data() + index * CommandJournal::RecordSize, static_cast<uint32_t>(m_RecordsRead))};
+            if(!record)
+            {
+                m_EndOfJournal = true;
+                break;
+            }
+
+            m_Chunk.push_back(*record);
+            ++m_RecordsRead;
+        }
+
+        if(recordCount != m_ChunkRecordCount)
+            m_EndOfJournal = true;
+
+        return !m_Chunk.empty();
+    }
+
+    bool JournalReplayer::ExecuteRecord(const CommandRecord& record)
+    {
+        std::optional<Command> command{DeserializeCommand(record, *m_Registry)};
+        if(!command)
+            return false;
+
+        command->Execute();
+        return true;
+    }
+
+    void JournalReplayer::RollbackRecord(const CommandRecord& record)
+    {
+        if(std::optional<Command> command{DeserializeCommand(record, *m_Registry)})
+            command->Rollback();
+    }
+
+    void JournalReplayer::WaitForReplayRate()
+    {
+        if(m_ReplayRate == 0)
+            return;
+
+        const std::chrono::duration<double> elapsed{static_cast<double>(m_RecordsRead - m_ReplayStartIndex) / m_ReplayRate};
+        std::this_thread::sleep_until(m_ReplayStart + std::chrono::duration_cast<std::chrono::steady_clock::duration>(elapsed));
+    }
+}
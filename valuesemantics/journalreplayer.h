@@ -0,0 +1,90 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <vector>
+
+#include "valuesemantics/commandrecord.h"
+#include "targetregistry.h"
+
+namespace ValueSemantics
+{
+    /// Executes the commands in a CommandJournal file without building a CommandQueue.
+    /// Records are read chunkRecordCount at a time into a reused buffer, decoded, executed against their
+    /// registered targets and discarded, so memory stays constant however long the journal is.
+    /// The last rollbackWindow executed records are kept, so up to that many commands can be rolled back
+    /// and executed again. Replay stops at the first torn record or record whose target isn't registered.
+    class JournalReplayer
+    {
+    public:
+        static constexpr uint32_t DefaultChunkRecordCount{4'096};
+        static constexpr uint32_t DefaultRollbackWindow{65'536};
+
+        /// registry has to outlive the replayer.
+        explicit JournalReplayer(const TargetRegistry& registry,
+            uint32_t chunkRecordCount = DefaultChunkRecordCount, uint32_t rollbackWindow = DefaultRollbackWindow);
+
+        /// Returns false when the file can't be opened or isn't a journal.
+        [[nodiscard]] bool Open(const std::filesystem::path& path);
+
+        /// Executes up to count commands and returns how many were executed,
+        /// which is less than count once the end of the journal is reached.
+        uint32_t ExecuteN(uint32_t count);
+
+        /// Executes commands until the end of the journal and returns how many were executed.
+        uint64_t ExecuteAll();
+
+        /// Rolls back up to count commands, no further back than the rollback window,
+        /// and returns how many were rolled back.
+        uint32_t RollbackN(uint32_t count);
+
+        /// Limits ExecuteN() to commandsPerSecond, 0 replays as fast as possible.
+        void SetReplayRate(uint32_t commandsPerSecond);
+
+        /// Number of commands executed and not rolled back.
+        [[nodiscard]] uint64_t GetCommandIndex() const
+        {
+            return m_CommandIndex;
+        }
+
+        /// Number of commands RollbackN() can currently roll back.
+        [[nodiscard]] uint32_t GetRollbackCount() const
+        {
+            return static_cast<uint32_t>(m_CommandIndex - (m_HistoryEnd - m_HistoryCount));
+        }
+
+        /// Bytes held by the replayer's buffers, independent of the journal's size.
+        [[nodiscard]] std::size_t GetBufferSize() const
+        {
+            return m_ChunkBuffer.capacity() + m_Chunk.capacity() * sizeof(CommandRecord)
+                + m_History.capacity() * sizeof(CommandRecord);
+        }
+
+    private:
+        /// Reads and decodes the next chunk of records, returns false at the end of the journal.
+        [[nodiscard]] bool ReadChunk();
+        bool ExecuteRecord(const CommandRecord& record);
+        void RollbackRecord(const CommandRecord& record);
+        void WaitForReplayRate();
+
+        const TargetRegistry* m_Registry{nullptr};
+        std::ifstream m_File{};
+        std::vector<std::byte> m_ChunkBuffer{};
+        std::vector<CommandRecord> m_Chunk{};
+        /// Ring buffer of the last executed records, m_History[i % size] holds the record of command i.
+        std::vector<CommandRecord> m_History{};
+        std::chrono::steady_clock::time_point m_ReplayStart{};
+        uint64_t m_ReplayStartIndex{0};
+        uint64_t m_CommandIndex{0};
+        uint64_t m_HistoryEnd{0};
+        uint64_t m_RecordsRead{0};
+        uint32_t m_HistoryCount{0};
+        uint32_t m_ChunkPosition{0};
+        uint32_t m_ChunkRecordCount{DefaultChunkRecordCount};
+        uint32_t m_ReplayRate{0};
+        bool m_EndOfJournal{true};
+    };
+}
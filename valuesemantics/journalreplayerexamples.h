@@ -0,0 +1,150 @@
+#pragma once
+
+#include <chrono>
+#include <filesystem>
+
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/benchmark/catch_benchmark.hpp>
+
+#include "valuesemantics/commandjournal.h"
+#include "valuesemantics/journaledcommandqueueexamples.h"
+#include "valuesemantics/journalreplayer.h"
+#include "processmemory.h"
+#include "targetregistry.h"
+#include "workingvalue.h"
+
+namespace ValueSemantics
+{
+    namespace
+    {
+        /// Writes commandCount records of +1 alternating between targets 1 and 2.
+        static void WriteJournal(const std::filesystem::path& path, const uint32_t commandCount)
+        {
+            CommandJournal journal{};
+            REQUIRE(journal.Open(path));
+            for(uint32_t i{0}; i != commandCount; ++i)
+            {
+                REQUIRE(journal.Append(CommandRecord{CommandTypeId::ModifyValue, 1 + i % 2, 1}));
+            }
+        }
+    }
+
+    TEST_CASE("Journal Replayer - Value Semantics - Unit Tests")
+    {
+        const TemporaryFile journalFile{"command-pattern-replayer-test.bin"};
+        std::shared_ptr<WorkingValue> value{std::make_shared<WorkingValue>()};
+        std::shared_ptr<WorkingValue> otherValue{std::make_shared<WorkingValue>()};
+        TargetRegistry registry{};
+        registry.Register(1, value);
+        registry.Register(2, otherValue);
+        WriteJournal(journalFile.GetPath(), 10);
+
+        JournalReplayer replayer{registry, 3, 4};
+        REQUIRE(replayer.Open(journalFile.GetPath()));
+        REQUIRE(replayer.GetCommandIndex() == 0);
+        REQUIRE(replayer.GetRollbackCount() == 0);
+
+        SECTION("Execute Commands")
+        {
+            REQUIRE(replayer.ExecuteN(5) == 5);
+            REQUIRE(value->GetValue() == 3);
+            REQUIRE(otherValue->GetValue() == 2);
+
+            REQUIRE(replayer.ExecuteAll() == 5);
+            REQUIRE(value->GetValue() == 5);
+            REQUIRE(otherValue->GetValue() == 5);
+            REQUIRE(replayer.GetCommandIndex() == 10);
+            REQUIRE(replayer.ExecuteN(1) == 0);
+        }
+
+        SECTION("Rollback Within Window")
+        {
+            REQUIRE(replayer.ExecuteN(7) == 7);
+            REQUIRE(replayer.GetRollbackCount() == 4);
+
+            REQUIRE(replayer.RollbackN(10) == 4); // Only the last 4 commands are kept
+            REQUIRE(replayer.GetCommandIndex() == 3);
+            REQUIRE(value->GetValue() == 2);
+            REQUIRE(otherValue->GetValue() == 1);
+
+            REQUIRE(replayer.ExecuteN(2) == 2); // Executed again from the window
+            REQUIRE(replayer.GetRollbackCount() == 2);
+
+            REQUIRE(replayer.ExecuteAll() == 5);
+            REQUIRE(value->GetValue() == 5);
+            REQUIRE(otherValue->GetValue() == 5);
+            REQUIRE(replayer.GetRollbackCount() == 4);
+        }
+
+        SECTION("Stop At Torn Record")
+        {
+            OverwriteFile(journalFile.GetPath(), GetJournalRecordOffset(6) + 4, 4, 'x');
+            REQUIRE(replayer.Open(journalFile.GetPath()));
+
+            REQUIRE(replayer.ExecuteAll() == 6);
+            REQUIRE(value->GetValue() == 3);
+            REQUIRE(otherValue->GetValue() == 3);
+        }
+
+        SECTION("Stop At Unregistered Target")
+        {
+            TargetRegistry partialRegistry{};
+            partialRegistry.Register(1, value);
+
+            JournalReplayer partialReplayer{partialRegistry};
+            REQUIRE(partialReplayer.Open(journalFile.GetPath()));
+            REQUIRE(partialReplayer.ExecuteAll() == 1);
+            REQUIRE(value->GetValue() == 1);
+        }
+
+        SECTION("Replay Rate")
+        {
+            replayer.SetReplayRate(100);
+            const auto start{std::chrono::steady_clock::now()};
+            REQUIRE(replayer.ExecuteAll() == 10);
+            REQUIRE(std::chrono::steady_clock::now() - start >= std::chrono::milliseconds{60});
+        }
+    }
+
+    TEST_CASE("Journal Replayer - Value Semantics - Replay Benchmark")
+    {
+        std::shared_ptr<WorkingValue> value{std::make_shared<WorkingValue>()};
+        std::shared_ptr<WorkingValue> otherValue{std::make_shared<WorkingValue>()};
+        TargetRegistry registry{};
+        registry.Register(1, value);
+        registry.Register(2, otherValue);
+
+        for(const uint32_t commandCount : {100'000u, 1'000'000u, 4'000'000u})
+        {
+            const TemporaryFile journalFile{"command-pattern-replayer-benchmark.bin"};
+            WriteJournal(journalFile.GetPath(), commandCount);
+            const std::size_t journalSize{static_cast<std::size_t>(std::filesystem::file_size(journalFile.GetPath()))};
+
+            JournalReplayer replayer{registry};
+            const std::size_t startResidentSetSize{GetCurrentResidentSetSize()};
+            std::size_t peakResidentSetSize{startResidentSetSize};
+            double commandsPerSecond{0};
+
+            BENCHMARK("Replay - " + std::to_string(commandCount))
+            {
+                REQUIRE(replayer.Open(journalFile.GetPath()));
+
+                const auto start{std::chrono::steady_clock::now()};
+                uint64_t executed{0};
+                for(uint32_t chunkExecuted{replayer.ExecuteN(65'536)}; chunkExecuted != 0; chunkExecuted = replayer.ExecuteN(65'536))
+                {
+                    executed += chunkExecuted;
+                    peakResidentSetSize = std::max(peakResidentSetSize, GetCurrentResidentSetSize());
+                }
+                const std::chrono::duration<double> elapsed{std::chrono::steady_clock::now() - start};
+                commandsPerSecond = static_cast<double>(executed) / elapsed.count();
+                return executed;
+            };
+
+            WARN("Journal: " << journalSize / 1024 << " KB, "
+                << static_cast<uint64_t>(commandsPerSecond) << " commands/sec, "
+                << "replayer buffers: " << replayer.GetBufferSize() / 1024 << " KB, "
+                << "resident set growth while replaying: " << (peakResidentSetSize - startResidentSetSize) / 1024 << " KB");
+        }
+    }
+}
@@ -0,0 +1,133 @@
+#pragma once
+
+#include <cstdint>
+#include <utility>
+
+#include "valuesemantics/commandqueue.h"
+
+namespace ValueSemantics
+{
+    /// Command queue whose cursor moves are deferred. Executing or rolling back only moves the target command index,
+    /// the commands between the applied and the target index are executed or rolled back once by Flush(),
+    /// so moving back and forth between flushes costs nothing beyond the net distance moved.
+    /// The targets of the commands are only up to date after Flush(), read them through Observe().
+    class LazyCommandQueue
+    {
+    public:
+        /// HasPendingCommand() has to be true before calling
+        void ExecuteCommand()
+        {
+            ++m_CommandIndex;
+        }
+
+        /// HasPendingRollbackCommand() has to be true before calling
+        void RollbackCommand()
+        {
+            --m_CommandIndex;
+        }
+
+        /// Executes every pending command.
+        void ExecuteAll()
+        {
+            m_CommandIndex = GetCommandQueueSize();
+        }
+
+        /// count has to be no greater than the number of pending commands
+        void ExecuteN(const uint32_t count)
+        {
+            m_CommandIndex += count;
+        }
+
+        /// Rolls back commands until GetCommandIndex() == index.
+        /// index has to be no greater than GetCommandIndex()
+        void RollbackTo(const uint32_t index)
+        {
+            m_CommandIndex = index;
+        }
+
+        /// Executes or rolls back commands until GetCommandIndex() == index.
+        /// index has to be no greater than GetCommandQueueSize()
+        void SeekTo(const uint32_t index)
+        {
+            m_CommandIndex = index;
+        }
+
+        /// Applies the deferred moves, executing or rolling back the commands between the applied and target index.
+        void Flush()
+        {
+            m_CommandQueue.SeekTo(m_CommandIndex);
+        }
+
+        /// Flushes, then returns read(), which may read the targets of the commands.
+        template<class TFunction>
+        decltype(auto) Observe(TFunction&& read)
+        {
+            Flush();
+            return std::forward<TFunction>(read)();
+        }
+
+        /// The targets are left as Flush() would leave them.
+        void ClearQueue()
+        {
+            Flush();
+            m_CommandQueue.ClearQueue();
+            m_CommandIndex = 0;
+        }
+
+        /// Removes any commands ahead of and including the current pending command.
+        /// HasPendingCommand() has to be true before calling
+        void ClearPendingCommands()
+        {
+            Flush();
+            m_CommandQueue.ClearPendingCommands();
+        }
+
+        [[nodiscard]] bool HasPendingCommand() const
+        {
+            return GetCommandQueueSize() > m_CommandIndex;
+        }
+
+        [[nodiscard]] bool HasPendingRollbackCommand() const
+        {
+            return m_CommandIndex != 0 && GetCommandQueueSize() >= m_CommandIndex;
+        }
+
+        /// True when moves are waiting for Flush().
+        [[nodiscard]] bool HasDeferredMoves() const
+        {
+            return m_CommandQueue.GetCommandIndex() != m_CommandIndex;
+        }
+
+        /// Flushes first, coalescing may execute the command immediately and has to see the queue's real cursor.
+        void QueueCommand(Command&& command)
+        {
+            Flush();
+            m_CommandQueue.QueueCommand(std::move(command));
+        }
+
+        /// Target command index, the one the queue is at once flushed.
+        [[nodiscard]] uint32_t GetCommandIndex() const
+        {
+            return m_CommandIndex;
+        }
+
+        /// Command index the targets are at.
+        [[nodiscard]] uint32_t GetAppliedCommandIndex() const
+        {
+            return m_CommandQueue.GetCommandIndex();
+        }
+
+        [[nodiscard]] uint32_t GetCommandQueueSize() const
+        {
+            return m_CommandQueue.GetCommandQueueSize();
+        }
+
+        void SetCoalescePolicy(const CoalescePolicy policy)
+        {
+            m_CommandQueue.SetCoalescePolicy(policy);
+        }
+    private:
+        CommandQueue m_CommandQueue{};
+        uint32_t m_CommandIndex{0};
+    };
+}
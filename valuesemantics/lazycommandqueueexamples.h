@@ -0,0 +1,150 @@
+#pragma once
+
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/benchmark/catch_benchmark.hpp>
+
+#include <random>
+
+#include "valuesemantics/commandqueueexamples.h"
+#include "valuesemantics/lazycommandqueue.h"
+#include "workingvalue.h"
+
+namespace ValueSemantics
+{
+    TEST_CASE("Lazy Command Queue - Value Semantics - Unit Tests")
+    {
+        std::shared_ptr<WorkingValue> value{std::make_shared<WorkingValue>()};
+        LazyCommandQueue queue{};
+        queue.QueueCommand(CreateCommand(value, 1));
+        queue.QueueCommand(CreateCommand(value, 2));
+        queue.QueueCommand(CreateCommand(value, 4));
+        REQUIRE(queue.GetCommandQueueSize() == 3);
+        REQUIRE_FALSE(queue.HasDeferredMoves());
+
+        SECTION("Moves Are Deferred")
+        {
+            queue.ExecuteAll();
+            queue.RollbackCommand();
+            REQUIRE(queue.GetCommandIndex() == 2);
+            REQUIRE(queue.GetAppliedCommandIndex() == 0);
+            REQUIRE(queue.HasDeferredMoves());
+            REQUIRE(value->GetValue() == 0);
+
+            REQUIRE(queue.Observe([&value] { return value->GetValue(); }) == 3);
+            REQUIRE(queue.GetAppliedCommandIndex() == 2);
+            REQUIRE_FALSE(queue.HasDeferredMoves());
+        }
+
+        SECTION("Oscillation Cancels Out")
+        {
+            queue.ExecuteN(2);
+            queue.Flush(); // +1, +2
+            for(uint32_t i{0}; i != 100; ++i)
+            {
+                queue.RollbackTo(0);
+                queue.SeekTo(3);
+                queue.SeekTo(2);
+            }
+            REQUIRE_FALSE(queue.HasDeferredMoves());
+            REQUIRE(value->GetValue() == 3);
+        }
+
+        SECTION("Queue Applies Deferred Moves")
+        {
+            queue.SetCoalescePolicy(CoalescePolicy::AcrossCursor);
+            queue.ExecuteAll();
+            queue.Flush();
+            queue.RollbackCommand();
+
+            // Merged into the +4, which is pending again once the deferred rollback is applied
+            queue.QueueCommand(CreateCommand(value, 8));
+            REQUIRE(value->GetValue() == 3);
+            REQUIRE(queue.GetCommandQueueSize() == 3);
+            queue.ExecuteCommand();
+            queue.Flush(); // +12
+            REQUIRE(value->GetValue() == 15);
+        }
+
+        SECTION("Clear Commands")
+        {
+            queue.ExecuteCommand();
+            queue.ClearPendingCommands();
+            REQUIRE(queue.GetCommandQueueSize() == 1);
+            REQUIRE(value->GetValue() == 1);
+
+            queue.RollbackCommand();
+            queue.ClearQueue();
+            REQUIRE(queue.GetCommandQueueSize() == 0);
+            REQUIRE(queue.GetCommandIndex() == 0);
+            REQUIRE(value->GetValue() == 0);
+        }
+    }
+
+    TEST_CASE("Lazy Command Queue - Value Semantics - Random Walk Benchmark")
+    {
+        constexpr uint32_t commandCount{10'000};
+        constexpr uint32_t moveCount{100'000};
+        constexpr uint32_t movesPerRead{64};
+
+        std::shared_ptr<WorkingValue> value{std::make_shared<WorkingValue>()};
+        CommandQueue queue{};
+        LazyCommandQueue lazyQueue{};
+        for(uint32_t i{0}; i != commandCount; ++i)
+        {
+            queue.QueueCommand(CreateCommand(value, 1));
+            lazyQueue.QueueCommand(CreateCommand(value, 1));
+        }
+
+        // A scrubbing cursor: random single steps from the middle of the history, staying within it
+        std::vector<bool> forwardMoves(moveCount);
+        {
+            std::minstd_rand random{11};
+            uint32_t index{commandCount / 2};
+            for(uint32_t move{0}; move != moveCount; ++move)
+            {
+                const bool forward{index == 0 || (index != commandCount && random() % 2 == 0)};
+                forwardMoves[move] = forward;
+                index = forward ? index + 1 : index - 1;
+            }
+        }
+
+        queue.SeekTo(commandCount / 2);
+        lazyQueue.SeekTo(commandCount / 2);
+        lazyQueue.Flush();
+
+        BENCHMARK("Eager")
+        {
+            int32_t readSum{0};
+            for(uint32_t move{0}; move != moveCount; ++move)
+            {
+                if(forwardMoves[move])
+                    queue.ExecuteCommand();
+                else
+                    queue.RollbackCommand();
+
+                if(move % movesPerRead == 0)
+                    readSum += value->GetValue();
+            }
+            queue.SeekTo(commandCount / 2);
+            return readSum;
+        };
+
+        BENCHMARK("Lazy")
+        {
+            int32_t readSum{0};
+            for(uint32_t move{0}; move != moveCount; ++move)
+            {
+                if(forwardMoves[move])
+                    lazyQueue.ExecuteCommand();
+                else
+                    lazyQueue.RollbackCommand();
+
+                if(move % movesPerRead == 0)
+                    readSum += lazyQueue.Observe([&value] { return value->GetValue(); });
+            }
+            lazyQueue.SeekTo(commandCount / 2);
+            lazyQueue.Flush();
+            return readSum;
+        };
+    }
+}
@@ -0,0 +1,82 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "valuesemantics/commandqueue.h"
+
+namespace ValueSemantics
+{
+    /// Ingestion stage in front of a command queue for commands generated on many threads.
+    /// Every producer owns a buffer which only it writes to, so queueing takes no locks and no atomics.
+    /// At a sync point, such as the end of a frame, FlushInto() moves the commands into the queue ordered by
+    /// producer index first and then by the order each producer queued them. The resulting order only depends
+    /// on which producer queued which commands, never on thread scheduling.
+    /// The consumer may execute the target queue while producers are queueing into their buffers.
+    class MultiProducerCommandBuffer
+    {
+    public:
+        explicit MultiProducerCommandBuffer(const uint32_t producerCount)
+            : m_ProducerBuffers(producerCount == 0 ? 1 : producerCount)
+        {
+        }
+
+        /// Only one thread may queue for a producerIndex at a time, and not while FlushInto() runs.
+        /// producerIndex has to be less than GetProducerCount()
+        void QueueCommand(const uint32_t producerIndex, Command&& command)
+        {
+            m_ProducerBuffers[producerIndex].m_Commands.push_back(std::move(command));
+        }
+
+        /// Reserves space for count commands in the producer's buffer.
+        void Reserve(const uint32_t producerIndex, const uint32_t count)
+        {
+            m_ProducerBuffers[producerIndex].m_Commands.reserve(count);
+        }
+
+        /// Appends every buffered command to queue in producer index order and empties the buffers,
+        /// keeping their capacity for the next batch. queue can be any queue with a QueueCommand(Command&&).
+        /// No producer may be queueing while flushing
+        template<class TQueue>
+            requires requires(TQueue& queue, Command&& command) { queue.QueueCommand(std::move(command)); }
+        void FlushInto(TQueue& queue)
+        {
+            for(ProducerBuffer& buffer : m_ProducerBuffers)
+            {
+                for(Command& command : buffer.m_Commands)
+                {
+                    queue.QueueCommand(std::move(command));
+                }
+                buffer.m_Commands.clear();
+            }
+        }
+
+        [[nodiscard]] uint32_t GetProducerCount() const
+        {
+            return static_cast<uint32_t>(m_ProducerBuffers.size());
+        }
+
+        /// Number of commands waiting to be flushed.
+        /// No producer may be queueing while calling
+        [[nodiscard]] uint32_t GetBufferedCommandCount() const
+        {
+            std::size_t count{0};
+            for(const ProducerBuffer& buffer : m_ProducerBuffers)
+            {
+                count += buffer.m_Commands.size();
+            }
+            return static_cast<uint32_t>(count);
+        }
+
+    private:
+        /// Aligned to a cache line so producers don't false share buffer bookkeeping.
+        struct alignas(64) ProducerBuffer
+        {
+            std::vector<Command> m_Commands{};
+        };
+
+        std::vector<ProducerBuffer> m_ProducerBuffers{};
+    };
+}
@@ -0,0 +1,202 @@
+#pragma once
+
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/benchmark/catch_benchmark.hpp>
+
+#include "valuesemantics/boundedcommandqueue.h"
+#include "valuesemantics/commandqueueexamples.h"
+#include "valuesemantics/lazycommandqueue.h"
+#include "valuesemantics/multiproducercommandbuffer.h"
+#include "workingvalue.h"
+
+namespace ValueSemantics
+{
+    namespace
+    {
+        /// Runs producer(producerIndex) on producerCount threads and waits for all of them.
+        template<class TProducer>
+        static void RunProducers(const uint32_t producerCount, TProducer&& producer)
+        {
+            std::vector<std::thread> threads{};
+            threads.reserve(producerCount);
+            for(uint32_t producerIndex{0}; producerIndex != producerCount; ++producerIndex)
+            {
+                threads.emplace_back(producer, producerIndex);
+            }
+
+            for(std::thread& thread : threads)
+            {
+                thread.join();
+            }
+        }
+    }
+
+    TEST_CASE("Multi Producer Command Buffer - Value Semantics - Unit Tests")
+    {
+        constexpr uint32_t producerCount{8};
+        constexpr uint32_t commandsPerProducer{1'000};
+        MultiProducerCommandBuffer buffer{producerCount};
+        CommandQueue queue{};
+        REQUIRE(buffer.GetProducerCount() == producerCount);
+        REQUIRE(buffer.GetBufferedCommandCount() == 0);
+
+        SECTION("Deterministic Order")
+        {
+            std::vector<uint32_t> executionOrder{};
+
+            RunProducers(producerCount,
+                [&](const uint32_t producerIndex)
+                {
+                    for(uint32_t i{0}; i != commandsPerProducer; ++i)
+                    {
+                        const uint32_t id{producerIndex * commandsPerProducer + i};
+                        buffer.QueueCommand(producerIndex, LambdaCommand{
+                            [&executionOrder, id]
+                            {
+                                executionOrder.push_back(id);
+                            },
+                            [&executionOrder]
+                            {
+                                executionOrder.pop_back();
+                            }});
+                    }
+                });
+            REQUIRE(buffer.GetBufferedCommandCount() == producerCount * commandsPerProducer);
+            REQUIRE(queue.GetCommandQueueSize() == 0);
+
+            buffer.FlushInto(queue);
+            REQUIRE(buffer.GetBufferedCommandCount() == 0);
+            REQUIRE(queue.GetCommandQueueSize() == producerCount * commandsPerProducer);
+
+            queue.ExecuteAll();
+            REQUIRE(executionOrder.size() == producerCount * commandsPerProducer);
+            for(uint32_t i{0}; i != executionOrder.size(); ++i)
+            {
+                REQUIRE(executionOrder[i] == i);
+            }
+
+            queue.RollbackTo(0);
+            REQUIRE(executionOrder.empty());
+        }
+
+        SECTION("Produce While Executing")
+        {
+            std::shared_ptr<WorkingValue> value{std::make_shared<WorkingValue>()};
+
+            for(uint32_t frame{0}; frame != 4; ++frame)
+            {
+                std::thread consumer{
+                    [&queue]
+                    {
+                        queue.ExecuteAll();
+                    }};
+
+                RunProducers(producerCount,
+                    [&](const uint32_t producerIndex)
+                    {
+                        for(uint32_t i{0}; i != commandsPerProducer; ++i)
+                        {
+                            buffer.QueueCommand(producerIndex, CreateCommand(value, 1));
+                        }
+                    });
+
+                consumer.join();
+                buffer.FlushInto(queue);
+            }
+
+            queue.ExecuteAll();
+            REQUIRE(value->GetValue() == 4 * producerCount * commandsPerProducer);
+            REQUIRE(queue.GetCommandQueueSize() == 4 * producerCount * commandsPerProducer);
+        }
+
+        SECTION("Flush Into Other Queues")
+        {
+            std::shared_ptr<WorkingValue> value{std::make_shared<WorkingValue>()};
+            BoundedCommandQueue boundedQueue{producerCount};
+            LazyCommandQueue lazyQueue{};
+
+            for(uint32_t producerIndex{0}; producerIndex != producerCount; ++producerIndex)
+            {
+                buffer.QueueCommand(producerIndex, CreateCommand(value, 1));
+            }
+            buffer.FlushInto(boundedQueue);
+            REQUIRE(boundedQueue.GetCommandQueueSize() == producerCount);
+
+            for(uint32_t producerIndex{0}; producerIndex != producerCount; ++producerIndex)
+            {
+                buffer.QueueCommand(producerIndex, CreateCommand(value, 2));
+            }
+            buffer.FlushInto(lazyQueue);
+            REQUIRE(lazyQueue.GetCommandQueueSize() == producerCount);
+            REQUIRE(buffer.GetBufferedCommandCount() == 0);
+
+            while(boundedQueue.HasPendingCommand())
+            {
+                boundedQueue.ExecuteCommand();
+            }
+            lazyQueue.ExecuteAll();
+            lazyQueue.Flush();
+            REQUIRE(value->GetValue() == 3 * producerCount);
+        }
+    }
+
+    TEST_CASE("Multi Producer Command Buffer - Value Semantics - Throughput Benchmark")
+    {
+        constexpr uint32_t commandCount{1'000'000};
+
+        for(const uint32_t producerCount : {1u, 2u, 4u, 8u, 16u, 32u})
+        {
+            const uint32_t commandsPerProducer{commandCount / producerCount};
+
+            // A value per producer so producers don't contend on a shared reference count
+            std::vector<std::shared_ptr<WorkingValue>> values{};
+            for(uint32_t producerIndex{0}; producerIndex != producerCount; ++producerIndex)
+            {
+                values.push_back(std::make_shared<WorkingValue>());
+            }
+
+            BENCHMARK("Mutex - " + std::to_string(producerCount))
+            {
+                CommandQueue queue{};
+                std::mutex mutex{};
+
+                RunProducers(producerCount,
+                    [&](const uint32_t producerIndex)
+                    {
+                        for(uint32_t i{0}; i != commandsPerProducer; ++i)
+                        {
+                            Command command{CreateCommand(values[producerIndex], 1)};
+                            const std::scoped_lock lock{mutex};
+                            queue.QueueCommand(std::move(command));
+                        }
+                    });
+
+                return queue.GetCommandQueueSize();
+            };
+
+            BENCHMARK("Per Producer Buffers - " + std::to_string(producerCount))
+            {
+                CommandQueue queue{};
+                MultiProducerCommandBuffer buffer{producerCount};
+
+                RunProducers(producerCount,
+                    [&](const uint32_t producerIndex)
+                    {
+                        buffer.Reserve(producerIndex, commandsPerProducer);
+                        for(uint32_t i{0}; i != commandsPerProducer; ++i)
+                        {
+                            buffer.QueueCommand(producerIndex, CreateCommand(values[producerIndex], 1));
+                        }
+                    });
+
+                buffer.FlushInto(queue);
+                return queue.GetCommandQueueSize();
+            };
+        }
+    }
+}
@@ -0,0 +1,413 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+#include "valuesemantics/commandoperations.h"
+
+namespace ValueSemantics
+{
+    /// Stores heterogeneous commands back to back in a single growable byte buffer.
+    /// Each record is a header, holding the record's size and dispatch entry, followed by the command.
+    /// Commands are invoked through the same Execute/Rollback operations as Command.
+    class PackedCommandQueue
+    {
+    public:
+        PackedCommandQueue() = default;
+
+        ~PackedCommandQueue()
+        {
+            DestroyRecords(0);
+        }
+
+        PackedCommandQueue(const PackedCommandQueue&) = delete;
+        PackedCommandQueue& operator=(const PackedCommandQueue&) = delete;
+
+        PackedCommandQueue(PackedCommandQueue&& other) noexcept
+            : m_Buffer{std::move(other.m_Buffer)}
+            , m_Capacity{std::exchange(other.m_Capacity, 0)}
+            , m_EndOffset{std::exchange(other.m_EndOffset, 0)}
+            , m_CursorOffset{std::exchange(other.m_CursorOffset, 0)}
+            , m_LastRecordSize{std::exchange(other.m_LastRecordSize, 0)}
+            , m_CommandCount{std::exchange(other.m_CommandCount, 0)}
+            , m_CommandIndex{std::exchange(other.m_CommandIndex, 0)}
+            , m_DestructibleCount{std::exchange(other.m_DestructibleCount, 0)}
+            , m_RelocatableCount{std::exchange(other.m_RelocatableCount, 0)}
+        {
+        }
+
+        PackedCommandQueue& operator=(PackedCommandQueue&& other) noexcept
+        {
+            if(this == &other)
+                return *this;
+
+            DestroyRecords(0);
+            m_Buffer = std::move(other.m_Buffer);
+            m_Capacity = std::exchange(other.m_Capacity, 0);
+            m_EndOffset = std::exchange(other.m_EndOffset, 0);
+            m_CursorOffset = std::exchange(other.m_CursorOffset, 0);
+            m_LastRecordSize = std::exchange(other.m_LastRecordSize, 0);
+            m_CommandCount = std::exchange(other.m_CommandCount, 0);
+            m_CommandIndex = std::exchange(other.m_CommandIndex, 0);
+            m_DestructibleCount = std::exchange(other.m_DestructibleCount, 0);
+            m_RelocatableCount = std::exchange(other.m_RelocatableCount, 0);
+            return *this;
+        }
+
+        /// HasPendingCommand() has to be true before calling
+        void ExecuteCommand()
+        {
+            const RecordHeader& header{GetHeader(m_CursorOffset)};
+            header.m_Dispatch->m_Execute(GetCommand(m_CursorOffset));
+            m_CursorOffset += header.m_Size;
+            ++m_CommandIndex;
+        }
+
+        /// HasPendingRollbackCommand() has to be true before calling
+        void RollbackCommand()
+        {
+            const std::size_t offset{m_CursorOffset - (m_CursorOffset == m_EndOffset
+                ? m_LastRecordSize
+                : GetHeader(m_CursorOffset).m_PreviousSize)};
+            GetHeader(offset).m_Dispatch->m_Rollback(GetCommand(offset));
+            m_CursorOffset = offset;
+            --m_CommandIndex;
+        }
+
+        /// Executes every pending command.
+        void ExecuteAll()
+        {
+            ExecuteN(GetCommandQueueSize() - m_CommandIndex);
+        }
+
+        /// Consecutive commands of the same type are dispatched once per run rather than once per command.
+        /// Not exception safe: the cursor only moves once a run has been dispatched, so when a command throws the commands
+        /// of its run which already ran aren't counted. Step with ExecuteCommand() where commands may throw.
+        /// count has to be no greater than the number of pending commands
+        void ExecuteN(uint32_t count)
+        {
+            while(count != 0)
+            {
+                const RecordHeader& header{GetHeader(m_CursorOffset)};
+                const uint32_t recordSize{header.m_Size};
+                const uint32_t executed{header.m_Dispatch->m_ExecuteRun(m_Buffer.get() + m_CursorOffset, count)};
+                m_CursorOffset += static_cast<std::size_t>(executed) * recordSize;
+                m_CommandIndex += executed;
+                count -= executed;
+            }
+        }
+
+        /// Rolls back commands until GetCommandIndex() == index.
+        /// Consecutive commands of the same type are dispatched once per run rather than once per command.
+        /// Not exception safe: the cursor only moves once a run has been dispatched, so when a command throws the commands
+        /// of its run which already ran aren't counted. Step with RollbackCommand() where commands may throw.
+        /// index has to be no greater than GetCommandIndex()
+        void RollbackTo(const uint32_t index)
+        {
+            while(m_CommandIndex != index)
+            {
+                const std::size_t lastOffset{m_CursorOffset - (m_CursorOffset == m_EndOffset
+                    ? m_LastRecordSize
+                    : GetHeader(m_CursorOffset).m_PreviousSize)};
+                const RecordHeader& header{GetHeader(lastOffset)};
+                const uint32_t recordSize{header.m_Size};
+                const uint32_t rolledBack{header.m_Dispatch->m_RollbackRun(m_Buffer.get() + lastOffset, m_CommandIndex - index)};
+                m_CursorOffset = lastOffset - static_cast<std::size_t>(rolledBack - 1) * recordSize;
+                m_CommandIndex -= rolledBack;
+            }
+        }
+
+        /// Executes or rolls back commands until GetCommandIndex() == index.
+        /// index has to be no greater than GetCommandQueueSize()
+        void SeekTo(const uint32_t index)
+        {
+            if(index > m_CommandIndex)
+                ExecuteN(index - m_CommandIndex);
+            else
+                RollbackTo(index);
+        }
+
+        /// Trivially destructible commands are released by resetting the write offset.
+        void ClearQueue()
+        {
+            DestroyRecords(0);
+            m_EndOffset = 0;
+            m_CursorOffset = 0;
+            m_LastRecordSize = 0;
+            m_CommandCount = 0;
+            m_CommandIndex = 0;
+        }
+
+        /// Removes any commands ahead of and including the current pending command.
+        /// HasPendingCommand() has to be true before calling
+        void ClearPendingCommands()
+        {
+            if(m_CursorOffset == m_EndOffset)
+                return;
+
+            m_LastRecordSize = GetHeader(m_CursorOffset).m_PreviousSize;
+            DestroyRecords(m_CursorOffset);
+            m_EndOffset = m_CursorOffset;
+            m_CommandCount = m_CommandIndex;
+        }
+
+        [[nodiscard]] bool HasPendingCommand() const
+        {
+            return GetCommandQueueSize() > m_CommandIndex;
+        }
+
+        [[nodiscard]] bool HasPendingRollbackCommand() const
+        {
+            return m_CommandIndex != 0 && GetCommandQueueSize() >= m_CommandIndex;
+        }
+
+        template<class TCommand>
+        void QueueCommand(TCommand&& command)
+        {
+            EmplaceCommand<std::remove_cvref_t<TCommand>>(std::forward<TCommand>(command));
+        }
+
+        /// Constructs TCommand directly in the queue's buffer.
+        template<class TCommand, class... TArgs>
+        void EmplaceCommand(TArgs&&... args)
+        {
+            static_assert(alignof(TCommand) <= RecordAlignment, "Over-aligned commands are not supported");
+            constexpr uint32_t recordSize{GetRecordSize(sizeof(TCommand))};
+
+            Reserve(m_EndOffset + recordSize);
+            std::byte* const record{m_Buffer.get() + m_EndOffset};
+            ::new(static_cast<void*>(record + sizeof(RecordHeader))) TCommand(std::forward<TArgs>(args)...);
+            ::new(static_cast<void*>(record)) RecordHeader{&RecordDispatchFor<TCommand>, recordSize, m_LastRecordSize};
+
+            m_EndOffset += recordSize;
+            m_LastRecordSize = recordSize;
+            ++m_CommandCount;
+
+            if constexpr(!std::is_trivially_destructible_v<TCommand>)
+                ++m_DestructibleCount;
+
+            if constexpr(!std::is_trivially_copyable_v<TCommand>)
+                ++m_RelocatableCount;
+        }
+
+        /// Ensures byteCount bytes of commands can be stored without growing the buffer.
+        void Reserve(const std::size_t byteCount)
+        {
+            if(byteCount <= m_Capacity)
+                return;
+
+            Grow(std::max({byteCount, m_Capacity * 2, MinimumCapacity}));
+        }
+
+        [[nodiscard]] uint32_t GetCommandIndex() const
+        {
+            return m_CommandIndex;
+        }
+
+        [[nodiscard]] uint32_t GetCommandQueueSize() const
+        {
+            return m_CommandCount;
+        }
+
+        /// Number of bytes used by the queued records.
+        [[nodiscard]] std::size_t GetByteSize() const
+        {
+            return m_EndOffset;
+        }
+
+    private:
+        struct RecordDispatch
+        {
+            void (*m_Execute)(std::byte* command);
+            void (*m_Rollback)(std::byte* command);
+            /// Executes up to maxCount consecutive records of the same type, starting at record.
+            /// Returns the number of records executed.
+            uint32_t (*m_ExecuteRun)(std::byte* record, uint32_t maxCount);
+            /// Rolls back up to maxCount consecutive records of the same type, from record towards the front.
+            /// Returns the number of records rolled back.
+            uint32_t (*m_RollbackRun)(std::byte* record, uint32_t maxCount);
+            /// Move constructs the command at destination and destroys the source, nullptr when trivially copyable.
+            void (*m_Relocate)(std::byte* destination, std::byte* source) noexcept;
+            /// nullptr when trivially destructible.
+            void (*m_Destroy)(std::byte* command) noexcept;
+        };
+
+        struct RecordHeader
+        {
+            const RecordDispatch* m_Dispatch{nullptr};
+            uint32_t m_Size{0};
+            uint32_t m_PreviousSize{0};
+        };
+
+        static constexpr std::size_t RecordAlignment{alignof(std::max_align_t)};
+        static constexpr std::size_t MinimumCapacity{4096};
+        static_assert(__STDCPP_DEFAULT_NEW_ALIGNMENT__ >= RecordAlignment);
+        static_assert(sizeof(RecordHeader) % RecordAlignment == 0);
+
+        [[nodiscard]] static constexpr uint32_t GetRecordSize(const std::size_t commandSize)
+        {
+            const std::size_t size{sizeof(RecordHeader) + commandSize};
+            return static_cast<uint32_t>((size + RecordAlignment - 1) / RecordAlignment * RecordAlignment);
+        }
+
+        [[nodiscard]] static const RecordHeader& GetRecordHeader(const std::byte* record)
+        {
+            return *std::launder(reinterpret_cast<const RecordHeader*>(record));
+        }
+
+        template<class TCommand>
+        [[nodiscard]] static TCommand& GetRecordCommand(std::byte* record)
+        {
+            return *std::launder(reinterpret_cast<TCommand*>(record + sizeof(RecordHeader)));
+        }
+
+        template<class TCommand>
+        static void ExecuteRecord(std::byte* command)
+        {
+            ValueSemantics::Execute(*std::launder(reinterpret_cast<TCommand*>(command)));
+        }
+
+        template<class TCommand>
+        static void RollbackRecord(std::byte* command)
+        {
+            ValueSemantics::Rollback(*std::launder(reinterpret_cast<TCommand*>(command)));
+        }
+
+        template<class TCommand>
+        static uint32_t ExecuteRecordRun(std::byte* record, const uint32_t maxCount)
+        {
+            constexpr uint32_t recordSize{GetRecordSize(sizeof(TCommand))};
+            uint32_t count{0};
+            do
+            {
+                ValueSemantics::Execute(GetRecordCommand<TCommand>(record));
+                record += recordSize;
+                ++count;
+            }
+            while(count != maxCount && GetRecordHeader(record).m_Dispatch == &RecordDispatchFor<TCommand>);
+            return count;
+        }
+
+        template<class TCommand>
+        static uint32_t RollbackRecordRun(std::byte* record, const uint32_t maxCount)
+        {
+            constexpr uint32_t recordSize{GetRecordSize(sizeof(TCommand))};
+            uint32_t count{0};
+            while(true)
+            {
+                ValueSemantics::Rollback(GetRecordCommand<TCommand>(record));
+                ++count;
+
+                if(count == maxCount || GetRecordHeader(record).m_PreviousSize != recordSize)
+                    return count;
+
+                record -= recordSize;
+                if(GetRecordHeader(record).m_Dispatch != &RecordDispatchFor<TCommand>)
+                    return count;
+            }
+        }
+
+        template<class TCommand>
+        static void RelocateRecord(std::byte* destination, std::byte* source) noexcept
+        {
+            TCommand* const command{std::launder(reinterpret_cast<TCommand*>(source))};
+            ::new(static_cast<void*>(destination)) TCommand(std::move(*command));
+            command->~TCommand();
+        }
+
+        template<class TCommand>
+        static void DestroyRecord(std::byte* command) noexcept
+        {
+            std::launder(reinterpret_cast<TCommand*>(command))->~TCommand();
+        }
+
+        template<class TCommand>
+        static constexpr RecordDispatch RecordDispatchFor{
+            &ExecuteRecord<TCommand>,
+            &RollbackRecord<TCommand>,
+            &ExecuteRecordRun<TCommand>,
+            &RollbackRecordRun<TCommand>,
+            std::is_trivially_copyable_v<TCommand> ? nullptr : &RelocateRecord<TCommand>,
+            std::is_trivially_destructible_v<TCommand> ? nullptr : &DestroyRecord<TCommand>};
+
+        [[nodiscard]] RecordHeader& GetHeader(const std::size_t offset) const
+        {
+            return *std::launder(reinterpret_cast<RecordHeader*>(m_Buffer.get() + offset));
+        }
+
+        [[nodiscard]] std::byte* GetCommand(const std::size_t offset) const
+        {
+            return m_Buffer.get() + offset + sizeof(RecordHeader);
+        }
+
+        /// Destroys the records from offset to the end of the buffer.
+        void DestroyRecords(std::size_t offset) noexcept
+        {
+            if(m_DestructibleCount == 0 && m_RelocatableCount == 0)
+                return;
+
+            while(offset != m_EndOffset)
+            {
+                const RecordHeader& header{GetHeader(offset)};
+                if(header.m_Dispatch->m_Destroy)
+                {
+                    header.m_Dispatch->m_Destroy(GetCommand(offset));
+                    --m_DestructibleCount;
+                }
+
+                if(header.m_Dispatch->m_Relocate)
+                    --m_RelocatableCount;
+
+                offset += header.m_Size;
+            }
+        }
+
+        void Grow(const std::size_t capacity)
+        {
+            std::unique_ptr<std::byte[]> buffer{new std::byte[capacity]};
+
+            if(m_RelocatableCount == 0)
+            {
+                if(m_EndOffset != 0)
+                    std::memcpy(buffer.get(), m_Buffer.get(), m_EndOffset);
+            }
+            else
+            {
+                for(std::size_t offset{0}; offset != m_EndOffset;)
+                {
+                    const RecordHeader& header{GetHeader(offset)};
+                    std::memcpy(buffer.get() + offset, &header, sizeof(RecordHeader));
+
+                    std::byte* const destination{buffer.get() + offset + sizeof(RecordHeader)};
+                    if(header.m_Dispatch->m_Relocate)
+                        header.m_Dispatch->m_Relocate(destination, GetCommand(offset));
+                    else
+                        std::memcpy(destination, GetCommand(offset), header.m_Size - sizeof(RecordHeader));
+
+                    offset += header.m_Size;
+                }
+            }
+
+            m_Buffer = std::move(buffer);
+            m_Capacity = capacity;
+        }
+
+        std::unique_ptr<std::byte[]> m_Buffer{};
+        std::size_t m_Capacity{0};
+        std::size_t m_EndOffset{0};
+        std::size_t m_CursorOffset{0};
+        uint32_t m_LastRecordSize{0};
+        uint32_t m_CommandCount{0};
+        uint32_t m_CommandIndex{0};
+        /// Records which need their destructor run.
+        uint32_t m_DestructibleCount{0};
+        /// Records which have to be move constructed when the buffer grows.
+        uint32_t m_RelocatableCount{0};
+    };
+}
@@ -0,0 +1,392 @@
+#pragma once
+
+#include <stdexcept>
+#include <string>
+
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/benchmark/catch_benchmark.hpp>
+
+#include "referencesemantics/commandqueueexamples.h"
+#include "valuesemantics/commandqueueexamples.h"
+#include "valuesemantics/packedcommandqueue.h"
+#include "workingvalue.h"
+
+namespace ValueSemantics
+{
+    TEST_CASE("Packed Command Queue - Value Semantics - Unit Tests")
+    {
+        std::shared_ptr<WorkingValue> value{std::make_shared<WorkingValue>()};
+        PackedCommandQueue queue{};
+        REQUIRE(value->GetValue() == 0);
+        REQUIRE_FALSE(queue.HasPendingCommand());
+        REQUIRE_FALSE(queue.HasPendingRollbackCommand());
+        REQUIRE(queue.GetCommandIndex() == 0);
+        REQUIRE(queue.GetCommandQueueSize() == 0);
+
+        SECTION("Add Commands")
+        {
+            queue.QueueCommand(CreateCommand(value, 1));
+            REQUIRE(value->GetValue() == 0);
+            REQUIRE(queue.HasPendingCommand());
+            REQUIRE_FALSE(queue.HasPendingRollbackCommand());
+            REQUIRE(queue.GetCommandIndex() == 0);
+            REQUIRE(queue.GetCommandQueueSize() == 1);
+
+            queue.QueueCommand(CreateLambdaCommand(value, 2));
+            queue.EmplaceCommand<ModifyValueCommand>(value, 3);
+            REQUIRE(value->GetValue() == 0);
+            REQUIRE(queue.HasPendingCommand());
+            REQUIRE_FALSE(queue.HasPendingRollbackCommand());
+            REQUIRE(queue.GetCommandIndex() == 0);
+            REQUIRE(queue.GetCommandQueueSize() == 3);
+        }
+
+        SECTION("Execute Commands")
+        {
+            queue.QueueCommand(CreateLambdaCommand(value, 1));
+            queue.ExecuteCommand(); // +1
+            REQUIRE(value->GetValue() == 1);
+            REQUIRE_FALSE(queue.HasPendingCommand());
+            REQUIRE(queue.HasPendingRollbackCommand());
+            REQUIRE(queue.GetCommandIndex() == 1);
+            REQUIRE(queue.GetCommandQueueSize() == 1);
+
+            queue.QueueCommand(CreateLambdaCommand(value, 2));
+            queue.QueueCommand(CreateCommand(value, 3));
+            queue.QueueCommand(CreateLambdaCommand(value, 4));
+            queue.ExecuteCommand(); // +2
+            queue.ExecuteCommand(); // +3
+            queue.ExecuteCommand(); // +4
+            REQUIRE(value->GetValue() == 10);
+            REQUIRE_FALSE(queue.HasPendingCommand());
+            REQUIRE(queue.HasPendingRollbackCommand());
+            REQUIRE(queue.GetCommandIndex() == 4);
+            REQUIRE(queue.GetCommandQueueSize() == 4);
+        }
+
+        SECTION("Throwing Command")
+        {
+            // As CommandQueue, a command which throws isn't counted as executed or rolled back
+            queue.QueueCommand(CreateCommand(value, 1));
+            queue.QueueCommand(LambdaCommand{[] { throw std::runtime_error{"Execute"}; }, [] {}});
+            queue.ExecuteCommand(); // +1
+            REQUIRE_THROWS(queue.ExecuteCommand());
+            REQUIRE(queue.GetCommandIndex() == 1);
+            REQUIRE(queue.HasPendingCommand());
+
+            queue.ClearPendingCommands();
+            queue.QueueCommand(LambdaCommand{[] {}, [] { throw std::runtime_error{"Rollback"}; }});
+            queue.ExecuteCommand();
+            REQUIRE_THROWS(queue.RollbackCommand());
+            REQUIRE(queue.GetCommandIndex() == 2);
+            REQUIRE(value->GetValue() == 1);
+        }
+
+        SECTION("Clear Command Queue")
+        {
+            queue.QueueCommand(CreateCommand(value, 1));
+            queue.QueueCommand(CreateLambdaCommand(value, 2));
+            queue.QueueCommand(CreateLambdaCommand(value, 3));
+            queue.ExecuteCommand(); // +1
+            queue.ExecuteCommand(); // +2
+            queue.ExecuteCommand(); // +3
+            REQUIRE(value->GetValue() == 6);
+            REQUIRE(value.use_count() == 6);
+
+            queue.ClearQueue(); // Remove +1, +2, +3
+            REQUIRE(value->GetValue() == 6);
+            REQUIRE(value.use_count() == 1);
+            REQUIRE_FALSE(queue.HasPendingCommand());
+            REQUIRE_FALSE(queue.HasPendingRollbackCommand());
+            REQUIRE(queue.GetCommandIndex() == 0);
+            REQUIRE(queue.GetCommandQueueSize() == 0);
+            REQUIRE(queue.GetByteSize() == 0);
+        }
+
+        SECTION("Clear Commands")
+        {
+            queue.QueueCommand(CreateLambdaCommand(value, 1));
+            queue.QueueCommand(CreateCommand(value, 2));
+            queue.QueueCommand(CreateLambdaCommand(value, 3));
+            queue.ExecuteCommand(); // +1
+
+            queue.ClearPendingCommands(); // Remove +2, +3
+            REQUIRE(value->GetValue() == 1);
+            REQUIRE_FALSE(queue.HasPendingCommand());
+            REQUIRE(queue.HasPendingRollbackCommand());
+            REQUIRE(queue.GetCommandIndex() == 1);
+            REQUIRE(queue.GetCommandQueueSize() == 1);
+
+            queue.QueueCommand(CreateCommand(value, 5));
+            queue.QueueCommand(CreateLambdaCommand(value, 6));
+            queue.ExecuteCommand(); // +5
+            queue.ClearPendingCommands(); // Remove +6
+            REQUIRE(value->GetValue() == 6);
+            REQUIRE_FALSE(queue.HasPendingCommand());
+            REQUIRE(queue.GetCommandIndex() == 2);
+            REQUIRE(queue.GetCommandQueueSize() == 2);
+
+            queue.RollbackCommand(); // -5
+            queue.RollbackCommand(); // -1
+            REQUIRE(value->GetValue() == 0);
+            REQUIRE(queue.HasPendingCommand());
+            REQUIRE_FALSE(queue.HasPendingRollbackCommand());
+
+            queue.ClearPendingCommands(); // Remove +1, +5
+            REQUIRE_FALSE(queue.HasPendingCommand());
+            REQUIRE_FALSE(queue.HasPendingRollbackCommand());
+            REQUIRE(queue.GetCommandIndex() == 0);
+            REQUIRE(queue.GetCommandQueueSize() == 0);
+            REQUIRE(value.use_count() == 1);
+        }
+
+        SECTION("Execute Rollback Commands")
+        {
+            constexpr int32_t commandCount{10'000};
+            for(int32_t i{0}; i != commandCount; ++i)
+            {
+                if(i % 2 == 0)
+                    queue.QueueCommand(CreateCommand(value, i));
+                else
+                    queue.QueueCommand(CreateLambdaCommand(value, i));
+            }
+            REQUIRE(queue.GetCommandQueueSize() == commandCount);
+
+            while(queue.HasPendingCommand())
+            {
+                queue.ExecuteCommand();
+            }
+            REQUIRE(value->GetValue() == commandCount * (commandCount - 1) / 2);
+
+            queue.RollbackCommand(); // -9999
+            REQUIRE(value->GetValue() == (commandCount - 1) * (commandCount - 2) / 2);
+
+            while(queue.HasPendingRollbackCommand())
+            {
+                queue.RollbackCommand();
+            }
+            REQUIRE(value->GetValue() == 0);
+            REQUIRE(queue.GetCommandIndex() == 0);
+        }
+
+        SECTION("Move Command Queue")
+        {
+            queue.QueueCommand(CreateCommand(value, 1));
+            queue.QueueCommand(CreateLambdaCommand(value, 2));
+            queue.ExecuteCommand(); // +1
+
+            PackedCommandQueue moved{std::move(queue)};
+            REQUIRE(moved.GetCommandIndex() == 1);
+            REQUIRE(moved.GetCommandQueueSize() == 2);
+
+            moved.ExecuteCommand(); // +2
+            REQUIRE(value->GetValue() == 3);
+        }
+
+        SECTION("Bulk Cursor Commands")
+        {
+            queue.QueueCommand(CreateCommand(value, 1));
+            queue.QueueCommand(CreateCommand(value, 2));
+            queue.QueueCommand(CreateLambdaCommand(value, 3));
+            queue.QueueCommand(CreateLambdaCommand(value, 4));
+            queue.QueueCommand(CreateCommand(value, 5));
+
+            queue.ExecuteN(2); // +1, +2
+            REQUIRE(value->GetValue() == 3);
+            REQUIRE(queue.GetCommandIndex() == 2);
+
+            queue.ExecuteAll(); // +3, +4, +5
+            REQUIRE(value->GetValue() == 15);
+            REQUIRE_FALSE(queue.HasPendingCommand());
+            REQUIRE(queue.GetCommandIndex() == 5);
+
+            queue.RollbackTo(1); // -5, -4, -3, -2
+            REQUIRE(value->GetValue() == 1);
+            REQUIRE(queue.GetCommandIndex() == 1);
+
+            queue.SeekTo(4); // +2, +3, +4
+            REQUIRE(value->GetValue() == 10);
+            REQUIRE(queue.GetCommandIndex() == 4);
+
+            queue.SeekTo(3); // -4
+            REQUIRE(value->GetValue() == 6);
+            REQUIRE(queue.GetCommandIndex() == 3);
+
+            queue.SeekTo(3);
+            REQUIRE(value->GetValue() == 6);
+
+            queue.RollbackTo(0); // -3, -2, -1
+            REQUIRE(value->GetValue() == 0);
+            REQUIRE(queue.GetCommandIndex() == 0);
+            REQUIRE_FALSE(queue.HasPendingRollbackCommand());
+            REQUIRE(queue.GetCommandQueueSize() == 5);
+        }
+
+        SECTION("Bulk Cursor Runs")
+        {
+            for(int32_t i{0}; i != 100; ++i)
+            {
+                queue.QueueCommand(CreateCommand(value, 1));
+            }
+            queue.QueueCommand(CreateLambdaCommand(value, 1000));
+            for(int32_t i{0}; i != 100; ++i)
+            {
+                queue.QueueCommand(CreateCommand(value, 1));
+            }
+
+            queue.ExecuteN(50);
+            REQUIRE(value->GetValue() == 50);
+
+            queue.ExecuteN(75);
+            REQUIRE(value->GetValue() == 1124);
+            REQUIRE(queue.GetCommandIndex() == 125);
+
+            queue.RollbackTo(101);
+            REQUIRE(value->GetValue() == 1100);
+
+            queue.RollbackTo(25);
+            REQUIRE(value->GetValue() == 25);
+
+            queue.ExecuteAll();
+            REQUIRE(value->GetValue() == 1200);
+
+            queue.RollbackCommand();
+            REQUIRE(value->GetValue() == 1199);
+
+            queue.RollbackTo(0);
+            REQUIRE(value->GetValue() == 0);
+        }
+    }
+
+    TEST_CASE("Packed Command Queue - Value Semantics - Creation Benchmark")
+    {
+        for(const uint32_t commandCount : {10'000u, 100'000u, 1'000'000u})
+        {
+            const std::string suffix{" - " + std::to_string(commandCount)};
+
+            BENCHMARK("Reference Semantics" + suffix)
+            {
+                std::shared_ptr<WorkingValue> value{std::make_shared<WorkingValue>()};
+                ReferenceSemantics::CommandQueue queue{};
+
+                for(uint32_t i{0}; i != commandCount / 2; ++i)
+                {
+                    queue.QueueCommand(ReferenceSemantics::CreateCommand(value, 0));
+                    queue.QueueCommand(ReferenceSemantics::CreateLambdaCommand(value, 0));
+                }
+
+                while(queue.HasPendingCommand())
+                {
+                    queue.ExecuteCommand();
+                }
+
+                queue.ClearQueue();
+            };
+
+            BENCHMARK("Value Semantics" + suffix)
+            {
+                std::shared_ptr<WorkingValue> value{std::make_shared<WorkingValue>()};
+                CommandQueue queue{};
+
+                for(uint32_t i{0}; i != commandCount / 2; ++i)
+                {
+                    queue.QueueCommand(CreateCommand(value, 0));
+                    queue.QueueCommand(CreateLambdaCommand(value, 0));
+                }
+
+                while(queue.HasPendingCommand())
+                {
+                    queue.ExecuteCommand();
+                }
+
+                queue.ClearQueue();
+            };
+
+            BENCHMARK("Packed" + suffix)
+            {
+                std::shared_ptr<WorkingValue> value{std::make_shared<WorkingValue>()};
+                PackedCommandQueue queue{};
+
+                for(uint32_t i{0}; i != commandCount / 2; ++i)
+                {
+                    queue.QueueCommand(CreateCommand(value, 0));
+                    queue.QueueCommand(CreateLambdaCommand(value, 0));
+                }
+
+                while(queue.HasPendingCommand())
+                {
+                    queue.ExecuteCommand();
+                }
+
+                queue.ClearQueue();
+            };
+        }
+    }
+
+    TEST_CASE("Packed Command Queue - Value Semantics - Execute/Rollback Benchmark")
+    {
+        for(const uint32_t commandCount : {10'000u, 100'000u, 1'000'000u})
+        {
+            const std::string suffix{" - " + std::to_string(commandCount)};
+            std::shared_ptr<WorkingValue> value{std::make_shared<WorkingValue>()};
+            ReferenceSemantics::CommandQueue referenceQueue{};
+            CommandQueue valueQueue{};
+            PackedCommandQueue packedQueue{};
+
+            for(uint32_t i{0}; i != commandCount / 2; ++i)
+            {
+                referenceQueue.QueueCommand(ReferenceSemantics::CreateCommand(value, 0));
+                referenceQueue.QueueCommand(ReferenceSemantics::CreateLambdaCommand(value, 0));
+                valueQueue.QueueCommand(CreateCommand(value, 0));
+                valueQueue.QueueCommand(CreateLambdaCommand(value, 0));
+                packedQueue.QueueCommand(CreateCommand(value, 0));
+                packedQueue.QueueCommand(CreateLambdaCommand(value, 0));
+            }
+
+            BENCHMARK("Reference Semantics" + suffix)
+            {
+                while(referenceQueue.HasPendingCommand())
+                {
+                    referenceQueue.ExecuteCommand();
+                }
+
+                while(referenceQueue.HasPendingRollbackCommand())
+                {
+                    referenceQueue.RollbackCommand();
+                }
+            };
+
+            BENCHMARK("Value Semantics" + suffix)
+            {
+                while(valueQueue.HasPendingCommand())
+                {
+                    valueQueue.ExecuteCommand();
+                }
+
+                while(valueQueue.HasPendingRollbackCommand())
+                {
+                    valueQueue.RollbackCommand();
+                }
+            };
+
+            BENCHMARK("Packed" + suffix)
+            {
+                while(packedQueue.HasPendingCommand())
+                {
+                    packedQueue.ExecuteCommand();
+                }
+
+                while(packedQueue.HasPendingRollbackCommand())
+                {
+                    packedQueue.RollbackCommand();
+                }
+            };
+
+            BENCHMARK("Packed - Bulk" + suffix)
+            {
+                packedQueue.ExecuteAll();
+                packedQueue.RollbackTo(0);
+            };
+        }
+    }
+}
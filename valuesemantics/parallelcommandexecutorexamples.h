@@ -0,0 +1,255 @@
+#pragma once
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/benchmark/catch_benchmark.hpp>
+
+#include "valuesemantics/commandqueueexamples.h"
+#include "commandaccess.h"
+#include "parallelcommandexecutor.h"
+#include "threadpool.h"
+#include "workingvalue.h"
+
+namespace ValueSemantics
+{
+    namespace
+    {
+        /// Adds the source value to the target value, reading one resource and writing another.
+        class AddValueCommand
+        {
+        public:
+            AddValueCommand(WorkingValue& source, WorkingValue& target)
+                : m_Source{&source}
+                , m_Target{&target}
+            {
+            }
+
+            void Execute()
+            {
+                m_Added = m_Source->GetValue();
+                m_Target->ModifyValue(m_Added);
+            }
+
+            void Rollback()
+            {
+                m_Target->ModifyValue(-m_Added);
+            }
+
+            bool DeclareAccess(CommandAccess& access) const
+            {
+                access.Read(m_Source);
+                access.Write(m_Target);
+                return true;
+            }
+        private:
+            WorkingValue* m_Source{nullptr};
+            WorkingValue* m_Target{nullptr};
+            WorkingValue::ValueType m_Added{0};
+        };
+
+        /// Runs cost iterations of busy work before modifying its value, to simulate commands of uneven cost.
+        class BusyCommand
+        {
+        public:
+            BusyCommand(WorkingValue& target, const uint32_t cost)
+                : m_Target{&target}
+                , m_Cost{cost}
+            {
+            }
+
+            void Execute()
+            {
+                uint32_t state{m_Cost};
+                for(uint32_t i{0}; i != m_Cost; ++i)
+                {
+                    state = state * 1'664'525u + 1'013'904'223u;
+                }
+                m_Modification = static_cast<WorkingValue::ValueType>(state & 1) + 1;
+                m_Target->ModifyValue(m_Modification);
+            }
+
+            void Rollback()
+            {
+                m_Target->ModifyValue(-m_Modification);
+            }
+
+            bool DeclareAccess(CommandAccess& access) const
+            {
+                access.Write(m_Target);
+                return true;
+            }
+        private:
+            WorkingValue* m_Target{nullptr};
+            uint32_t m_Cost{0};
+            WorkingValue::ValueType m_Modification{0};
+        };
+
+        [[nodiscard]] static std::vector<std::shared_ptr<WorkingValue>> CreateValues(const uint32_t count)
+        {
+            std::vector<std::shared_ptr<WorkingValue>> values{};
+            values.reserve(count);
+            for(uint32_t i{0}; i != count; ++i)
+            {
+                values.push_back(std::make_shared<WorkingValue>());
+            }
+            return values;
+        }
+    }
+
+    TEST_CASE("Parallel Command Executor - Value Semantics - Unit Tests")
+    {
+        ThreadPool pool{4};
+        ParallelCommandExecutor executor{pool, 4};
+        REQUIRE(pool.GetThreadCount() == 4);
+        REQUIRE(executor.GetWaveCount() == 0);
+
+        SECTION("Conflict Free Waves")
+        {
+            std::vector<WorkingValue> values(3);
+            values[0].SetValue(1);
+            std::vector<AddValueCommand> commands{
+                {values[0], values[1]}, // Wave 0
+                {values[0], values[2]}, // Wave 0, reads don't conflict
+                {values[1], values[0]}, // Wave 1, writes what the first two read
+                {values[2], values[2]}, // Wave 1
+                {values[0], values[1]}}; // Wave 2
+
+            executor.Execute(std::span{commands});
+            REQUIRE(executor.GetWaveCount() == 3);
+            REQUIRE(values[0].GetValue() == 2);
+            REQUIRE(values[1].GetValue() == 3);
+            REQUIRE(values[2].GetValue() == 2);
+
+            executor.Rollback(std::span{commands});
+            REQUIRE(values[0].GetValue() == 1);
+            REQUIRE(values[1].GetValue() == 0);
+            REQUIRE(values[2].GetValue() == 0);
+        }
+
+        SECTION("Thread Pool Ranges")
+        {
+            std::vector<uint32_t> visitCounts(1'000);
+            pool.ParallelFor(static_cast<uint32_t>(visitCounts.size()), 7,
+                [&visitCounts](const uint32_t begin, const uint32_t end)
+                {
+                    for(uint32_t index{begin}; index != end; ++index)
+                    {
+                        ++visitCounts[index];
+                    }
+                });
+
+            REQUIRE(std::all_of(std::begin(visitCounts), std::end(visitCounts), [](const uint32_t count) { return count == 1; }));
+        }
+
+        SECTION("Same Result As Serial")
+        {
+            std::vector<std::shared_ptr<WorkingValue>> values{CreateValues(16)};
+            std::vector<int32_t> serialValues(values.size());
+            CommandQueue queue{};
+
+            for(uint32_t i{0}; i != 10'000; ++i)
+            {
+                const uint32_t target{(i * 7) % 16};
+                const int32_t modification{static_cast<int32_t>(i % 13)};
+                serialValues[target] += modification;
+
+                if(i % 1'000 == 999)
+                    queue.QueueCommand(CreateLambdaCommand(values[target], modification)); // Undeclared, runs alone
+                else
+                    queue.QueueCommand(CreateCommand(values[target], modification));
+            }
+
+            queue.ExecuteAll(executor);
+            REQUIRE_FALSE(queue.HasPendingCommand());
+            REQUIRE(queue.GetCommandIndex() == 10'000);
+            REQUIRE(executor.GetWaveCount() >= 10'000 / 16);
+            for(uint32_t i{0}; i != values.size(); ++i)
+            {
+                REQUIRE(values[i]->GetValue() == serialValues[i]);
+            }
+
+            queue.RollbackTo(5'000, executor);
+            REQUIRE(queue.GetCommandIndex() == 5'000);
+            queue.RollbackTo(0); // Serial rollback of the rest
+            for(const std::shared_ptr<WorkingValue>& value : values)
+            {
+                REQUIRE(value->GetValue() == 0);
+            }
+        }
+    }
+
+    TEST_CASE("Parallel Command Executor - Value Semantics - Execute/Rollback Benchmark")
+    {
+        constexpr uint32_t commandCount{1'000'000};
+        ThreadPool pool{};
+        ParallelCommandExecutor executor{pool};
+
+        for(const uint32_t targetCount : {1'000u, 100u, 1u})
+        {
+            std::vector<std::shared_ptr<WorkingValue>> values{CreateValues(targetCount)};
+            CommandQueue queue{};
+            for(uint32_t i{0}; i != commandCount; ++i)
+            {
+                queue.QueueCommand(CreateCommand(values[i % targetCount], 1));
+            }
+
+            BENCHMARK("Serial - " + std::to_string(targetCount) + " Targets")
+            {
+                queue.ExecuteAll();
+                queue.RollbackTo(0);
+            };
+
+            BENCHMARK("Parallel - " + std::to_string(targetCount) + " Targets")
+            {
+                queue.ExecuteAll(executor);
+                queue.RollbackTo(0, executor);
+            };
+        }
+    }
+
+    TEST_CASE("Parallel Command Executor - Value Semantics - Skewed Benchmark")
+    {
+        // Every 500th command is 1000x more expensive than the rest
+        constexpr uint32_t commandCount{20'000};
+        std::vector<WorkingValue> values(commandCount);
+        std::vector<BusyCommand> commands{};
+        commands.reserve(commandCount);
+        for(uint32_t i{0}; i != commandCount; ++i)
+        {
+            commands.emplace_back(values[i], i % 500 == 0 ? 100'000u : 100u);
+        }
+
+        BENCHMARK("Serial")
+        {
+            for(BusyCommand& command : commands)
+            {
+                command.Execute();
+            }
+
+            for(auto command{std::rbegin(commands)}; command != std::rend(commands); ++command)
+            {
+                command->Rollback();
+            }
+        };
+
+        std::string stealCounts{};
+        for(const uint32_t threadCount : {1u, 2u, 4u, 8u})
+        {
+            ThreadPool pool{threadCount};
+            ParallelCommandExecutor executor{pool, 64};
+
+            BENCHMARK("Work Stealing - " + std::to_string(threadCount) + " Threads")
+            {
+                executor.Execute(std::span{commands});
+                executor.Rollback(std::span{commands});
+            };
+
+            stealCounts += (stealCounts.empty() ? "" : ", ") + std::to_string(threadCount) + " threads: " + std::to_string(pool.GetStealCount());
+        }
+
+        WARN("Ranges stolen with " << stealCounts);
+    }
+}
@@ -0,0 +1,225 @@
+#pragma once
+
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/benchmark/catch_benchmark.hpp>
+
+#include <array>
+#include <random>
+
+#include "valuesemantics/commandqueueexamples.h"
+#include "workingvalue.h"
+
+namespace ValueSemantics
+{
+    TEST_CASE("Peephole Optimization - Value Semantics - Unit Tests")
+    {
+        std::shared_ptr<WorkingValue> value{std::make_shared<WorkingValue>()};
+        std::shared_ptr<WorkingValue> otherValue{std::make_shared<WorkingValue>()};
+        CommandQueue queue{};
+
+        SECTION("Cancel Inverse Pair")
+        {
+            queue.QueueCommand(CreateCommand(value, 3));
+            queue.QueueCommand(CreateCommand(value, -3));
+            const PeepholeStatistics statistics{queue.OptimizePendingCommands()};
+            REQUIRE(statistics.m_FoldedCount == 1);
+            REQUIRE(statistics.m_NoOpCount == 1);
+            REQUIRE(statistics.GetEliminatedCount() == 2);
+            REQUIRE(queue.GetCommandQueueSize() == 0);
+            REQUIRE(value.use_count() == 1);
+        }
+
+        SECTION("Fold Chain Across Other Targets")
+        {
+            queue.QueueCommand(CreateCommand(value, 1));
+            queue.QueueCommand(CreateCommand(otherValue, 2));
+            queue.QueueCommand(CreateCommand(value, 4));
+            queue.QueueCommand(CreateCommand(otherValue, -2)); // Cancels +2
+            queue.QueueCommand(CreateCommand(value, 8));
+            queue.QueueCommand(CreateCommand(value, 0)); // No-op
+            const PeepholeStatistics statistics{queue.OptimizePendingCommands()};
+            REQUIRE(statistics.m_FoldedCount == 3);
+            REQUIRE(statistics.m_NoOpCount == 2);
+            REQUIRE(queue.GetCommandQueueSize() == 1);
+
+            queue.ExecuteCommand(); // +13
+            REQUIRE(value->GetValue() == 13);
+            REQUIRE(otherValue->GetValue() == 0);
+            queue.RollbackCommand();
+            REQUIRE(value->GetValue() == 0);
+        }
+
+        SECTION("Executed History Is Kept")
+        {
+            queue.QueueCommand(CreateCommand(value, 1));
+            queue.ExecuteCommand(); // +1
+            queue.QueueCommand(CreateCommand(value, -1));
+            queue.QueueCommand(CreateCommand(value, 2));
+            REQUIRE(queue.OptimizePendingCommands().GetEliminatedCount() == 1);
+            REQUIRE(queue.GetCommandQueueSize() == 2);
+
+            queue.ExecuteAll(); // +1
+            REQUIRE(value->GetValue() == 2);
+            queue.RollbackTo(0); // -1, -1
+            REQUIRE(value->GetValue() == 0);
+        }
+
+        SECTION("Barriers")
+        {
+            // Lambdas have no target key, nothing folds across them
+            queue.QueueCommand(CreateCommand(value, 1));
+            queue.QueueCommand(CreateLambdaCommand(value, 2));
+            queue.QueueCommand(CreateCommand(value, -1));
+
+            // Groups are kept whole
+            queue.BeginGroup();
+            queue.QueueCommand(CreateCommand(value, 4));
+            queue.QueueCommand(CreateCommand(value, -4));
+            queue.EndGroup();
+            queue.QueueCommand(CreateCommand(value, -1));
+
+            // Open groups are left alone
+            queue.BeginGroup();
+            queue.QueueCommand(CreateCommand(value, 0));
+
+            REQUIRE(queue.OptimizePendingCommands().GetEliminatedCount() == 0);
+            REQUIRE(queue.GetCommandQueueSize() == 5);
+            REQUIRE(queue.GetStoredCommandCount() == 7);
+
+            queue.EndGroup();
+            const PeepholeStatistics statistics{queue.OptimizePendingCommands()}; // The group of one no-op
+            REQUIRE(statistics.m_NoOpCount == 1);
+            REQUIRE(queue.GetCommandQueueSize() == 5);
+
+            queue.ExecuteAll();
+            REQUIRE(value->GetValue() == 1);
+        }
+
+        SECTION("Fold Behind Open Group")
+        {
+            queue.QueueCommand(CreateCommand(value, 1));
+            queue.QueueCommand(CreateCommand(value, 1));
+            queue.BeginGroup();
+            queue.QueueCommand(CreateCommand(otherValue, 2));
+            REQUIRE(queue.OptimizePendingCommands().m_FoldedCount == 1);
+            REQUIRE(queue.GetStoredCommandCount() == 2);
+            queue.EndGroup();
+
+            queue.ExecuteAll();
+            REQUIRE(value->GetValue() == 2);
+            REQUIRE(otherValue->GetValue() == 2);
+        }
+    }
+
+    TEST_CASE("Peephole Optimization - Value Semantics - Benchmark")
+    {
+        constexpr uint32_t frameCount{1'000};
+        constexpr uint32_t valueCount{8};
+        std::array<std::shared_ptr<WorkingValue>, valueCount> values{};
+        for(std::shared_ptr<WorkingValue>& value : values)
+        {
+            value = std::make_shared<WorkingValue>();
+        }
+
+        // Recorded style trace: each frame gameplay code adjusts a few values, cancels some adjustments
+        // with their inverse, and queues zero adjustments from inputs that didn't change anything
+        struct TraceCommand
+        {
+            uint32_t m_Value{0};
+            int32_t m_Modification{0};
+        };
+        std::vector<std::vector<TraceCommand>> frames(frameCount);
+        std::minstd_rand random{7};
+        for(std::vector<TraceCommand>& frame : frames)
+        {
+            const uint32_t adjustmentCount{16 + static_cast<uint32_t>(random() % 48)};
+            for(uint32_t i{0}; i != adjustmentCount; ++i)
+            {
+                const TraceCommand command{static_cast<uint32_t>(random() % valueCount),
+                    static_cast<int32_t>(random() % 7) - 3};
+                frame.push_back(command);
+                if(random() % 4 == 0)
+                    frame.push_back(TraceCommand{command.m_Value, -command.m_Modification});
+            }
+        }
+
+        const auto queueFrame{[&values](CommandQueue& queue, const std::vector<TraceCommand>& frame)
+            {
+                for(const TraceCommand& command : frame)
+                {
+                    queue.QueueCommand(CreateCommand(values[command.m_Value], command.m_Modification));
+                }
+            }};
+
+        {
+            CommandQueue queue{};
+            uint32_t queuedCount{0};
+            uint32_t eliminatedCount{0};
+            for(const std::vector<TraceCommand>& frame : frames)
+            {
+                queueFrame(queue, frame);
+                queuedCount += static_cast<uint32_t>(frame.size());
+                eliminatedCount += queue.OptimizePendingCommands().GetEliminatedCount();
+                queue.ExecuteAll();
+            }
+            REQUIRE(queue.GetCommandQueueSize() == queuedCount - eliminatedCount);
+            WARN("Eliminated " << eliminatedCount << " of " << queuedCount << " commands");
+
+            queue.RollbackTo(0);
+            for(const std::shared_ptr<WorkingValue>& value : values)
+            {
+                REQUIRE(value->GetValue() == 0);
+            }
+        }
+
+        // Recording pays for the pass once per frame
+        BENCHMARK("Record Unoptimized")
+        {
+            CommandQueue queue{};
+            for(const std::vector<TraceCommand>& frame : frames)
+            {
+                queueFrame(queue, frame);
+                queue.ExecuteAll();
+            }
+            queue.RollbackTo(0);
+        };
+
+        BENCHMARK("Record Optimized")
+        {
+            CommandQueue queue{};
+            for(const std::vector<TraceCommand>& frame : frames)
+            {
+                queueFrame(queue, frame);
+                queue.OptimizePendingCommands();
+                queue.ExecuteAll();
+            }
+            queue.RollbackTo(0);
+        };
+
+        // Every later undo, redo or replay of the history only pays for the commands left
+        CommandQueue unoptimizedQueue{};
+        CommandQueue optimizedQueue{};
+        for(const std::vector<TraceCommand>& frame : frames)
+        {
+            queueFrame(unoptimizedQueue, frame);
+            unoptimizedQueue.ExecuteAll();
+            queueFrame(optimizedQueue, frame);
+            optimizedQueue.OptimizePendingCommands();
+            optimizedQueue.ExecuteAll();
+        }
+        unoptimizedQueue.RollbackTo(0);
+        optimizedQueue.RollbackTo(0);
+
+        BENCHMARK("Replay Unoptimized")
+        {
+            unoptimizedQueue.ExecuteAll();
+            unoptimizedQueue.RollbackTo(0);
+        };
+
+        BENCHMARK("Replay Optimized")
+        {
+            optimizedQueue.ExecuteAll();
+            optimizedQueue.RollbackTo(0);
+        };
+    }
+}
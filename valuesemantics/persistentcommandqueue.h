@@ -0,0 +1,288 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "valuesemantics/commandqueue.h"
+
+namespace ValueSemantics
+{
+    /// Command queue whose copies share their commands, so forking a queue is O(1) regardless of its size.
+    /// Commands are stored in a persistent 32-way trie of full leaves plus a tail leaf taking new commands.
+    /// A copy only clones the nodes it modifies: appending clones the tail, at most 31 commands, and pushing a full tail
+    /// into the trie copies one node per level. ClearPendingCommands() clones the commands of the new tail.
+    /// Forks may be read, executed and modified on different threads at the same time, since shared nodes are never
+    /// modified, as long as each fork is only used by one thread. Executing a fork executes the commands it shares,
+    /// so Execute() and Rollback() must not modify the command itself.
+    class PersistentCommandQueue
+    {
+    public:
+        /// HasPendingCommand() has to be true before calling
+        void ExecuteCommand()
+        {
+            GetCommand(m_CommandIndex).Execute();
+            ++m_CommandIndex;
+        }
+
+        /// HasPendingRollbackCommand() has to be true before calling
+        void RollbackCommand()
+        {
+            --m_CommandIndex;
+            GetCommand(m_CommandIndex).Rollback();
+        }
+
+        /// Executes every pending command.
+        void ExecuteAll()
+        {
+            ExecuteN(GetCommandQueueSize() - m_CommandIndex);
+        }
+
+        /// Executes a leaf of commands at a time rather than walking the trie for each.
+        /// count has to be no greater than the number of pending commands
+        void ExecuteN(const uint32_t count)
+        {
+            const uint32_t end{m_CommandIndex + count};
+            while(m_CommandIndex != end)
+            {
+                std::vector<Command>& commands{GetLeaf(m_CommandIndex).m_Commands};
+                const uint32_t leafEnd{std::min(end, (m_CommandIndex & ~BranchMask) + BranchFactor)};
+                for(; m_CommandIndex != leafEnd; ++m_CommandIndex)
+                {
+                    commands[m_CommandIndex & BranchMask].Execute();
+                }
+            }
+        }
+
+        /// Rolls back commands until GetCommandIndex() == index.
+        /// index has to be no greater than GetCommandIndex()
+        void RollbackTo(const uint32_t index)
+        {
+            while(m_CommandIndex != index)
+            {
+                std::vector<Command>& commands{GetLeaf(m_CommandIndex - 1).m_Commands};
+                const uint32_t leafBegin{std::max(index, (m_CommandIndex - 1) & ~BranchMask)};
+                for(; m_CommandIndex != leafBegin; --m_CommandIndex)
+                {
+                    commands[(m_CommandIndex - 1) & BranchMask].Rollback();
+                }
+            }
+        }
+
+        /// Executes or rolls back commands until GetCommandIndex() == index.
+        /// index has to be no greater than GetCommandQueueSize()
+        void SeekTo(const uint32_t index)
+        {
+            if(index > m_CommandIndex)
+                ExecuteN(index - m_CommandIndex);
+            else
+                RollbackTo(index);
+        }
+
+        void ClearQueue()
+        {
+            m_Root.reset();
+            m_Tail.reset();
+            m_Shift = BranchBits;
+            m_Size = 0;
+            m_CommandIndex = 0;
+        }
+
+        /// Removes any commands ahead of and including the current pending command.
+        /// HasPendingCommand() has to be true before calling
+        void ClearPendingCommands()
+        {
+            Truncate(m_CommandIndex);
+        }
+
+        [[nodiscard]] bool HasPendingCommand() const
+        {
+            return GetCommandQueueSize() > m_CommandIndex;
+        }
+
+        [[nodiscard]] bool HasPendingRollbackCommand() const
+        {
+            return m_CommandIndex != 0 && GetCommandQueueSize() >= m_CommandIndex;
+        }
+
+        void QueueCommand(Command&& command)
+        {
+            if(m_Tail && m_Tail->m_Commands.size() == BranchFactor)
+                PushTail();
+
+            if(!m_Tail)
+            {
+                m_Tail = std::make_shared<Node>();
+                m_Tail->m_Commands.reserve(BranchFactor);
+            }
+            else if(!IsUnique(m_Tail))
+            {
+                m_Tail = CloneLeaf(*m_Tail, static_cast<uint32_t>(m_Tail->m_Commands.size()));
+            }
+
+            m_Tail->m_Commands.push_back(std::move(command));
+            ++m_Size;
+        }
+
+        [[nodiscard]] uint32_t GetCommandIndex() const
+        {
+            return m_CommandIndex;
+        }
+
+        [[nodiscard]] uint32_t GetCommandQueueSize() const
+        {
+            return m_Size;
+        }
+    private:
+        static constexpr uint32_t BranchBits{5};
+        static constexpr uint32_t BranchFactor{1u << BranchBits};
+        static constexpr uint32_t BranchMask{BranchFactor - 1};
+
+        /// Inner nodes only use m_Children, leaves only use m_Commands.
+        struct Node
+        {
+            std::vector<std::shared_ptr<Node>> m_Children{};
+            std::vector<Command> m_Commands{};
+        };
+
+        /// Index of the first command in the tail, every command before it is in a full leaf of the trie.
+        [[nodiscard]] uint32_t GetTailOffset() const
+        {
+            return m_Size == 0 ? 0 : (m_Size - 1) & ~BranchMask;
+        }
+
+        [[nodiscard]] Node& GetLeaf(const uint32_t index) const
+        {
+            if(index >= GetTailOffset())
+                return *m_Tail;
+
+            Node* node{m_Root.get()};
+            for(uint32_t shift{m_Shift}; shift != 0; shift -= BranchBits)
+            {
+                node = node->m_Children[(index >> shift) & BranchMask].get();
+            }
+            return *node;
+        }
+
+        [[nodiscard]] Command& GetCommand(const uint32_t index) const
+        {
+            return GetLeaf(index).m_Commands[index & BranchMask];
+        }
+
+        [[nodiscard]] static std::shared_ptr<Node> CloneLeaf(const Node& leaf, const uint32_t count)
+        {
+            std::shared_ptr<Node> clone{std::make_shared<Node>()};
+            clone->m_Commands.reserve(BranchFactor);
+            clone->m_Commands.assign(leaf.m_Commands.begin(), leaf.m_Commands.begin() + count);
+            return clone;
+        }
+
+        /// True when no other queue shares node, which may then be modified in place.
+        /// The fence pairs with the release of the last other owner's reference, so its reads of node happen before
+        /// the caller modifies it.
+        [[nodiscard]] static bool IsUnique(const std::shared_ptr<Node>& node)
+        {
+            if(node.use_count() != 1)
+                return false;
+
+            std::atomic_thread_fence(std::memory_order_acquire);
+            return true;
+        }
+
+        /// Replaces node with a copy of itself unless no other queue shares it.
+        static void MakeUnique(std::shared_ptr<Node>& node)
+        {
+            if(!IsUnique(node))
+                node = std::make_shared<Node>(Node{node->m_Children, {}});
+        }
+
+        /// Moves the full tail into the trie, adding a level when the trie is full.
+        void PushTail()
+        {
+            const uint32_t tailOffset{GetTailOffset()};
+            if(!m_Root)
+            {
+                m_Root = std::make_shared<Node>();
+            }
+            else if((tailOffset >> BranchBits) >= (1u << m_Shift))
+            {
+                std::shared_ptr<Node> root{std::make_shared<Node>()};
+                root->m_Children.push_back(std::move(m_Root));
+                m_Root = std::move(root);
+                m_Shift += BranchBits;
+            }
+            else
+            {
+                MakeUnique(m_Root);
+            }
+
+            Node* node{m_Root.get()};
+            for(uint32_t shift{m_Shift}; shift != BranchBits; shift -= BranchBits)
+            {
+                const uint32_t childIndex{(tailOffset >> shift) & BranchMask};
+                if(childIndex == node->m_Children.size())
+                    node->m_Children.push_back(std::make_shared<Node>());
+                else
+                    MakeUnique(node->m_Children[childIndex]);
+
+                node = node->m_Children[childIndex].get();
+            }
+            node->m_Children.push_back(std::move(m_Tail));
+        }
+
+        /// Keeps the first size commands. Nodes holding only kept commands stay shared,
+        /// the nodes on the path to the new tail are copied.
+        void Truncate(const uint32_t size)
+        {
+            if(size == 0)
+            {
+                ClearQueue();
+                return;
+            }
+
+            const uint32_t tailOffset{(size - 1) & ~BranchMask};
+            std::shared_ptr<Node> tail{CloneLeaf(GetLeaf(tailOffset), size - tailOffset)};
+
+            if(tailOffset == 0)
+            {
+                m_Root.reset();
+                m_Shift = BranchBits;
+            }
+            else
+            {
+                m_Root = TruncateNode(m_Root, m_Shift, tailOffset - 1);
+                while(m_Shift > BranchBits && m_Root->m_Children.size() == 1)
+                {
+                    std::shared_ptr<Node> child{m_Root->m_Children.front()};
+                    m_Root = std::move(child);
+                    m_Shift -= BranchBits;
+                }
+            }
+
+            m_Tail = std::move(tail);
+            m_Size = size;
+        }
+
+        /// Copy of node keeping the children up to and including the one holding lastIndex.
+        [[nodiscard]] static std::shared_ptr<Node> TruncateNode(const std::shared_ptr<Node>& node,
+            const uint32_t shift, const uint32_t lastIndex)
+        {
+            const uint32_t lastChild{(lastIndex >> shift) & BranchMask};
+            std::shared_ptr<Node> copy{std::make_shared<Node>()};
+            copy->m_Children.assign(node->m_Children.begin(), node->m_Children.begin() + lastChild + 1);
+            if(shift != BranchBits)
+                copy->m_Children.back() = TruncateNode(copy->m_Children.back(), shift - BranchBits, lastIndex);
+
+            return copy;
+        }
+
+        std::shared_ptr<Node> m_Root{};
+        std::shared_ptr<Node> m_Tail{};
+        /// Bits of a command index consumed above the leaves, BranchBits for a root whose children are leaves.
+        uint32_t m_Shift{BranchBits};
+        uint32_t m_Size{0};
+        uint32_t m_CommandIndex{0};
+    };
+}
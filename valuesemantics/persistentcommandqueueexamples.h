@@ -0,0 +1,249 @@
+#pragma once
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/benchmark/catch_benchmark.hpp>
+
+#include "valuesemantics/commandqueueexamples.h"
+#include "valuesemantics/persistentcommandqueue.h"
+#include "workingvalue.h"
+
+namespace ValueSemantics
+{
+    TEST_CASE("Persistent Command Queue - Value Semantics - Unit Tests")
+    {
+        constexpr uint32_t commandCount{2'000};
+        std::shared_ptr<WorkingValue> value{std::make_shared<WorkingValue>()};
+        PersistentCommandQueue queue{};
+        REQUIRE_FALSE(queue.HasPendingCommand());
+        REQUIRE_FALSE(queue.HasPendingRollbackCommand());
+
+        for(uint32_t i{0}; i != commandCount; ++i)
+        {
+            queue.QueueCommand(i % 2 == 0 ? Command{CreateCommand(value, 1)} : Command{CreateLambdaCommand(value, 1)});
+        }
+        REQUIRE(queue.GetCommandQueueSize() == commandCount);
+
+        SECTION("Execute Rollback Commands")
+        {
+            queue.ExecuteCommand();
+            queue.ExecuteN(1'500);
+            REQUIRE(value->GetValue() == 1'501);
+
+            queue.RollbackCommand();
+            queue.RollbackTo(33);
+            REQUIRE(value->GetValue() == 33);
+
+            queue.SeekTo(1'999);
+            REQUIRE(value->GetValue() == 1'999);
+
+            queue.ExecuteAll();
+            REQUIRE(value->GetValue() == 2'000);
+            REQUIRE_FALSE(queue.HasPendingCommand());
+
+            queue.RollbackTo(0);
+            REQUIRE(value->GetValue() == 0);
+        }
+
+        SECTION("Fork Shares Commands")
+        {
+            const long useCount{value.use_count()};
+            PersistentCommandQueue fork{queue};
+            REQUIRE(value.use_count() == useCount);
+            REQUIRE(fork.GetCommandQueueSize() == commandCount);
+
+            fork.QueueCommand(CreateCommand(value, 1'000)); // Clones the 16 commands of the shared tail
+            REQUIRE(value.use_count() == useCount + 8 + 8 * 2 + 1);
+            REQUIRE(fork.GetCommandQueueSize() == commandCount + 1);
+            REQUIRE(queue.GetCommandQueueSize() == commandCount);
+
+            for(uint32_t i{0}; i != 100; ++i)
+            {
+                fork.QueueCommand(CreateCommand(value, 1));
+            }
+
+            fork.ExecuteAll();
+            REQUIRE(value->GetValue() == 3'100);
+            fork.RollbackTo(0);
+
+            queue.ExecuteAll();
+            REQUIRE(value->GetValue() == 2'000);
+            queue.RollbackTo(0);
+
+            fork = PersistentCommandQueue{};
+            REQUIRE(value.use_count() == useCount);
+        }
+
+        SECTION("Clear Pending Commands Of A Fork")
+        {
+            PersistentCommandQueue fork{queue};
+            fork.ExecuteN(40);
+            fork.ClearPendingCommands();
+            REQUIRE(fork.GetCommandQueueSize() == 40);
+            REQUIRE(queue.GetCommandQueueSize() == commandCount);
+
+            fork.QueueCommand(CreateCommand(value, 100));
+            fork.ExecuteAll();
+            REQUIRE(value->GetValue() == 140);
+            fork.RollbackTo(0);
+
+            queue.ExecuteAll();
+            REQUIRE(value->GetValue() == 2'000);
+
+            queue.RollbackTo(1'024);
+            queue.ClearPendingCommands();
+            queue.QueueCommand(CreateCommand(value, 1));
+            REQUIRE(queue.GetCommandQueueSize() == 1'025);
+            queue.RollbackTo(0);
+            queue.ExecuteAll();
+            REQUIRE(value->GetValue() == 1'025);
+        }
+
+        SECTION("Fork On Many Threads")
+        {
+            constexpr uint32_t threadCount{4};
+            std::vector<uint32_t> forkSizes(threadCount);
+            std::vector<std::thread> threads{};
+            for(uint32_t threadIndex{0}; threadIndex != threadCount; ++threadIndex)
+            {
+                threads.emplace_back(
+                    [&, threadIndex]
+                    {
+                        PersistentCommandQueue fork{queue};
+                        for(uint32_t i{0}; i != 1'000 * threadIndex; ++i)
+                        {
+                            fork.QueueCommand(CreateCommand(value, 0));
+                        }
+                        fork.RollbackTo(0);
+                        fork.ClearPendingCommands();
+                        forkSizes[threadIndex] = fork.GetCommandQueueSize();
+                    });
+            }
+
+            for(std::thread& thread : threads)
+            {
+                thread.join();
+            }
+
+            REQUIRE(forkSizes == std::vector<uint32_t>(threadCount, 0));
+            REQUIRE(queue.GetCommandQueueSize() == commandCount);
+            queue.ExecuteAll();
+            REQUIRE(value->GetValue() == 2'000);
+        }
+
+        SECTION("Fork Append Destroy Stress")
+        {
+            constexpr uint32_t threadCount{4};
+            constexpr uint32_t roundCount{200};
+            constexpr uint32_t commandsPerRound{8};
+            std::shared_ptr<std::atomic<uint32_t>> executedCount{std::make_shared<std::atomic<uint32_t>>(0)};
+            const auto createCountingCommand{
+                [&executedCount]
+                {
+                    return LambdaCommand{
+                        [executedCount]
+                        {
+                            executedCount->fetch_add(1, std::memory_order_relaxed);
+                        },
+                        [executedCount]
+                        {
+                            executedCount->fetch_sub(1, std::memory_order_relaxed);
+                        }};
+                }};
+
+            // Forks read the nodes they share with queue and release them while queue appends, once the forks are gone
+            // queue appends to its tail in place
+            queue.ClearQueue();
+            uint32_t expectedCount{0};
+            for(uint32_t round{0}; round != roundCount; ++round)
+            {
+                std::vector<std::thread> threads{};
+                for(uint32_t threadIndex{0}; threadIndex != threadCount; ++threadIndex)
+                {
+                    threads.emplace_back(
+                        [&createCountingCommand, fork = queue]() mutable
+                        {
+                            for(uint32_t i{0}; i != commandsPerRound; ++i)
+                            {
+                                fork.QueueCommand(createCountingCommand());
+                            }
+                            fork.ExecuteAll();
+                        });
+                    expectedCount += queue.GetCommandQueueSize() + commandsPerRound;
+                }
+
+                for(uint32_t i{0}; i != commandsPerRound; ++i)
+                {
+                    queue.QueueCommand(createCountingCommand());
+                }
+
+                for(std::thread& thread : threads)
+                {
+                    thread.join();
+                }
+
+                for(uint32_t i{0}; i != commandsPerRound; ++i)
+                {
+                    queue.QueueCommand(createCountingCommand());
+                }
+            }
+
+            REQUIRE(executedCount->load() == expectedCount);
+            REQUIRE(queue.GetCommandQueueSize() == 2 * roundCount * commandsPerRound);
+            queue.ExecuteAll();
+            REQUIRE(executedCount->load() == expectedCount + queue.GetCommandQueueSize());
+            queue.RollbackTo(0);
+            REQUIRE(executedCount->load() == expectedCount);
+        }
+    }
+
+    TEST_CASE("Persistent Command Queue - Value Semantics - Fork Benchmark")
+    {
+        constexpr uint32_t historySize{1'000'000};
+        constexpr uint32_t appendCount{100};
+        std::shared_ptr<WorkingValue> value{std::make_shared<WorkingValue>()};
+
+        CommandQueue queue{};
+        PersistentCommandQueue persistentQueue{};
+        for(uint32_t i{0}; i != historySize; ++i)
+        {
+            queue.QueueCommand(CreateCommand(value, 1));
+            persistentQueue.QueueCommand(CreateCommand(value, 1));
+        }
+
+        BENCHMARK("Command Queue - Copy + 100 Appends")
+        {
+            CommandQueue fork{queue};
+            for(uint32_t i{0}; i != appendCount; ++i)
+            {
+                fork.QueueCommand(CreateCommand(value, 1));
+            }
+            return fork.GetCommandQueueSize();
+        };
+
+        BENCHMARK("Persistent Command Queue - Fork + 100 Appends")
+        {
+            PersistentCommandQueue fork{persistentQueue};
+            for(uint32_t i{0}; i != appendCount; ++i)
+            {
+                fork.QueueCommand(CreateCommand(value, 1));
+            }
+            return fork.GetCommandQueueSize();
+        };
+
+        BENCHMARK("Command Queue - Execute/Rollback")
+        {
+            queue.ExecuteAll();
+            queue.RollbackTo(0);
+        };
+
+        BENCHMARK("Persistent Command Queue - Execute/Rollback")
+        {
+            persistentQueue.ExecuteAll();
+            persistentQueue.RollbackTo(0);
+        };
+    }
+}
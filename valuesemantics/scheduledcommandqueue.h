@@ -0,0 +1,185 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "valuesemantics/commandqueue.h"
+
+namespace ValueSemantics
+{
+    /// Command queue whose commands are scheduled for a future tick and executed once the queue advances to it.
+    /// Scheduled commands wait in a hierarchical timer wheel, scheduling is O(1) and advancing a tick is O(1) amortized:
+    /// each level holds 64 slots of 64 times the ticks of the level below, a command moves down a level
+    /// when its slot's ticks begin. Commands due on the same tick execute in the order they were scheduled.
+    /// Executed commands form the history, rolling back to a tick returns the commands executed after it to the wheel,
+    /// so advancing again executes them in the same order.
+    class ScheduledCommandQueue
+    {
+    public:
+        /// Schedules command to execute once the queue advances to tick.
+        /// tick has to be greater than GetTick() before calling
+        void ScheduleCommand(Command&& command, const uint64_t tick)
+        {
+            Place(ScheduledCommand{std::move(command), tick});
+            ++m_ScheduledCount;
+        }
+
+        /// Executes the commands scheduled for the next tick.
+        void AdvanceTick()
+        {
+            ++m_Tick;
+            Cascade();
+            Dispatch();
+        }
+
+        /// Executes every command scheduled up to and including tick, a tick at a time.
+        /// tick has to be no less than GetTick()
+        void AdvanceTo(const uint64_t tick)
+        {
+            while(m_Tick != tick)
+            {
+                AdvanceTick();
+            }
+        }
+
+        /// Rolls back every command executed after tick, most recent first, and schedules them again.
+        /// tick has to be no greater than GetTick()
+        void RollbackToTick(const uint64_t tick)
+        {
+            const auto begin{std::partition_point(m_History.begin(), m_History.end(),
+                [tick](const ScheduledCommand& scheduled)
+                {
+                    return scheduled.m_Tick <= tick;
+                })};
+
+            for(auto itr{m_History.end()}; itr != begin; )
+            {
+                (--itr)->m_Command.Rollback();
+            }
+
+            m_Tick = tick;
+            for(auto itr{begin}; itr != m_History.end(); ++itr)
+            {
+                Place(std::move(*itr));
+            }
+            m_ScheduledCount += static_cast<uint32_t>(m_History.end() - begin);
+            m_History.erase(begin, m_History.end());
+        }
+
+        /// Destroys every scheduled and executed command without rolling back, the tick is kept.
+        void ClearQueue()
+        {
+            for(auto& level : m_Wheel)
+            {
+                for(std::vector<ScheduledCommand>& slot : level)
+                {
+                    slot.clear();
+                }
+            }
+            m_History.clear();
+            m_ScheduledCount = 0;
+        }
+
+        [[nodiscard]] uint64_t GetTick() const
+        {
+            return m_Tick;
+        }
+
+        /// Number of commands waiting for their tick.
+        [[nodiscard]] uint32_t GetScheduledCommandCount() const
+        {
+            return m_ScheduledCount;
+        }
+
+        /// Number of commands executed and not rolled back.
+        [[nodiscard]] uint32_t GetExecutedCommandCount() const
+        {
+            return static_cast<uint32_t>(m_History.size());
+        }
+    private:
+        static constexpr uint32_t LevelBits{6};
+        static constexpr uint32_t SlotCount{1u << LevelBits};
+        static constexpr uint32_t SlotMask{SlotCount - 1};
+        /// Enough levels for every 64 bit tick.
+        static constexpr uint32_t LevelCount{(64 + LevelBits - 1) / LevelBits};
+
+        struct ScheduledCommand
+        {
+            Command m_Command;
+            uint64_t m_Tick{0};
+        };
+
+        /// The level is the one holding the highest bit in which the command's tick differs from the current tick,
+        /// the slot is the tick's digit at that level.
+        void Place(ScheduledCommand&& scheduled)
+        {
+            const uint64_t difference{scheduled.m_Tick ^ m_Tick};
+            const uint32_t level{difference == 0 ? 0 : static_cast<uint32_t>(std::bit_width(difference) - 1) / LevelBits};
+            m_Wheel[level][(scheduled.m_Tick >> (level * LevelBits)) & SlotMask].push_back(std::move(scheduled));
+        }
+
+        /// Once the current tick starts a slot of a higher level, its commands are placed again relative to the
+        /// current tick, highest level first so they can fall through every level down to the current tick.
+        void Cascade()
+        {
+            const uint32_t topLevel{std::min(static_cast<uint32_t>(std::countr_zero(m_Tick)) / LevelBits, LevelCount - 1)};
+            for(uint32_t level{topLevel}; level != 0; --level)
+            {
+                TakeDue(level, [this](ScheduledCommand&& scheduled)
+                    {
+                        Place(std::move(scheduled));
+                    });
+            }
+        }
+
+        /// Executes the commands of the current tick.
+        void Dispatch()
+        {
+            TakeDue(0, [this](ScheduledCommand&& scheduled)
+                {
+                    m_History.push_back(std::move(scheduled));
+                    m_History.back().m_Command.Execute();
+                    --m_ScheduledCount;
+                });
+        }
+
+        /// Passes the commands of the current tick's slot at level whose ticks have begun to take, in order.
+        /// A rollback further back than a slot's ticks leaves commands of a later round in the slot,
+        /// they stay in order ahead of any command of their tick scheduled since, until their round comes.
+        template<class TFunction>
+        void TakeDue(const uint32_t level, TFunction&& take)
+        {
+            std::vector<ScheduledCommand>& slot{m_Wheel[level][(m_Tick >> (level * LevelBits)) & SlotMask]};
+            if(slot.empty())
+                return;
+
+            const uint32_t roundShift{(level + 1) * LevelBits};
+            std::size_t kept{0};
+            for(std::size_t index{0}; index != slot.size(); ++index)
+            {
+                if(roundShift >= 64 || (slot[index].m_Tick >> roundShift) == (m_Tick >> roundShift))
+                {
+                    take(std::move(slot[index]));
+                }
+                else
+                {
+                    if(kept != index)
+                        slot[kept] = std::move(slot[index]);
+                    ++kept;
+                }
+            }
+            slot.erase(slot.begin() + static_cast<std::ptrdiff_t>(kept), slot.end());
+        }
+
+        std::array<std::array<std::vector<ScheduledCommand>, SlotCount>, LevelCount> m_Wheel{};
+        /// Executed commands in execution order, so their ticks are ascending.
+        std::vector<ScheduledCommand> m_History{};
+        uint64_t m_Tick{0};
+        uint32_t m_ScheduledCount{0};
+    };
+}
@@ -0,0 +1,263 @@
+#pragma once
+
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/benchmark/catch_benchmark.hpp>
+
+#include <algorithm>
+#include <queue>
+#include <random>
+
+#include "valuesemantics/commandqueueexamples.h"
+#include "valuesemantics/scheduledcommandqueue.h"
+#include "workingvalue.h"
+
+namespace ValueSemantics
+{
+    namespace
+    {
+        /// Command recording its id to log when executed and the negated id when rolled back.
+        [[nodiscard]] static LambdaCommand CreateLoggingCommand(std::vector<int32_t>& log, const int32_t id)
+        {
+            return LambdaCommand{
+                [&log, id]
+                {
+                    log.push_back(id);
+                },
+                [&log, id]
+                {
+                    log.push_back(-id);
+                }};
+        }
+    }
+
+    TEST_CASE("Scheduled Command Queue - Value Semantics - Unit Tests")
+    {
+        std::shared_ptr<WorkingValue> value{std::make_shared<WorkingValue>()};
+        ScheduledCommandQueue queue{};
+        REQUIRE(queue.GetTick() == 0);
+        REQUIRE(queue.GetScheduledCommandCount() == 0);
+
+        queue.ScheduleCommand(CreateCommand(value, 1), 1);
+        queue.ScheduleCommand(CreateCommand(value, 2), 3);
+        queue.ScheduleCommand(CreateLambdaCommand(value, 4), 3);
+        queue.ScheduleCommand(CreateCommand(value, 8), 5'000); // Several levels up
+        REQUIRE(queue.GetScheduledCommandCount() == 4);
+
+        SECTION("Advance")
+        {
+            queue.AdvanceTick(); // +1
+            REQUIRE(value->GetValue() == 1);
+            queue.AdvanceTick();
+            REQUIRE(value->GetValue() == 1);
+            queue.AdvanceTick(); // +2, +4
+            REQUIRE(value->GetValue() == 7);
+            REQUIRE(queue.GetScheduledCommandCount() == 1);
+            REQUIRE(queue.GetExecutedCommandCount() == 3);
+
+            queue.AdvanceTo(4'999);
+            REQUIRE(value->GetValue() == 7);
+            queue.AdvanceTick(); // +8
+            REQUIRE(value->GetValue() == 15);
+            REQUIRE(queue.GetScheduledCommandCount() == 0);
+        }
+
+        SECTION("Rollback Returns Commands To The Scheduler")
+        {
+            queue.AdvanceTo(3);
+            queue.RollbackToTick(1); // -4, -2
+            REQUIRE(value->GetValue() == 1);
+            REQUIRE(queue.GetTick() == 1);
+            REQUIRE(queue.GetScheduledCommandCount() == 3);
+            REQUIRE(queue.GetExecutedCommandCount() == 1);
+
+            queue.AdvanceTo(3); // +2, +4
+            REQUIRE(value->GetValue() == 7);
+            queue.AdvanceTo(5'000); // +8
+            queue.RollbackToTick(0);
+            REQUIRE(value->GetValue() == 0);
+            REQUIRE(queue.GetScheduledCommandCount() == 4);
+
+            queue.AdvanceTo(5'000);
+            REQUIRE(value->GetValue() == 15);
+        }
+
+        SECTION("Same Tick Order")
+        {
+            std::vector<int32_t> log{};
+            queue.ClearQueue();
+            queue.ScheduleCommand(CreateLoggingCommand(log, 1), 100);
+            queue.AdvanceTo(10);
+            queue.ScheduleCommand(CreateLoggingCommand(log, 2), 100);
+            queue.AdvanceTo(70);
+            queue.ScheduleCommand(CreateLoggingCommand(log, 3), 100);
+            queue.AdvanceTo(100);
+            REQUIRE(log == std::vector<int32_t>{1, 2, 3});
+
+            log.clear();
+            queue.RollbackToTick(5);
+            queue.ScheduleCommand(CreateLoggingCommand(log, 4), 100);
+            queue.AdvanceTo(100);
+            REQUIRE(log == std::vector<int32_t>{-3, -2, -1, 1, 2, 3, 4});
+        }
+
+        SECTION("Clear")
+        {
+            queue.AdvanceTo(3);
+            queue.ClearQueue();
+            REQUIRE(queue.GetTick() == 3);
+            REQUIRE(queue.GetScheduledCommandCount() == 0);
+            REQUIRE(queue.GetExecutedCommandCount() == 0);
+            REQUIRE(value.use_count() == 1);
+        }
+    }
+
+    TEST_CASE("Scheduled Command Queue - Value Semantics - Randomized Unit Tests")
+    {
+        // Reference: commands of a tick execute in the order they were first scheduled
+        struct Expected
+        {
+            uint64_t m_Tick{0};
+            int32_t m_Id{0};
+        };
+
+        std::minstd_rand random{42};
+        std::vector<int32_t> log{};
+        std::vector<Expected> pending{};
+        std::vector<Expected> executed{};
+        ScheduledCommandQueue queue{};
+        int32_t nextId{1};
+
+        for(uint32_t step{0}; step != 5'000; ++step)
+        {
+            const uint32_t action{static_cast<uint32_t>(random() % 10)};
+            if(action < 6)
+            {
+                // Mostly near ticks, some far enough to cascade through several levels. Far ticks are rounded
+                // so commands scheduled before and after a rollback share ticks
+                const uint64_t tick{action < 5 ? queue.GetTick() + 1 + random() % 100
+                    : (queue.GetTick() + 1 + random() % 300'000) | 1'023};
+                const Expected scheduled{tick, nextId++};
+                queue.ScheduleCommand(CreateLoggingCommand(log, scheduled.m_Id), scheduled.m_Tick);
+                pending.push_back(scheduled);
+            }
+            else if(action < 9)
+            {
+                const uint64_t tick{queue.GetTick() + random() % (action == 8 ? 5'000 : 50)};
+                queue.AdvanceTo(tick);
+
+                std::vector<int32_t> expectedLog{};
+                std::stable_sort(pending.begin(), pending.end(), [](const Expected& lhs, const Expected& rhs)
+                    {
+                        return lhs.m_Tick < rhs.m_Tick;
+                    });
+                const auto due{std::partition_point(pending.begin(), pending.end(), [tick](const Expected& expected)
+                    {
+                        return expected.m_Tick <= tick;
+                    })};
+                for(auto itr{pending.begin()}; itr != due; ++itr)
+                {
+                    expectedLog.push_back(itr->m_Id);
+                    executed.push_back(*itr);
+                }
+                pending.erase(pending.begin(), due);
+
+                REQUIRE(log == expectedLog);
+                log.clear();
+            }
+            else
+            {
+                const uint64_t tick{queue.GetTick() - std::min<uint64_t>(queue.GetTick(), random() % 20'000)};
+                queue.RollbackToTick(tick);
+
+                std::vector<int32_t> expectedLog{};
+                std::vector<Expected> returned{};
+                while(!executed.empty() && executed.back().m_Tick > tick)
+                {
+                    expectedLog.push_back(-executed.back().m_Id);
+                    returned.insert(returned.begin(), executed.back());
+                    executed.pop_back();
+                }
+                // Returned commands are due before every pending command
+                pending.insert(pending.begin(), returned.begin(), returned.end());
+
+                REQUIRE(log == expectedLog);
+                log.clear();
+            }
+
+            REQUIRE(queue.GetScheduledCommandCount() == pending.size());
+            REQUIRE(queue.GetExecutedCommandCount() == executed.size());
+        }
+    }
+
+    TEST_CASE("Scheduled Command Queue - Value Semantics - Benchmark")
+    {
+        constexpr uint32_t commandCount{1'000'000};
+        constexpr uint64_t tickCount{10'000};
+        std::shared_ptr<WorkingValue> value{std::make_shared<WorkingValue>()};
+
+        std::minstd_rand random{42};
+        std::vector<uint64_t> ticks(commandCount);
+        for(uint64_t& tick : ticks)
+        {
+            tick = 1 + random() % tickCount;
+        }
+
+        BENCHMARK("Timer Wheel")
+        {
+            ScheduledCommandQueue queue{};
+            for(const uint64_t tick : ticks)
+            {
+                queue.ScheduleCommand(CreateCommand(value, 1), tick);
+            }
+            queue.AdvanceTo(tickCount);
+            return queue.GetExecutedCommandCount();
+        };
+
+        // What the scheduled queue replaces, a priority queue feeding a CommandQueue every tick
+        BENCHMARK("Priority Queue")
+        {
+            struct Scheduled
+            {
+                uint64_t m_Tick{0};
+                uint32_t m_Sequence{0};
+                Command m_Command;
+
+                [[nodiscard]] bool operator<(const Scheduled& other) const
+                {
+                    return m_Tick != other.m_Tick ? m_Tick > other.m_Tick : m_Sequence > other.m_Sequence;
+                }
+            };
+
+            std::priority_queue<Scheduled> scheduled{};
+            CommandQueue queue{};
+            uint32_t sequence{0};
+            for(const uint64_t tick : ticks)
+            {
+                scheduled.push(Scheduled{tick, sequence++, CreateCommand(value, 1)});
+            }
+
+            for(uint64_t tick{1}; tick <= tickCount; ++tick)
+            {
+                while(!scheduled.empty() && scheduled.top().m_Tick == tick)
+                {
+                    queue.QueueCommand(std::move(const_cast<Scheduled&>(scheduled.top()).m_Command));
+                    scheduled.pop();
+                }
+                queue.ExecuteAll();
+            }
+            return queue.GetCommandIndex();
+        };
+
+        ScheduledCommandQueue queue{};
+        for(const uint64_t tick : ticks)
+        {
+            queue.ScheduleCommand(CreateCommand(value, 1), tick);
+        }
+
+        BENCHMARK("Timer Wheel Rollback And Advance")
+        {
+            queue.AdvanceTo(tickCount);
+            queue.RollbackToTick(0);
+        };
+    }
+}
@@ -0,0 +1,225 @@
+#include "valuesemantics/tieredcommandqueue.h"
+#include "valuesemantics/commandjournal.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include <iterator>
+#include <optional>
+
+namespace ValueSemantics
+{
+    namespace
+    {
+        /// CommandRecord without padding, as stored in the spill file.
+        struct SpillRecord
+        {
+            uint16_t m_TypeId{0};
+            uint16_t m_Reserved{0};
+            uint32_t m_TargetId{0};
+            uint32_t m_Payload{0};
+        };
+
+        constexpr std::size_t SpillRecordSize{sizeof(SpillRecord)};
+        static_assert(SpillRecordSize == 12);
+
+        [[nodiscard]] std::streamoff GetRecordOffset(const uint32_t index)
+        {
+            return static_cast<std::streamoff>(std::size_t{index} * SpillRecordSize);
+        }
+    }
+
+    TieredCommandQueue::TieredCommandQueue(const TargetRegistry& registry, const uint32_t residentCapacity,
+        const uint32_t segmentCommandCount)
+        : m_Registry{&registry}
+        , m_SegmentCommandCount{segmentCommandCount == 0 ? 1 : segmentCommandCount}
+    {
+        m_ResidentCapacity = std::max(residentCapacity, 2 * m_SegmentCommandCount);
+        m_ReadBuffer.resize(std::size_t{m_SegmentCommandCount} * SpillRecordSize);
+        m_ReadCommands.reserve(m_SegmentCommandCount);
+    }
+
+    TieredCommandQueue::~TieredCommandQueue()
+    {
+        CloseSpillFile();
+    }
+
+    bool TieredCommandQueue::Open(const std::filesystem::path& path)
+    {
+        ClearQueue();
+        CloseSpillFile();
+
+        m_File.open(path, std::ios::in | std::ios::out | std::ios::binary | std::ios::trunc);
+        if(!m_File.is_open())
+            return false;
+
+        m_Path = path;
+        m_LoadedSegmentCount = 0;
+        return true;
+    }
+
+    bool TieredCommandQueue::ExecuteCommand()
+    {
+        if(m_CommandIndex == GetResidentEnd() && !LoadNextSegment())
+            return false;
+
+        m_Resident[m_CommandIndex - m_ResidentBegin].Execute();
+        ++m_CommandIndex;
+        return true;
+    }
+
+    bool TieredCommandQueue::RollbackCommand()
+    {
+        if(m_CommandIndex == m_ResidentBegin && !LoadPreviousSegment())
+            return false;
+
+        --m_CommandIndex;
+        m_Resident[m_CommandIndex - m_ResidentBegin].Rollback();
+        return true;
+    }
+
+    bool TieredCommandQueue::ExecuteN(const uint32_t count)
+    {
+        for(uint32_t executed{0}; executed != count; ++executed)
+        {
+            if(!ExecuteCommand())
+                return false;
+        }
+        return true;
+    }
+
+    bool TieredCommandQueue::RollbackTo(const uint32_t index)
+    {
+        while(m_CommandIndex != index)
+        {
+            if(!RollbackCommand())
+                return false;
+        }
+        return true;
+    }
+
+    void TieredCommandQueue::ClearQueue()
+    {
+        m_Resident.clear();
+        m_ResidentBegin = 0;
+        m_CommandIndex = 0;
+        m_Size = 0;
+        m_Appending = false;
+    }
+
+    void TieredCommandQueue::ClearPendingCommands()
+    {
+        m_Resident.erase(std::begin(m_Resident) + (m_CommandIndex - m_ResidentBegin), std::end(m_Resident));
+        m_Size = m_CommandIndex;
+        m_Appending = false;
+    }
+
+    bool TieredCommandQueue::WriteRecord(const CommandRecord& record)
+    {
+        if(!m_Appending)
+        {
+            m_File.seekp(GetRecordOffset(m_Size));
+            m_Appending = true;
+        }
+
+        const SpillRecord spillRecord{static_cast<uint16_t>(record.m_TypeId), 0, record.m_TargetId, record.m_Payload};
+        m_File.write(reinterpret_cast<const char*>(&spillRecord), SpillRecordSize);
+        if(m_File.good())
+            return true;
+
+        m_File.clear();
+        m_Appending = false;
+        return false;
+    }
+
+    bool TieredCommandQueue::ReadSegment(const uint32_t begin, const uint32_t end)
+    {
+        // Reading moves the file position away from the end of the file
+        m_Appending = false;
+        m_ReadCommands.clear();
+        m_File.seekg(GetRecordOffset(begin));
+        m_File.read(reinterpret_cast<char*>(m_ReadBuffer.data()), static_cast<std::streamsize>((end - begin) * SpillRecordSize));
+        if(!m_File.good())
+        {
+            // A failed stream would fail every later read and write too
+            m_File.clear();
+            return false;
+        }
+
+        for(uint32_t position{0}; position != end - begin; ++position)
+        {
+            SpillRecord spillRecord{};
+            std::memcpy(&spillRecord, m_ReadBuffer.data() + position * SpillRecordSize, SpillRecordSize);
+            const CommandRecord record{static_cast<CommandTypeId>(spillRecord.m_TypeId), spillRecord.m_TargetId, spillRecord.m_Payload};
+            std::optional<Command> command{DeserializeCommand(record, *m_Registry)};
+
+            // Either a target was unregistered while its commands were queued, or the spill file was modified
+            assert(command && "A spilled command can't be deserialized");
+            if(!command)
+                return false;
+
+            m_ReadCommands.push_back(std::move(*command));
+        }
+
+        ++m_LoadedSegmentCount;
+        return true;
+    }
+
+    bool TieredCommandQueue::LoadPreviousSegment()
+    {
+        const uint32_t begin{m_ResidentBegin - m_SegmentCommandCount};
+        if(!ReadSegment(begin, m_ResidentBegin))
+            return false;
+
+        m_Resident.insert(std::begin(m_Resident), std::make_move_iterator(std::begin(m_ReadCommands)),
+            std::make_move_iterator(std::end(m_ReadCommands)));
+        m_ReadCommands.clear();
+        m_ResidentBegin = begin;
+        DropFarthestSegments();
+        return true;
+    }
+
+    bool TieredCommandQueue::LoadNextSegment()
+    {
+        const uint32_t begin{GetResidentEnd()};
+        const uint32_t end{std::min(begin + m_SegmentCommandCount, m_Size)};
+        if(!ReadSegment(begin, end))
+            return false;
+
+        m_Resident.insert(std::end(m_Resident), std::make_move_iterator(std::begin(m_ReadCommands)),
+            std::make_move_iterator(std::end(m_ReadCommands)));
+        m_ReadCommands.clear();
+        DropFarthestSegments();
+        return true;
+    }
+
+    void TieredCommandQueue::DropFarthestSegments()
+    {
+        // The window holds more than two segments, so the half of it on the far side of the cursor spans a whole
+        // segment and dropping it leaves the cursor within the window
+        while(m_Resident.size() > m_ResidentCapacity)
+        {
+            const uint32_t end{GetResidentEnd()};
+            if(m_CommandIndex - m_ResidentBegin >= end - m_CommandIndex)
+            {
+                m_Resident.erase(std::begin(m_Resident), std::begin(m_Resident) + m_SegmentCommandCount);
+                m_ResidentBegin += m_SegmentCommandCount;
+            }
+            else
+            {
+                const uint32_t segmentBegin{(end - 1) / m_SegmentCommandCount * m_SegmentCommandCount};
+                m_Resident.erase(std::begin(m_Resident) + (segmentBegin - m_ResidentBegin), std::end(m_Resident));
+            }
+        }
+    }
+
+    void TieredCommandQueue::CloseSpillFile()
+    {
+        if(!m_File.is_open())
+            return;
+
+        m_File.close();
+        std::error_code error{};
+        std::filesystem::remove(m_Path, error);
+    }
+}
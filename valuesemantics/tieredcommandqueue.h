@@ -0,0 +1,181 @@
+#pragma once
+
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <filesystem>
+#include <fstream>
+#include <utility>
+#include <vector>
+
+#include "valuesemantics/commandqueue.h"
+#include "valuesemantics/commandrecord.h"
+#include "targetregistry.h"
+
+namespace ValueSemantics
+{
+    /// Command queue whose history is split into two tiers. Every queued command is also written to a spill file
+    /// as a compact record, and only a window of at most residentCapacity commands around the cursor is kept in memory,
+    /// so resident memory is bounded however long the history grows. Moving the cursor past either end of the window
+    /// loads the next segment of segmentCommandCount commands back from the file, and once the window outgrows
+    /// residentCapacity the segment farthest from the cursor is dropped, it's already on disk.
+    /// Only commands with a Serialize(const TCommand&, const TargetRegistry&, CommandRecord&) overload can be queued.
+    /// Moving the cursor fails, leaving it where it stopped, when a segment can't be read back from the spill file.
+    class TieredCommandQueue
+    {
+    public:
+        static constexpr uint32_t DefaultSegmentCommandCount{4'096};
+
+        /// registry has to outlive the queue, and the targets of queued commands have to stay registered while
+        /// the commands are in the queue. residentCapacity is raised to at least two segments.
+        TieredCommandQueue(const TargetRegistry& registry, uint32_t residentCapacity,
+            uint32_t segmentCommandCount = DefaultSegmentCommandCount);
+
+        /// Removes the spill file.
+        ~TieredCommandQueue();
+
+        TieredCommandQueue(const TieredCommandQueue&) = delete;
+        TieredCommandQueue& operator=(const TieredCommandQueue&) = delete;
+
+        /// Clears the queue and creates the spill file at path, replacing any file there.
+        /// The file is removed again when the queue is destroyed or reopened.
+        /// Returns false when the file can't be created.
+        [[nodiscard]] bool Open(const std::filesystem::path& path);
+
+        /// Returns false, without executing, when the command's segment can't be loaded.
+        /// HasPendingCommand() has to be true before calling
+        bool ExecuteCommand();
+
+        /// Returns false, without rolling back, when the command's segment can't be loaded.
+        /// HasPendingRollbackCommand() has to be true before calling
+        bool RollbackCommand();
+
+        /// Executes every pending command. Returns false when a segment can't be loaded.
+        bool ExecuteAll()
+        {
+            return ExecuteN(GetCommandQueueSize() - m_CommandIndex);
+        }
+
+        /// Returns false, stopping at the first command whose segment can't be loaded, when one can't be.
+        /// count has to be no greater than the number of pending commands
+        bool ExecuteN(uint32_t count);
+
+        /// Rolls back commands until GetCommandIndex() == index.
+        /// Returns false, stopping at the first command whose segment can't be loaded, when one can't be.
+        /// index has to be no greater than GetCommandIndex()
+        bool RollbackTo(uint32_t index);
+
+        /// Executes or rolls back commands until GetCommandIndex() == index. Returns false when a segment can't be loaded.
+        /// index has to be no greater than GetCommandQueueSize()
+        bool SeekTo(const uint32_t index)
+        {
+            if(index > m_CommandIndex)
+                return ExecuteN(index - m_CommandIndex);
+
+            return RollbackTo(index);
+        }
+
+        void ClearQueue();
+
+        /// Removes any commands ahead of and including the current pending command.
+        /// HasPendingCommand() has to be true before calling
+        void ClearPendingCommands();
+
+        [[nodiscard]] bool HasPendingCommand() const
+        {
+            return GetCommandQueueSize() > m_CommandIndex;
+        }
+
+        [[nodiscard]] bool HasPendingRollbackCommand() const
+        {
+            return m_CommandIndex != 0 && GetCommandQueueSize() >= m_CommandIndex;
+        }
+
+        /// Returns false, without queueing the command, when it can't be serialized or written to the spill file,
+        /// as before Open().
+        template<class TCommand>
+            requires requires(const TCommand& command, const TargetRegistry& registry, CommandRecord& record)
+                { { ValueSemantics::Serialize(command, registry, record) } -> std::same_as<bool>; }
+        bool QueueCommand(TCommand&& command)
+        {
+            CommandRecord record{};
+            if(!ValueSemantics::Serialize(command, *m_Registry, record) || !WriteRecord(record))
+                return false;
+
+            // Pending commands past a dropped tail stay on disk until the cursor reaches them
+            if(GetResidentEnd() == m_Size)
+                m_Resident.emplace_back(std::forward<TCommand>(command));
+
+            ++m_Size;
+            DropFarthestSegments();
+            return true;
+        }
+
+        [[nodiscard]] uint32_t GetCommandIndex() const
+        {
+            return m_CommandIndex;
+        }
+
+        [[nodiscard]] uint32_t GetCommandQueueSize() const
+        {
+            return m_Size;
+        }
+
+        /// Number of commands held in memory, no greater than the resident capacity.
+        [[nodiscard]] uint32_t GetResidentCommandCount() const
+        {
+            return static_cast<uint32_t>(m_Resident.size());
+        }
+
+        /// Number of segments loaded back from the spill file since the queue was opened.
+        [[nodiscard]] uint32_t GetLoadedSegmentCount() const
+        {
+            return m_LoadedSegmentCount;
+        }
+    private:
+        /// Index of the command after the last resident one.
+        [[nodiscard]] uint32_t GetResidentEnd() const
+        {
+            return m_ResidentBegin + static_cast<uint32_t>(m_Resident.size());
+        }
+
+        /// Writes record as the command at GetCommandQueueSize().
+        [[nodiscard]] bool WriteRecord(const CommandRecord& record);
+
+        /// Reads the commands [begin, end) from the spill file into m_ReadCommands.
+        /// Returns false, leaving m_ReadCommands partially filled, when the records can't be read or deserialized.
+        [[nodiscard]] bool ReadSegment(uint32_t begin, uint32_t end);
+
+        /// Loads the segment before the resident window, the cursor has to be at the window's first command.
+        /// Returns false, leaving the window as it was, when the segment can't be read.
+        [[nodiscard]] bool LoadPreviousSegment();
+
+        /// Loads the segment after the resident window, the cursor has to be at the window's end.
+        /// Returns false, leaving the window as it was, when the segment can't be read.
+        [[nodiscard]] bool LoadNextSegment();
+
+        /// Drops segments from the end of the window farthest from the cursor until it fits the resident capacity.
+        void DropFarthestSegments();
+
+        void CloseSpillFile();
+
+        const TargetRegistry* m_Registry{nullptr};
+        std::fstream m_File{};
+        std::filesystem::path m_Path{};
+        /// Commands [m_ResidentBegin, GetResidentEnd()), m_ResidentBegin is a multiple of m_SegmentCommandCount
+        /// and so is GetResidentEnd() unless it is the end of the queue. The cursor is always within the window.
+        std::deque<Command> m_Resident{};
+        std::vector<std::byte> m_ReadBuffer{};
+        /// Commands of the segment last read, only added to the window once the whole segment was read.
+        std::vector<Command> m_ReadCommands{};
+        uint32_t m_ResidentCapacity{0};
+        uint32_t m_SegmentCommandCount{DefaultSegmentCommandCount};
+        uint32_t m_ResidentBegin{0};
+        uint32_t m_CommandIndex{0};
+        uint32_t m_Size{0};
+        uint32_t m_LoadedSegmentCount{0};
+        /// The file position is at the record of the next queued command, so appending needs no seek.
+        bool m_Appending{false};
+    };
+}
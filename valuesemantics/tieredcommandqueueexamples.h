@@ -0,0 +1,252 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <optional>
+#include <random>
+
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/benchmark/catch_benchmark.hpp>
+
+#include "valuesemantics/journaledcommandqueueexamples.h"
+#include "valuesemantics/tieredcommandqueue.h"
+#include "processmemory.h"
+#include "targetregistry.h"
+#include "workingvalue.h"
+
+namespace ValueSemantics
+{
+    TEST_CASE("Tiered Command Queue - Value Semantics - Unit Tests")
+    {
+        const TemporaryFile spillFile{"command-pattern-tiered-test.bin"};
+        std::shared_ptr<WorkingValue> value{std::make_shared<WorkingValue>()};
+        std::shared_ptr<WorkingValue> otherValue{std::make_shared<WorkingValue>()};
+        TargetRegistry registry{};
+        registry.Register(1, value);
+        registry.Register(2, otherValue);
+
+        // Segments of 4 commands, at most 8 resident
+        TieredCommandQueue queue{registry, 8, 4};
+        REQUIRE_FALSE(queue.QueueCommand(CreateCommand(value, 1))); // Not open
+        REQUIRE(queue.Open(spillFile.GetPath()));
+        REQUIRE(std::filesystem::exists(spillFile.GetPath()));
+
+        for(int32_t i{1}; i != 21; ++i)
+        {
+            REQUIRE(queue.QueueCommand(CreateCommand(i % 2 == 0 ? value : otherValue, i)));
+        }
+        REQUIRE_FALSE(queue.QueueCommand(CreateCommand(std::make_shared<WorkingValue>(), 100))); // Not registered
+        REQUIRE(queue.GetCommandQueueSize() == 20);
+        REQUIRE(queue.GetResidentCommandCount() == 8); // The tail past the first 8 is only on disk
+
+        queue.ExecuteAll(); // 2 + 4 + ... + 20, 1 + 3 + ... + 19
+        REQUIRE(value->GetValue() == 110);
+        REQUIRE(otherValue->GetValue() == 100);
+        REQUIRE(queue.GetResidentCommandCount() <= 8);
+        REQUIRE(queue.GetLoadedSegmentCount() == 3);
+
+        SECTION("Rollback Into Spilled Commands")
+        {
+            queue.RollbackTo(5); // 20 + 18 + ... + 6, 19 + 17 + ... + 7
+            REQUIRE(value->GetValue() == 6);
+            REQUIRE(otherValue->GetValue() == 9);
+            REQUIRE(queue.GetResidentCommandCount() <= 8);
+
+            queue.RollbackTo(0);
+            REQUIRE(value->GetValue() == 0);
+            REQUIRE(otherValue->GetValue() == 0);
+
+            queue.ExecuteN(10);
+            REQUIRE(value->GetValue() == 30);
+            REQUIRE(otherValue->GetValue() == 25);
+        }
+
+        SECTION("Queue Behind Spilled Tail")
+        {
+            queue.RollbackTo(2);
+            REQUIRE(queue.QueueCommand(CreateCommand(value, 1'000)));
+            REQUIRE(queue.GetCommandQueueSize() == 21);
+
+            queue.ExecuteAll();
+            REQUIRE(value->GetValue() == 1'110);
+            queue.RollbackCommand();
+            REQUIRE(value->GetValue() == 110);
+        }
+
+        SECTION("Clear Pending Commands")
+        {
+            queue.RollbackTo(3);
+            queue.ClearPendingCommands();
+            REQUIRE(queue.GetCommandQueueSize() == 3);
+            REQUIRE(value->GetValue() == 2);
+            REQUIRE(otherValue->GetValue() == 4);
+
+            REQUIRE(queue.QueueCommand(CreateCommand(value, 1'000)));
+            queue.ExecuteAll();
+            REQUIRE(value->GetValue() == 1'002);
+            queue.RollbackTo(0);
+            REQUIRE(value->GetValue() == 0);
+            REQUIRE(otherValue->GetValue() == 0);
+        }
+
+        SECTION("Random Walk Matches Command Queue")
+        {
+            queue.RollbackTo(0);
+
+            // Same commands and moves through a queue holding every command in memory
+            std::shared_ptr<WorkingValue> referenceValue{std::make_shared<WorkingValue>()};
+            CommandQueue reference{};
+            for(int32_t i{1}; i != 21; ++i)
+            {
+                reference.QueueCommand(CreateCommand(i % 2 == 0 ? referenceValue : std::make_shared<WorkingValue>(), i));
+            }
+
+            std::minstd_rand random{3};
+            for(uint32_t move{0}; move != 500; ++move)
+            {
+                if(random() % 8 == 0 && queue.HasPendingCommand())
+                {
+                    queue.ClearPendingCommands();
+                    reference.ClearPendingCommands();
+                }
+
+                const int32_t modification{static_cast<int32_t>(random() % 64)};
+                if(random() % 3 == 0)
+                {
+                    REQUIRE(queue.QueueCommand(CreateCommand(value, modification)));
+                    reference.QueueCommand(CreateCommand(referenceValue, modification));
+                }
+
+                const uint32_t index{static_cast<uint32_t>(random() % (queue.GetCommandQueueSize() + 1))};
+                queue.SeekTo(index);
+                reference.SeekTo(index);
+                REQUIRE(value->GetValue() == referenceValue->GetValue());
+                REQUIRE(queue.GetResidentCommandCount() <= 8);
+            }
+        }
+
+        SECTION("Truncated Spill File")
+        {
+            std::filesystem::resize_file(spillFile.GetPath(), 0);
+            const uint32_t loadedSegmentCount{queue.GetLoadedSegmentCount()};
+
+            // Stops at the first command of the resident window, the segment before it can't be read
+            REQUIRE_FALSE(queue.RollbackTo(0));
+            const uint32_t stoppedIndex{queue.GetCommandIndex()};
+            REQUIRE(stoppedIndex != 0);
+            REQUIRE(stoppedIndex % 4 == 0);
+            REQUIRE(queue.GetLoadedSegmentCount() == loadedSegmentCount);
+            REQUIRE_FALSE(queue.RollbackCommand());
+            REQUIRE(queue.GetCommandIndex() == stoppedIndex);
+
+            // The failed read leaves the file usable, resident commands still move and new commands are still written
+            REQUIRE(queue.ExecuteAll());
+            REQUIRE(value->GetValue() == 110);
+            REQUIRE(otherValue->GetValue() == 100);
+            REQUIRE(queue.QueueCommand(CreateCommand(value, 1'000)));
+            REQUIRE(queue.ExecuteAll());
+            REQUIRE(value->GetValue() == 1'110);
+        }
+
+        SECTION("Removed Spill File")
+        {
+            // The open stream keeps reading a removed file, where removing an open file fails nothing is removed
+            std::error_code error{};
+            std::filesystem::remove(spillFile.GetPath(), error);
+            REQUIRE(queue.RollbackTo(0));
+            REQUIRE(value->GetValue() == 0);
+            REQUIRE(otherValue->GetValue() == 0);
+
+            REQUIRE(queue.Open(spillFile.GetPath()));
+            REQUIRE(queue.GetCommandQueueSize() == 0);
+            REQUIRE(queue.QueueCommand(CreateCommand(value, 1)));
+        }
+
+        SECTION("Clear Queue")
+        {
+            queue.ClearQueue();
+            REQUIRE(queue.GetCommandQueueSize() == 0);
+            REQUIRE(queue.GetResidentCommandCount() == 0);
+            REQUIRE(value->GetValue() == 110);
+
+            REQUIRE(queue.QueueCommand(CreateCommand(value, 1)));
+            queue.ExecuteAll();
+            REQUIRE(value->GetValue() == 111);
+        }
+    }
+
+    TEST_CASE("Tiered Command Queue - Value Semantics - Benchmark")
+    {
+        constexpr uint32_t residentCapacity{65'536};
+        std::shared_ptr<WorkingValue> value{std::make_shared<WorkingValue>()};
+        TargetRegistry registry{};
+        registry.Register(1, value);
+
+        for(const uint32_t commandCount : {1'000'000u, 4'000'000u})
+        {
+            const TemporaryFile spillFile{"command-pattern-tiered-benchmark.bin"};
+
+            // Resident set growth of building and executing the whole history
+            TieredCommandQueue queue{registry, residentCapacity};
+            REQUIRE(queue.Open(spillFile.GetPath()));
+            const std::size_t startResidentSetSize{GetCurrentResidentSetSize()};
+            for(uint32_t i{0}; i != commandCount; ++i)
+            {
+                queue.QueueCommand(CreateCommand(value, 1));
+            }
+            queue.ExecuteAll();
+            const std::size_t tieredGrowth{GetCurrentResidentSetSize() - std::min(startResidentSetSize, GetCurrentResidentSetSize())};
+
+            // Measured after the tiered queue, the memory the CommandQueue frees may be reused by later allocations
+            std::size_t commandQueueGrowth{0};
+            {
+                const std::size_t commandQueueStart{GetCurrentResidentSetSize()};
+                CommandQueue commandQueue{};
+                for(uint32_t i{0}; i != commandCount; ++i)
+                {
+                    commandQueue.QueueCommand(CreateCommand(value, 1));
+                }
+                commandQueue.ExecuteAll();
+                commandQueueGrowth = GetCurrentResidentSetSize() - std::min(commandQueueStart, GetCurrentResidentSetSize());
+                commandQueue.RollbackTo(0);
+            }
+
+            // Rollback latency of every command, clock reads included, split by whether it had to load a segment first
+            std::chrono::steady_clock::duration residentTotal{};
+            std::chrono::steady_clock::duration crossingTotal{};
+            std::chrono::steady_clock::duration crossingMax{};
+            uint32_t crossingCount{0};
+            while(queue.HasPendingRollbackCommand())
+            {
+                const uint32_t loadedSegmentCount{queue.GetLoadedSegmentCount()};
+                const auto start{std::chrono::steady_clock::now()};
+                queue.RollbackCommand();
+                const std::chrono::steady_clock::duration elapsed{std::chrono::steady_clock::now() - start};
+
+                if(queue.GetLoadedSegmentCount() == loadedSegmentCount)
+                {
+                    residentTotal += elapsed;
+                    continue;
+                }
+                crossingTotal += elapsed;
+                crossingMax = std::max(crossingMax, elapsed);
+                ++crossingCount;
+            }
+            REQUIRE(value->GetValue() == 0);
+
+            using Microseconds = std::chrono::duration<double, std::micro>;
+            WARN(commandCount << " commands, resident set growth - CommandQueue: " << commandQueueGrowth / 1024
+                << " KB, TieredCommandQueue: " << tieredGrowth / 1024 << " KB, spill file: "
+                << std::filesystem::file_size(spillFile.GetPath()) / 1024 << " KB\n"
+                << "Rollback - resident: " << Microseconds{residentTotal}.count() * 1'000 / (commandCount - crossingCount)
+                << " ns, crossing into a spilled segment: " << Microseconds{crossingTotal}.count() / crossingCount
+                << " us mean, " << Microseconds{crossingMax}.count() << " us max");
+
+            BENCHMARK("Rollback Across Tiers - " + std::to_string(commandCount))
+            {
+                queue.ExecuteAll();
+                queue.RollbackTo(0);
+            };
+        }
+    }
+}
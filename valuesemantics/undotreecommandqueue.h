@@ -0,0 +1,306 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <optional>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "valuesemantics/commandqueue.h"
+
+namespace ValueSemantics
+{
+    /// Command queue which keeps every redo branch instead of erasing it. Queuing a command while the command after
+    /// the cursor has been executed before, i.e. after a rollback, starts a new branch at the cursor.
+    /// The abandoned branch keeps its commands and can be returned to with SwitchToBranch().
+    /// Commands are stored once in a tree of nodes shared by every branch passing through them,
+    /// so a branch point only costs the new branch's entry.
+    /// At most maxBranchCount branches are kept, once exceeded the least recently active branch is pruned,
+    /// destroying the commands no other branch shares.
+    class UndoTreeCommandQueue
+    {
+    public:
+        using BranchId = uint32_t;
+
+        explicit UndoTreeCommandQueue(const uint32_t maxBranchCount = 64)
+            : m_MaxBranchCount{maxBranchCount < 2 ? 2 : maxBranchCount}
+        {
+            ClearQueue();
+        }
+
+        /// HasPendingCommand() has to be true before calling
+        void ExecuteCommand()
+        {
+            ++m_CommandIndex;
+            Node& node{m_Nodes[m_ActivePath[m_CommandIndex]]};
+            node.m_Command->Execute();
+            node.m_Executed = true;
+        }
+
+        /// HasPendingRollbackCommand() has to be true before calling
+        void RollbackCommand()
+        {
+            m_Nodes[m_ActivePath[m_CommandIndex]].m_Command->Rollback();
+            --m_CommandIndex;
+        }
+
+        /// Executes every pending command of the active branch.
+        void ExecuteAll()
+        {
+            ExecuteN(GetCommandQueueSize() - m_CommandIndex);
+        }
+
+        /// count has to be no greater than the number of pending commands
+        void ExecuteN(const uint32_t count)
+        {
+            for(uint32_t i{0}; i != count; ++i)
+            {
+                ExecuteCommand();
+            }
+        }
+
+        /// Rolls back commands until GetCommandIndex() == index.
+        /// index has to be no greater than GetCommandIndex()
+        void RollbackTo(const uint32_t index)
+        {
+            while(m_CommandIndex != index)
+            {
+                RollbackCommand();
+            }
+        }
+
+        /// Executes or rolls back commands of the active branch until GetCommandIndex() == index.
+        /// index has to be no greater than GetCommandQueueSize()
+        void SeekTo(const uint32_t index)
+        {
+            if(index > m_CommandIndex)
+                ExecuteN(index - m_CommandIndex);
+            else
+                RollbackTo(index);
+        }
+
+        /// Destroys every command of every branch, leaving a single empty branch.
+        void ClearQueue()
+        {
+            m_Nodes.clear();
+            m_FreeNodes.clear();
+            m_Nodes.push_back(Node{});
+            m_ActivePath.assign(1, RootNode);
+            m_Branches.clear();
+            m_CommandIndex = 0;
+            m_ActiveBranch = CreateBranch(RootNode);
+        }
+
+        [[nodiscard]] bool HasPendingCommand() const
+        {
+            return GetCommandQueueSize() > m_CommandIndex;
+        }
+
+        [[nodiscard]] bool HasPendingRollbackCommand() const
+        {
+            return m_CommandIndex != 0;
+        }
+
+        void QueueCommand(Command&& command)
+        {
+            if(HasPendingCommand() && m_Nodes[m_ActivePath[m_CommandIndex + 1]].m_Executed)
+                Branch();
+
+            const uint32_t parent{m_ActivePath.back()};
+            const uint32_t node{AllocateNode(std::move(command), parent)};
+            ++m_Nodes[parent].m_ChildCount;
+            m_ActivePath.push_back(node);
+        }
+
+        /// Rolls back to the node where the active branch and branch diverge, then executes along branch
+        /// up to the command it was left at. Costs the commands between the two cursors plus the length of branch
+        /// past the divergence point. Returns false, leaving the queue untouched, when branch doesn't exist.
+        bool SwitchToBranch(const BranchId branch)
+        {
+            const auto found{m_Branches.find(branch)};
+            if(found == m_Branches.end())
+                return false;
+
+            if(branch == m_ActiveBranch)
+                return true;
+
+            SaveActiveBranch();
+
+            m_SwitchPath.clear();
+            uint32_t node{found->second.m_Tip};
+            while(!IsOnActivePath(node))
+            {
+                m_SwitchPath.push_back(node);
+                node = m_Nodes[node].m_Parent;
+            }
+
+            const uint32_t divergenceIndex{m_Nodes[node].m_Depth};
+            SeekTo(std::min(m_CommandIndex, divergenceIndex));
+            m_ActivePath.resize(divergenceIndex + 1);
+            m_ActivePath.insert(m_ActivePath.end(), m_SwitchPath.rbegin(), m_SwitchPath.rend());
+
+            m_ActiveBranch = branch;
+            found->second.m_LastActive = ++m_ActivationCount;
+            SeekTo(found->second.m_CommandIndex);
+            return true;
+        }
+
+        /// Destroys the commands of branch no other branch shares.
+        /// Returns false when branch doesn't exist or is the active branch.
+        bool PruneBranch(const BranchId branch)
+        {
+            const auto found{m_Branches.find(branch)};
+            if(found == m_Branches.end() || branch == m_ActiveBranch)
+                return false;
+
+            uint32_t node{found->second.m_Tip};
+            while(node != RootNode && m_Nodes[node].m_ChildCount == 0 && !IsOnActivePath(node))
+            {
+                const uint32_t parent{m_Nodes[node].m_Parent};
+                --m_Nodes[parent].m_ChildCount;
+                FreeNode(node);
+                node = parent;
+            }
+
+            m_Branches.erase(found);
+            return true;
+        }
+
+        [[nodiscard]] bool HasBranch(const BranchId branch) const
+        {
+            return m_Branches.contains(branch);
+        }
+
+        [[nodiscard]] BranchId GetActiveBranch() const
+        {
+            return m_ActiveBranch;
+        }
+
+        [[nodiscard]] uint32_t GetBranchCount() const
+        {
+            return static_cast<uint32_t>(m_Branches.size());
+        }
+
+        /// Number of commands stored across every branch.
+        [[nodiscard]] uint32_t GetStoredCommandCount() const
+        {
+            return static_cast<uint32_t>(m_Nodes.size() - m_FreeNodes.size()) - 1;
+        }
+
+        /// Index within the active branch.
+        [[nodiscard]] uint32_t GetCommandIndex() const
+        {
+            return m_CommandIndex;
+        }
+
+        /// Number of commands along the active branch.
+        [[nodiscard]] uint32_t GetCommandQueueSize() const
+        {
+            return static_cast<uint32_t>(m_ActivePath.size()) - 1;
+        }
+    private:
+        static constexpr uint32_t RootNode{0};
+
+        struct Node
+        {
+            std::optional<Command> m_Command{};
+            uint32_t m_Parent{RootNode};
+            uint32_t m_Depth{0};
+            uint32_t m_ChildCount{0};
+            /// Set once the command has been executed, queuing in front of it then starts a new branch.
+            bool m_Executed{false};
+        };
+
+        struct BranchState
+        {
+            /// Last node of the branch, only updated for the active branch when it's left.
+            uint32_t m_Tip{RootNode};
+            /// Where the cursor was when the branch was last active.
+            uint32_t m_CommandIndex{0};
+            uint64_t m_LastActive{0};
+        };
+
+        /// Starts a new active branch at the cursor. The commands after the cursor stay on the old branch.
+        void Branch()
+        {
+            SaveActiveBranch();
+            m_ActivePath.resize(m_CommandIndex + 1);
+            m_ActiveBranch = CreateBranch(m_ActivePath.back());
+
+            if(m_Branches.size() > m_MaxBranchCount)
+                PruneLeastRecentlyActiveBranch();
+        }
+
+        void SaveActiveBranch()
+        {
+            BranchState& state{m_Branches[m_ActiveBranch]};
+            state.m_Tip = m_ActivePath.back();
+            state.m_CommandIndex = m_CommandIndex;
+        }
+
+        [[nodiscard]] BranchId CreateBranch(const uint32_t tip)
+        {
+            const BranchId branch{m_NextBranch++};
+            m_Branches.emplace(branch, BranchState{tip, m_CommandIndex, ++m_ActivationCount});
+            return branch;
+        }
+
+        void PruneLeastRecentlyActiveBranch()
+        {
+            std::optional<BranchId> oldest{};
+            uint64_t oldestActive{UINT64_MAX};
+            for(const auto& [branch, state] : m_Branches)
+            {
+                if(branch != m_ActiveBranch && state.m_LastActive < oldestActive)
+                {
+                    oldest = branch;
+                    oldestActive = state.m_LastActive;
+                }
+            }
+
+            if(oldest)
+                PruneBranch(*oldest);
+        }
+
+        [[nodiscard]] bool IsOnActivePath(const uint32_t node) const
+        {
+            const uint32_t depth{m_Nodes[node].m_Depth};
+            return depth < m_ActivePath.size() && m_ActivePath[depth] == node;
+        }
+
+        [[nodiscard]] uint32_t AllocateNode(Command&& command, const uint32_t parent)
+        {
+            Node node{std::move(command), parent, m_Nodes[parent].m_Depth + 1};
+            if(m_FreeNodes.empty())
+            {
+                m_Nodes.push_back(std::move(node));
+                return static_cast<uint32_t>(m_Nodes.size()) - 1;
+            }
+
+            const uint32_t index{m_FreeNodes.back()};
+            m_FreeNodes.pop_back();
+            m_Nodes[index] = std::move(node);
+            return index;
+        }
+
+        void FreeNode(const uint32_t node)
+        {
+            m_Nodes[node] = Node{};
+            m_FreeNodes.push_back(node);
+        }
+
+        std::vector<Node> m_Nodes{};
+        std::vector<uint32_t> m_FreeNodes{};
+        /// Nodes from the root to the active branch's tip, m_ActivePath[i] is at depth i.
+        std::vector<uint32_t> m_ActivePath{};
+        /// Nodes of the branch being switched to, from its tip back to the active path, kept to reuse its capacity.
+        std::vector<uint32_t> m_SwitchPath{};
+        std::unordered_map<BranchId, BranchState> m_Branches{};
+        uint64_t m_ActivationCount{0};
+        uint32_t m_MaxBranchCount{2};
+        uint32_t m_CommandIndex{0};
+        BranchId m_ActiveBranch{0};
+        BranchId m_NextBranch{0};
+    };
+}
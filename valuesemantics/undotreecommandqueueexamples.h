@@ -0,0 +1,161 @@
+#pragma once
+
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/benchmark/catch_benchmark.hpp>
+
+#include "valuesemantics/commandqueueexamples.h"
+#include "valuesemantics/undotreecommandqueue.h"
+#include "workingvalue.h"
+
+namespace ValueSemantics
+{
+    TEST_CASE("Undo Tree Command Queue - Value Semantics - Unit Tests")
+    {
+        std::shared_ptr<WorkingValue> value{std::make_shared<WorkingValue>()};
+        UndoTreeCommandQueue queue{3};
+        REQUIRE_FALSE(queue.HasPendingCommand());
+        REQUIRE_FALSE(queue.HasPendingRollbackCommand());
+        REQUIRE(queue.GetBranchCount() == 1);
+        REQUIRE(queue.GetStoredCommandCount() == 0);
+
+        const UndoTreeCommandQueue::BranchId firstBranch{queue.GetActiveBranch()};
+        queue.QueueCommand(CreateCommand(value, 1));
+        queue.QueueCommand(CreateCommand(value, 2));
+        queue.QueueCommand(CreateLambdaCommand(value, 4));
+        queue.ExecuteAll(); // +1, +2, +4
+        REQUIRE(value->GetValue() == 7);
+
+        SECTION("Queue Pending Commands")
+        {
+            queue.QueueCommand(CreateCommand(value, 8));
+            queue.QueueCommand(CreateCommand(value, 16)); // Nothing after the cursor was executed, no branch
+            REQUIRE(queue.GetBranchCount() == 1);
+            REQUIRE(queue.GetCommandQueueSize() == 5);
+
+            queue.ExecuteCommand(); // +8
+            queue.RollbackCommand(); // -8
+            queue.RollbackCommand(); // -4
+            queue.ExecuteCommand(); // +4
+            REQUIRE(value->GetValue() == 7);
+            REQUIRE(queue.GetBranchCount() == 1);
+        }
+
+        SECTION("Branch After Rollback")
+        {
+            queue.RollbackCommand(); // -4
+            queue.RollbackCommand(); // -2
+            queue.QueueCommand(CreateCommand(value, 8)); // Branches at +1, keeping +2, +4
+            const UndoTreeCommandQueue::BranchId secondBranch{queue.GetActiveBranch()};
+            REQUIRE(secondBranch != firstBranch);
+            REQUIRE(queue.GetBranchCount() == 2);
+            REQUIRE(queue.GetStoredCommandCount() == 4);
+            REQUIRE(queue.GetCommandQueueSize() == 2);
+            REQUIRE(queue.GetCommandIndex() == 1);
+            REQUIRE(value.use_count() == 6);
+
+            queue.ExecuteAll(); // +8
+            REQUIRE(value->GetValue() == 9);
+
+            REQUIRE(queue.SwitchToBranch(firstBranch)); // -8, back to where the first branch was left
+            REQUIRE(queue.GetActiveBranch() == firstBranch);
+            REQUIRE(value->GetValue() == 1);
+            REQUIRE(queue.GetCommandIndex() == 1);
+            REQUIRE(queue.GetCommandQueueSize() == 3);
+
+            queue.ExecuteAll(); // +2, +4
+            REQUIRE(value->GetValue() == 7);
+
+            REQUIRE(queue.SwitchToBranch(secondBranch)); // -4, -2, +8
+            REQUIRE(value->GetValue() == 9);
+            REQUIRE(queue.GetCommandIndex() == 2);
+
+            queue.SeekTo(0); // -8, -1
+            REQUIRE(value->GetValue() == 0);
+            REQUIRE_FALSE(queue.SwitchToBranch(secondBranch + 1));
+        }
+
+        SECTION("Prune Branches")
+        {
+            queue.RollbackCommand(); // -4
+            queue.QueueCommand(CreateCommand(value, 8)); // Second branch, keeps +4
+            queue.ExecuteCommand(); // +8
+            const UndoTreeCommandQueue::BranchId secondBranch{queue.GetActiveBranch()};
+
+            queue.RollbackTo(0);
+            REQUIRE(value->GetValue() == 0);
+            queue.QueueCommand(CreateCommand(value, 16)); // Third branch, keeps +1 and everything after it
+            REQUIRE(queue.GetBranchCount() == 3);
+            REQUIRE(queue.GetStoredCommandCount() == 5);
+
+            REQUIRE(queue.SwitchToBranch(secondBranch)); // Left at index 0
+            REQUIRE(value->GetValue() == 0);
+            queue.ExecuteAll(); // +1, +2, +8
+            REQUIRE(value->GetValue() == 11);
+
+            queue.RollbackCommand(); // -8
+            queue.QueueCommand(CreateCommand(value, 32)); // Fourth branch, prunes the least recently active first branch
+            REQUIRE(queue.GetBranchCount() == 3);
+            REQUIRE_FALSE(queue.HasBranch(firstBranch));
+            REQUIRE(queue.GetStoredCommandCount() == 5); // Only +4 was exclusive to the first branch
+
+            REQUIRE(queue.PruneBranch(secondBranch)); // Destroys +8, +1 and +2 are shared with the active branch
+            REQUIRE_FALSE(queue.PruneBranch(queue.GetActiveBranch()));
+            REQUIRE(queue.GetBranchCount() == 2);
+            REQUIRE(queue.GetStoredCommandCount() == 4);
+
+            queue.ClearQueue();
+            REQUIRE(queue.GetBranchCount() == 1);
+            REQUIRE(queue.GetStoredCommandCount() == 0);
+            REQUIRE(value.use_count() == 1);
+        }
+    }
+
+    TEST_CASE("Undo Tree Command Queue - Value Semantics - Diverge Benchmark")
+    {
+        constexpr uint32_t historySize{100'000};
+        constexpr uint32_t undoCount{1'000};
+        std::shared_ptr<WorkingValue> value{std::make_shared<WorkingValue>()};
+
+        CommandQueue queue{};
+        UndoTreeCommandQueue treeQueue{};
+        for(uint32_t i{0}; i != historySize; ++i)
+        {
+            queue.QueueCommand(CreateCommand(value, 1));
+            treeQueue.QueueCommand(CreateCommand(value, 1));
+        }
+        queue.ExecuteAll();
+        treeQueue.ExecuteAll();
+
+        // Undo, try out an alternative command, then return to the undone commands.
+        BENCHMARK("Clear Pending Commands - Diverge/Return")
+        {
+            queue.RollbackTo(historySize - undoCount);
+            queue.ClearPendingCommands();
+            queue.QueueCommand(CreateCommand(value, 2));
+            queue.ExecuteCommand();
+
+            queue.RollbackCommand();
+            queue.ClearPendingCommands();
+            for(uint32_t i{0}; i != undoCount; ++i)
+            {
+                queue.QueueCommand(CreateCommand(value, 1));
+            }
+            queue.ExecuteAll();
+        };
+
+        BENCHMARK("Undo Tree - Diverge/Return")
+        {
+            const UndoTreeCommandQueue::BranchId branch{treeQueue.GetActiveBranch()};
+            treeQueue.RollbackTo(historySize - undoCount);
+            treeQueue.QueueCommand(CreateCommand(value, 2));
+            treeQueue.ExecuteCommand();
+
+            treeQueue.SwitchToBranch(branch);
+            treeQueue.ExecuteAll();
+        };
+
+        REQUIRE(queue.GetCommandQueueSize() == historySize);
+        REQUIRE(treeQueue.GetCommandQueueSize() == historySize);
+        REQUIRE(treeQueue.GetBranchCount() <= 64);
+    }
+}
@@ -0,0 +1,246 @@
+#pragma once
+
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/benchmark/catch_benchmark.hpp>
+
+#include <optional>
+
+#include "valuesemantics/commandqueueexamples.h"
+#include "workingvaluestore.h"
+
+namespace ValueSemantics
+{
+    namespace
+    {
+        /// Reports stale handles of the shared store to a handler which ignores them instead of asserting, while alive.
+        class ScopedStaleHandleHandler
+        {
+        public:
+            ScopedStaleHandleHandler()
+                : m_Previous{WorkingValueStore::GetShared().SetStaleHandleHandler([](WorkingValueHandle) {})}
+            {
+            }
+
+            ~ScopedStaleHandleHandler()
+            {
+                WorkingValueStore::GetShared().SetStaleHandleHandler(m_Previous);
+            }
+
+            ScopedStaleHandleHandler(const ScopedStaleHandleHandler&) = delete;
+            ScopedStaleHandleHandler& operator=(const ScopedStaleHandleHandler&) = delete;
+        private:
+            WorkingValueStore::StaleHandleHandler m_Previous{nullptr};
+        };
+    }
+
+    TEST_CASE("Working Value Store - Value Semantics - Unit Tests")
+    {
+        static_assert(sizeof(WorkingValueHandle) == 4);
+        static_assert(sizeof(ModifyStoredValueCommand) == 8);
+        static_assert(sizeof(ModifyStoredValueCommand) < sizeof(ModifyValueCommand));
+
+        SECTION("Store")
+        {
+            WorkingValueStore store{};
+            REQUIRE_FALSE(store.Contains(WorkingValueHandle{}));
+
+            const WorkingValueHandle first{store.Create(5)};
+            const WorkingValueHandle second{store.Create()};
+            REQUIRE(store.GetSize() == 2);
+            REQUIRE(store.Find(first)->GetValue() == 5);
+            REQUIRE(store.Find(second)->GetValue() == 0);
+
+            REQUIRE(store.Destroy(first));
+            REQUIRE_FALSE(store.Destroy(first));
+            REQUIRE_FALSE(store.Contains(first));
+            REQUIRE(store.Find(first) == nullptr);
+
+            const WorkingValueHandle reused{store.Create()}; // Same index, next generation
+            REQUIRE(reused.GetIndex() == first.GetIndex());
+            REQUIRE(reused != first);
+            REQUIRE(store.Find(first) == nullptr);
+            REQUIRE(store.Find(reused)->GetValue() == 0);
+            REQUIRE(store.GetSize() == 2);
+            REQUIRE(store.GetIndexCount() == 2);
+        }
+
+        SECTION("Retire Exhausted Index")
+        {
+            WorkingValueStore store{};
+            WorkingValueHandle handle{store.Create()};
+            for(uint32_t generation{0}; generation != WorkingValueHandle::GenerationMask; ++generation)
+            {
+                REQUIRE(store.Destroy(handle));
+                handle = store.Create();
+                REQUIRE(handle.GetIndex() == 0);
+            }
+
+            REQUIRE(handle.GetGeneration() == WorkingValueHandle::GenerationMask);
+            REQUIRE(store.Destroy(handle));
+            REQUIRE_FALSE(store.Contains(WorkingValueHandle{0, 0}));
+            REQUIRE(store.Create().GetIndex() == 1);
+        }
+
+        SECTION("Full Store")
+        {
+            WorkingValueStore store{};
+            WorkingValueHandle last{};
+            for(uint32_t i{0}; i != WorkingValueStore::MaxValueCount; ++i)
+            {
+                last = store.Create();
+            }
+            REQUIRE(store.Contains(last));
+            REQUIRE(store.GetSize() == WorkingValueStore::MaxValueCount);
+
+            const WorkingValueHandle overflow{store.Create()};
+            REQUIRE(overflow == WorkingValueHandle{});
+            REQUIRE_FALSE(store.Contains(overflow));
+            REQUIRE(store.GetIndexCount() == WorkingValueStore::MaxValueCount);
+
+            REQUIRE(store.Destroy(last)); // Frees an index to reuse
+            REQUIRE(store.Contains(store.Create()));
+        }
+
+        SECTION("Commands")
+        {
+            const ScopedStaleHandleHandler staleHandleHandler{};
+            WorkingValueStore& store{WorkingValueStore::GetShared()};
+            const uint32_t staleHandleCount{store.GetStaleHandleCount()};
+            const WorkingValueHandle value{store.Create()};
+            const WorkingValueHandle otherValue{store.Create()};
+
+            CommandQueue queue{};
+            queue.SetCoalescePolicy(CoalescePolicy::PendingOnly);
+            queue.QueueCommand(ModifyStoredValueCommand{value, 1});
+            queue.QueueCommand(ModifyStoredValueCommand{value, 2}); // Merged
+            queue.QueueCommand(ModifyStoredValueCommand{otherValue, 4});
+            REQUIRE(queue.GetCommandQueueSize() == 2);
+
+            queue.ExecuteAll();
+            REQUIRE(store.Find(value)->GetValue() == 3);
+            REQUIRE(store.Find(otherValue)->GetValue() == 4);
+
+            REQUIRE(store.Destroy(otherValue));
+            queue.RollbackTo(0); // The destroyed value is skipped and reported
+            REQUIRE(store.Find(value)->GetValue() == 0);
+            REQUIRE(store.GetStaleHandleCount() == staleHandleCount + 1);
+
+            const WorkingValueHandle newValue{store.Create()}; // Reuses the destroyed value's index
+            queue.ExecuteAll();
+            REQUIRE(store.Find(newValue)->GetValue() == 0);
+            REQUIRE(store.GetStaleHandleCount() == staleHandleCount + 2);
+
+            REQUIRE(store.Destroy(value));
+            REQUIRE(store.Destroy(newValue));
+        }
+
+        SECTION("Stale Handle")
+        {
+            const ScopedStaleHandleHandler staleHandleHandler{};
+            WorkingValueStore& store{WorkingValueStore::GetShared()};
+            const uint32_t staleHandleCount{store.GetStaleHandleCount()};
+            const WorkingValueHandle value{store.Create()};
+            ModifyStoredValueCommand command{value, 1};
+            REQUIRE(command.IsValid());
+
+            command.Execute();
+            REQUIRE(store.GetStaleHandleCount() == staleHandleCount);
+
+            REQUIRE(store.Destroy(value));
+            REQUIRE_FALSE(command.IsValid());
+            command.Rollback();
+            REQUIRE(store.GetStaleHandleCount() == staleHandleCount + 1);
+            REQUIRE(store.Resolve(value) == nullptr);
+            REQUIRE(store.GetStaleHandleCount() == staleHandleCount + 2);
+        }
+    }
+
+    TEST_CASE("Working Value Store - Value Semantics - Benchmark")
+    {
+        constexpr uint32_t creationCount{100'000};
+        std::shared_ptr<WorkingValue> value{std::make_shared<WorkingValue>()};
+        const WorkingValueHandle storedValue{WorkingValueStore::GetShared().Create()};
+
+        BENCHMARK_ADVANCED("Create Shared Pointer Commands")(Catch::Benchmark::Chronometer meter)
+        {
+            std::vector<std::optional<CommandQueue>> queues(static_cast<std::size_t>(meter.runs()));
+            meter.measure([&](const int run)
+                {
+                    CommandQueue& queue{queues[static_cast<std::size_t>(run)].emplace()};
+                    for(uint32_t i{0}; i != creationCount; ++i)
+                    {
+                        queue.QueueCommand(CreateCommand(value, 1));
+                    }
+                });
+        };
+
+        BENCHMARK_ADVANCED("Create Handle Commands")(Catch::Benchmark::Chronometer meter)
+        {
+            std::vector<std::optional<CommandQueue>> queues(static_cast<std::size_t>(meter.runs()));
+            meter.measure([&](const int run)
+                {
+                    CommandQueue& queue{queues[static_cast<std::size_t>(run)].emplace()};
+                    for(uint32_t i{0}; i != creationCount; ++i)
+                    {
+                        queue.QueueCommand(ModifyStoredValueCommand{storedValue, 1});
+                    }
+                });
+        };
+
+        BENCHMARK_ADVANCED("Destroy Shared Pointer Commands")(Catch::Benchmark::Chronometer meter)
+        {
+            std::vector<std::optional<CommandQueue>> queues(static_cast<std::size_t>(meter.runs()));
+            for(std::optional<CommandQueue>& queue : queues)
+            {
+                queue.emplace();
+                for(uint32_t i{0}; i != creationCount; ++i)
+                {
+                    queue->QueueCommand(CreateCommand(value, 1));
+                }
+            }
+            meter.measure([&](const int run)
+                {
+                    queues[static_cast<std::size_t>(run)].reset();
+                });
+        };
+
+        BENCHMARK_ADVANCED("Destroy Handle Commands")(Catch::Benchmark::Chronometer meter)
+        {
+            std::vector<std::optional<CommandQueue>> queues(static_cast<std::size_t>(meter.runs()));
+            for(std::optional<CommandQueue>& queue : queues)
+            {
+                queue.emplace();
+                for(uint32_t i{0}; i != creationCount; ++i)
+                {
+                    queue->QueueCommand(ModifyStoredValueCommand{storedValue, 1});
+                }
+            }
+            meter.measure([&](const int run)
+                {
+                    queues[static_cast<std::size_t>(run)].reset();
+                });
+        };
+
+        CommandQueue sharedPointerQueue{};
+        CommandQueue handleQueue{};
+        for(uint32_t i{0}; i != creationCount; ++i)
+        {
+            sharedPointerQueue.QueueCommand(CreateCommand(value, 1));
+            handleQueue.QueueCommand(ModifyStoredValueCommand{storedValue, 1});
+        }
+
+        BENCHMARK("Execute/Rollback Shared Pointer Commands")
+        {
+            sharedPointerQueue.ExecuteAll();
+            sharedPointerQueue.RollbackTo(0);
+        };
+
+        BENCHMARK("Execute/Rollback Handle Commands")
+        {
+            handleQueue.ExecuteAll();
+            handleQueue.RollbackTo(0);
+        };
+
+        WorkingValueStore::GetShared().Destroy(storedValue);
+    }
+}
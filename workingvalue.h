@@ -1,12 +1,22 @@
 #pragma once
 
 #include <cstdint>
+#include <limits>
 
 class WorkingValue
 {
 public:
     using ValueType = int32_t;
 
+    /// True when first + second can replace two modifications: the sum neither overflows ValueType nor is its minimum,
+    /// whose negation to roll the modification back would overflow.
+    [[nodiscard]] static constexpr bool CanMerge(const ValueType first, const ValueType second)
+    {
+        return second > 0
+            ? first <= std::numeric_limits<ValueType>::max() - second
+            : first > std::numeric_limits<ValueType>::min() - second;
+    }
+
     [[nodiscard]] ValueType GetValue() const
     {
         return m_Value;
@@ -16,6 +26,11 @@ public:
     {
         m_Value += modification;
     }
+
+    void SetValue(const ValueType value)
+    {
+        m_Value = value;
+    }
 private:
     ValueType m_Value{0};
 };
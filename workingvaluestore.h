@@ -0,0 +1,189 @@
+#pragma once
+
+#include <atomic>
+#include <cassert>
+#include <cstdint>
+#include <vector>
+
+#include "workingvalue.h"
+
+/// 32-bit reference to a value of a WorkingValueStore. The low IndexBits bits index the value, the high bits are the
+/// generation of the index the handle was created for, so a handle outliving its value is detected.
+/// A default constructed handle never refers to a value.
+class WorkingValueHandle
+{
+public:
+    static constexpr uint32_t IndexBits{20};
+    static constexpr uint32_t IndexMask{(1u << IndexBits) - 1};
+    static constexpr uint32_t GenerationMask{UINT32_MAX >> IndexBits};
+
+    constexpr WorkingValueHandle() = default;
+
+    constexpr WorkingValueHandle(const uint32_t index, const uint32_t generation)
+        : m_Bits{(generation << IndexBits) | index}
+    {
+    }
+
+    [[nodiscard]] constexpr uint32_t GetIndex() const
+    {
+        return m_Bits & IndexMask;
+    }
+
+    [[nodiscard]] constexpr uint32_t GetGeneration() const
+    {
+        return m_Bits >> IndexBits;
+    }
+
+    [[nodiscard]] constexpr bool operator==(const WorkingValueHandle&) const = default;
+private:
+    uint32_t m_Bits{IndexMask};
+};
+
+/// Stores WorkingValues contiguously, addressed by WorkingValueHandle rather than owned through shared pointers,
+/// so commands targeting a value are trivially copyable and destroyed without touching a reference count.
+/// A destroyed value's index is reused with the next generation, handles to the destroyed value then no longer
+/// find it. An index whose generations are exhausted is never reused.
+/// Creating and destroying values isn't thread safe, values are as safe as WorkingValue itself.
+class WorkingValueStore
+{
+public:
+    /// Called with every handle passed to Resolve() which doesn't refer to a value.
+    using StaleHandleHandler = void(*)(WorkingValueHandle handle);
+
+    /// Handles never use the last index, it's reserved for the default handle.
+    static constexpr uint32_t MaxValueCount{WorkingValueHandle::IndexMask};
+
+    /// The store handle commands resolve their handles through, so the commands don't have to hold a store.
+    /// Commands can't target the values of any other store. Values created here live until destroyed,
+    /// whoever creates them has to destroy them again.
+    [[nodiscard]] static WorkingValueStore& GetShared()
+    {
+        return s_Shared;
+    }
+
+    /// Returns a default handle, which never refers to a value, when every index is in use or retired.
+    [[nodiscard]] WorkingValueHandle Create(const WorkingValue::ValueType value = 0)
+    {
+        uint32_t index{};
+        if(m_FreeIndices.empty())
+        {
+            if(m_Values.size() >= MaxValueCount)
+                return WorkingValueHandle{};
+
+            index = static_cast<uint32_t>(m_Values.size());
+            m_Values.emplace_back();
+            m_Generations.push_back(0);
+        }
+        else
+        {
+            index = m_FreeIndices.back();
+            m_FreeIndices.pop_back();
+        }
+
+        m_Values[index].SetValue(value);
+        ++m_Size;
+        return WorkingValueHandle{index, m_Generations[index]};
+    }
+
+    /// Returns false when handle doesn't refer to a value.
+    bool Destroy(const WorkingValueHandle handle)
+    {
+        if(!Contains(handle))
+            return false;
+
+        const uint32_t index{handle.GetIndex()};
+        if(m_Generations[index] == WorkingValueHandle::GenerationMask)
+        {
+            m_Generations[index] = RetiredGeneration;
+        }
+        else
+        {
+            ++m_Generations[index];
+            m_FreeIndices.push_back(index);
+        }
+
+        --m_Size;
+        return true;
+    }
+
+    [[nodiscard]] bool Contains(const WorkingValueHandle handle) const
+    {
+        const uint32_t index{handle.GetIndex()};
+        return index < m_Generations.size() && m_Generations[index] == handle.GetGeneration();
+    }
+
+    /// Returns nullptr when handle doesn't refer to a value. The pointer is invalidated by Create().
+    [[nodiscard]] WorkingValue* Find(const WorkingValueHandle handle)
+    {
+        return Contains(handle) ? &m_Values[handle.GetIndex()] : nullptr;
+    }
+
+    /// Returns nullptr when handle doesn't refer to a value. The pointer is invalidated by Create().
+    [[nodiscard]] const WorkingValue* Find(const WorkingValueHandle handle) const
+    {
+        return Contains(handle) ? &m_Values[handle.GetIndex()] : nullptr;
+    }
+
+    /// Find() for commands, a handle which doesn't refer to a value is reported rather than silently skipped:
+    /// it's counted, then passed to the stale handle handler, or asserts in debug builds when there's none.
+    [[nodiscard]] WorkingValue* Resolve(const WorkingValueHandle handle)
+    {
+        WorkingValue* const value{Find(handle)};
+        if(!value)
+            ReportStaleHandle(handle);
+
+        return value;
+    }
+
+    /// Replaces the handler stale handles are reported to, nullptr asserts again. Returns the previous handler.
+    StaleHandleHandler SetStaleHandleHandler(const StaleHandleHandler handler)
+    {
+        const StaleHandleHandler previous{m_StaleHandleHandler};
+        m_StaleHandleHandler = handler;
+        return previous;
+    }
+
+    /// Number of stale handles passed to Resolve().
+    [[nodiscard]] uint32_t GetStaleHandleCount() const
+    {
+        return m_StaleHandleCount.load(std::memory_order_relaxed);
+    }
+
+    /// Number of values alive.
+    [[nodiscard]] uint32_t GetSize() const
+    {
+        return m_Size;
+    }
+
+    /// Number of indices ever used, alive, free or retired.
+    [[nodiscard]] uint32_t GetIndexCount() const
+    {
+        return static_cast<uint32_t>(m_Values.size());
+    }
+private:
+    void ReportStaleHandle(const WorkingValueHandle handle)
+    {
+        m_StaleHandleCount.fetch_add(1, std::memory_order_relaxed);
+        if(m_StaleHandleHandler)
+            m_StaleHandleHandler(handle);
+        else
+            assert(false && "A command's value was destroyed before the command");
+    }
+
+    /// Generation of an index which is never reused, no handle has it.
+    static constexpr uint32_t RetiredGeneration{UINT32_MAX};
+
+    /// Constant initialized, unlike a function local static it needs no guard on every access.
+    static WorkingValueStore s_Shared;
+
+    std::vector<WorkingValue> m_Values{};
+    /// Generation of each index's current value, or of its next value while the index is free.
+    std::vector<uint32_t> m_Generations{};
+    std::vector<uint32_t> m_FreeIndices{};
+    StaleHandleHandler m_StaleHandleHandler{nullptr};
+    /// Commands may resolve handles on several threads at once.
+    std::atomic<uint32_t> m_StaleHandleCount{0};
+    uint32_t m_Size{0};
+};
+
+inline WorkingValueStore WorkingValueStore::s_Shared{};